@@ -0,0 +1,216 @@
+// ────────────────────────────────────────────────────────────────────
+// In-process nbnet server API for the benchmarks
+// ────────────────────────────────────────────────────────────────────
+
+#include "BenchNet.h"
+
+extern "C"
+{
+#include <net_drivers/udp.h>
+#include "nbnet_server_ext.h"
+}
+
+#include "Engine/Network/Protocol/PacketSerializer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+
+namespace
+{
+    struct QueuedEvent
+    {
+        int type;
+        uint32_t connHandle;
+        std::vector<uint8_t> bytes;
+    };
+
+    std::deque<QueuedEvent> g_events;
+    QueuedEvent g_current;
+    NBN_ByteArrayMessage g_message;
+    BenchNet::Sent g_sent;
+    bool g_captureBroadcasts = false;
+    std::vector<std::vector<uint8_t>> g_broadcasts;
+
+    std::map<int, NBN_DriverImplementation> g_drivers;
+    uint64_t g_driverPackets = 0;
+    std::vector<NBN_Connection *> g_driverConnections;
+
+    void CountSent(const uint8_t *bytes, unsigned int length, unsigned int recipients)
+    {
+        g_sent.packets += recipients;
+        g_sent.bytes += uint64_t{length} * recipients;
+        if (length < sizeof(MsgPositionBroadcast))
+            return;
+        switch (PacketSerializer::PeekType(bytes, length))
+        {
+        case NetMessageType::PositionBroadcast:
+        case NetMessageType::PositionBroadcastCompact:
+        case NetMessageType::PositionBroadcastDelta:
+        {
+            // serverTick follows the header in every broadcast format.
+            uint32_t tick;
+            std::memcpy(&tick, bytes + sizeof(NetPacketHeader), sizeof(tick));
+            g_sent.lastBroadcastTick = std::max(g_sent.lastBroadcastTick, tick);
+            if (g_captureBroadcasts)
+                g_broadcasts.emplace_back(bytes, bytes + length);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+namespace BenchNet
+{
+    void Connect(uint32_t connHandle)
+    {
+        g_events.push_back(QueuedEvent{NBN_NEW_CONNECTION, connHandle, {}});
+    }
+
+    void Deliver(uint32_t connHandle, const uint8_t *data, size_t len)
+    {
+        g_events.push_back(QueuedEvent{NBN_CLIENT_MESSAGE_RECEIVED, connHandle,
+                                       std::vector<uint8_t>(data, data + len)});
+    }
+
+    Sent TakeSent()
+    {
+        const Sent sent = g_sent;
+        g_sent = Sent{};
+        g_sent.lastBroadcastTick = sent.lastBroadcastTick;
+        return sent;
+    }
+
+    void CaptureBroadcasts(bool enabled)
+    {
+        g_captureBroadcasts = enabled;
+        g_broadcasts.clear();
+    }
+
+    std::vector<std::vector<uint8_t>> TakeBroadcasts()
+    {
+        std::vector<std::vector<uint8_t>> out;
+        out.swap(g_broadcasts);
+        return out;
+    }
+
+    const NBN_DriverImplementation *Driver(int driverID)
+    {
+        auto it = g_drivers.find(driverID);
+        return it != g_drivers.end() ? &it->second : nullptr;
+    }
+
+    uint64_t TakeDriverPackets()
+    {
+        const uint64_t n = g_driverPackets;
+        g_driverPackets = 0;
+        return n;
+    }
+
+    std::vector<NBN_Connection *> TakeDriverConnections()
+    {
+        std::vector<NBN_Connection *> out;
+        out.swap(g_driverConnections);
+        return out;
+    }
+}
+
+extern "C"
+{
+    // ── Game server API ────────────────────────────────────────────
+    int NBN_GameServer_StartEx(const char *, uint16_t, bool)
+    {
+        g_events.clear();
+        g_sent = BenchNet::Sent{};
+        return 0;
+    }
+
+    void NBN_GameServer_Stop(void) { g_events.clear(); }
+
+    int NBN_GameServer_Poll(void)
+    {
+        if (g_events.empty())
+            return NBN_NO_EVENT;
+        g_current = std::move(g_events.front());
+        g_events.pop_front();
+        return g_current.type;
+    }
+
+    int NBN_GameServer_SendPackets(void) { return 0; }
+
+    int NBN_GameServer_SendByteArrayTo(NBN_ConnectionHandle, uint8_t *bytes, unsigned int length, uint8_t)
+    {
+        CountSent(bytes, length, 1);
+        return 0;
+    }
+
+    NBN_ConnectionHandle NBN_GameServer_GetIncomingConnection(void) { return g_current.connHandle; }
+    int NBN_GameServer_AcceptIncomingConnection(void) { return 0; }
+    int NBN_GameServer_RejectIncomingConnectionWithCode(int) { return 0; }
+    NBN_ConnectionHandle NBN_GameServer_GetDisconnectedClient(void) { return g_current.connHandle; }
+    int NBN_GameServer_CloseClient(NBN_ConnectionHandle) { return 0; }
+
+    NBN_MessageInfo NBN_GameServer_GetMessageInfo(void)
+    {
+        const size_t len = std::min<size_t>(g_current.bytes.size(), sizeof(g_message.bytes));
+        std::memcpy(g_message.bytes, g_current.bytes.data(), len);
+        g_message.length = static_cast<unsigned int>(len);
+
+        NBN_MessageInfo info{};
+        info.type = NBN_BYTE_ARRAY_MESSAGE_TYPE;
+        info.data = &g_message;
+        info.sender = g_current.connHandle;
+        return info;
+    }
+
+    // ── nbnet_server_ext.h ─────────────────────────────────────────
+    int NW_GameServer_SendByteArrayToMany(const uint32_t *, unsigned int handle_count,
+                                          const uint8_t *bytes, unsigned int length, uint8_t)
+    {
+        CountSent(bytes, length, handle_count);
+        return 0;
+    }
+
+    unsigned int NW_GameServer_GetOutgoingMessageCount(uint32_t, uint8_t) { return 0; }
+
+    // ── Drivers ────────────────────────────────────────────────────
+    void NBN_UDP_Register(void) {}
+
+    void NBN_Driver_Register(int id, const char *, NBN_DriverImplementation implementation)
+    {
+        g_drivers[id] = implementation;
+    }
+
+    int NBN_Driver_RaiseEvent(NBN_DriverEvent ev, void *data)
+    {
+        if (ev == NBN_DRIVER_SERV_CLIENT_PACKET_RECEIVED)
+            ++g_driverPackets;
+        else if (ev == NBN_DRIVER_SERV_CLIENT_CONNECTED)
+            g_driverConnections.push_back(static_cast<NBN_Connection *>(data));
+        return 0;
+    }
+
+    int NBN_Packet_InitRead(NBN_Packet *packet, NBN_Connection *sender, uint8_t *buffer, unsigned int size)
+    {
+        if (size > NBN_PACKET_MAX_SIZE)
+            return -1;
+        std::memcpy(packet->buffer, buffer, size);
+        packet->size = size;
+        packet->sender = sender;
+        return 0;
+    }
+
+    NBN_Connection *NBN_GameServer_CreateClientConnection(int, void *driver_data, uint32_t,
+                                                          NBN_ConnectionHandle conn_id, bool)
+    {
+        // Owned by the driver's peer table for the rest of the run.
+        auto *connection = static_cast<NBN_Connection *>(std::calloc(1, sizeof(NBN_Connection)));
+        connection->id = conn_id;
+        connection->driver_data = driver_data;
+        return connection;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+extern "C"
+{
+#include <nbnet.h>
+}
+
+/// In-process stand-in for the nbnet server API, linked into the
+/// benchmarks instead of nbnet_server_impl.c.
+///
+/// The benchmark queues connections and client messages; the server under
+/// test drains them through NBN_GameServer_Poll as if they had arrived on
+/// a socket, and everything it sends is only counted. Drivers registered
+/// with NBN_Driver_Register are kept so a benchmark can drive one
+/// directly. Single-threaded: use the server without an I/O thread.
+namespace BenchNet
+{
+    /// Queue a new connection (its handshake has just completed).
+    void Connect(uint32_t connHandle);
+    /// Queue a message from `connHandle` for the next poll.
+    void Deliver(uint32_t connHandle, const uint8_t *data, size_t len);
+    inline void Deliver(uint32_t connHandle, const std::vector<uint8_t> &msg)
+    {
+        Deliver(connHandle, msg.data(), msg.size());
+    }
+
+    /// Payloads the server sent since the last call, then reset. A
+    /// message to N connections counts N times.
+    struct Sent
+    {
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        /// serverTick of the newest position broadcast, for SnapshotAcks.
+        uint32_t lastBroadcastTick = 0;
+    };
+    Sent TakeSent();
+
+    /// Keep a copy of every position broadcast sent from now on (off by
+    /// default so benchmarks do not pay for the copies).
+    void CaptureBroadcasts(bool enabled);
+    /// Broadcast payloads captured since the last call, then reset.
+    std::vector<std::vector<uint8_t>> TakeBroadcasts();
+
+    /// The driver registered under `driverID`, or nullptr.
+    const NBN_DriverImplementation *Driver(int driverID);
+    /// Packets drivers raised as received since the last call, then reset.
+    uint64_t TakeDriverPackets();
+    /// Connections drivers raised as new since the last call, then reset.
+    std::vector<NBN_Connection *> TakeDriverConnections();
+}
@@ -0,0 +1,279 @@
+// ────────────────────────────────────────────────────────────────────
+// nw-bench-broadcast – position broadcast bytes and tick cost
+//
+// Runs the real GameServer tick against BenchNet: scripted clients fly
+// circles spread over the arena and report every tick, and the bench
+// counts what the server sends and how long each Tick() takes. Each
+// client count is run all-to-all and with the area-of-interest radius,
+// or, with --workers, with the AOI radius at each encode worker count.
+// ────────────────────────────────────────────────────────────────────
+
+#include "BenchNet.h"
+#include "GameServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint16_t kBenchPort = 47777;
+    constexpr float kCircleRadius = 100.0f; // each client circles its own spot
+    constexpr float kFlightSpeed = 60.0f;
+
+    /// Swallows the server's log lines while a case runs.
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    struct Options
+    {
+        std::vector<uint32_t> clients{16, 64, 256};
+        float radius = 1000.0f;
+        float arena = 8000.0f; // clients spread over [-arena/2, arena/2]²
+        uint32_t ticks = 300;
+        uint32_t warmup = 30;
+        uint32_t budget = 0;
+        BroadcastFormat format = BroadcastFormat::Raw;
+        std::vector<uint32_t> workers; // empty: AOI vs all-to-all table
+    };
+
+    struct Case
+    {
+        uint32_t clients;
+        float radius;
+        uint32_t workers;
+    };
+
+    struct Result
+    {
+        double bytesPerTick = 0.0;
+        double packetsPerTick = 0.0;
+        double wallMicros = 0.0; // per Tick()
+        double cpuMicros = 0.0;  // process CPU per Tick(), workers included
+    };
+
+    const char *FormatName(BroadcastFormat format)
+    {
+        switch (format)
+        {
+        case BroadcastFormat::Raw:
+            return "raw";
+        case BroadcastFormat::Compact:
+            return "compact";
+        case BroadcastFormat::Delta:
+            return "delta";
+        }
+        return "?";
+    }
+
+    Result RunCase(const Options &opts, const Case &c)
+    {
+        ServerConfig config;
+        config.broadcastFormat = opts.format;
+        config.interestRadius = c.radius;
+        config.clientByteBudget = opts.budget;
+        config.workerThreads = c.workers;
+        config.maxLoadLevel = LoadLevel::Normal; // measure, never shed
+
+        NullBuffer mute;
+        std::streambuf *log = std::cout.rdbuf(&mute);
+        std::streambuf *errors = std::cerr.rdbuf(&mute);
+
+        GameServer server(config);
+        server.Start(kBenchPort);
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> spot(-0.5f * opts.arena, 0.5f * opts.arena);
+        std::vector<NetTransformState> centres(c.clients);
+        for (uint32_t i = 0; i < c.clients; ++i)
+        {
+            centres[i] = NetTransformState{};
+            centres[i].posX = spot(rng);
+            centres[i].posY = 100.0f + static_cast<float>(i % 16) * 10.0f;
+            centres[i].posZ = spot(rng);
+
+            // Connections and ClientIDs both count up from 1.
+            const uint32_t conn = i + 1;
+            NetUUID uuid;
+            std::memcpy(uuid.bytes, &conn, sizeof(conn));
+            BenchNet::Connect(conn);
+            BenchNet::Deliver(conn, PacketSerializer::WriteClientHello(uuid));
+        }
+        server.Tick();
+        BenchNet::TakeSent();
+
+        Result r;
+        const float angularSpeed = kFlightSpeed / kCircleRadius;
+        uint32_t ackTick = 0; // clients ack the newest broadcast they got
+        for (uint32_t t = 0; t < opts.warmup + opts.ticks; ++t)
+        {
+            const float time = static_cast<float>(t) / static_cast<float>(config.tickRate);
+            for (uint32_t i = 0; i < c.clients; ++i)
+            {
+                const float a = angularSpeed * time + static_cast<float>(i);
+                NetTransformState s = centres[i];
+                s.posX += kCircleRadius * std::cos(a);
+                s.posZ += kCircleRadius * std::sin(a);
+                s.linVelX = -kFlightSpeed * std::sin(a);
+                s.linVelZ = kFlightSpeed * std::cos(a);
+                s.rotW = 1.0f;
+                BenchNet::Deliver(i + 1, PacketSerializer::WritePositionUpdate(i + 1, i + 1, s));
+                if (opts.format == BroadcastFormat::Delta && ackTick != 0)
+                    BenchNet::Deliver(i + 1, PacketSerializer::WriteSnapshotAck(ackTick));
+            }
+
+            const Clock::time_point wallStart = Clock::now();
+            const std::clock_t cpuStart = std::clock();
+            server.Tick();
+            const std::clock_t cpuEnd = std::clock();
+            const Clock::time_point wallEnd = Clock::now();
+
+            const BenchNet::Sent sent = BenchNet::TakeSent();
+            ackTick = sent.lastBroadcastTick;
+            if (t < opts.warmup)
+                continue;
+            r.bytesPerTick += static_cast<double>(sent.bytes);
+            r.packetsPerTick += static_cast<double>(sent.packets);
+            r.wallMicros += std::chrono::duration<double, std::micro>(wallEnd - wallStart).count();
+            r.cpuMicros += 1e6 * static_cast<double>(cpuEnd - cpuStart) / CLOCKS_PER_SEC;
+        }
+        server.Stop();
+        std::cout.rdbuf(log);
+        std::cerr.rdbuf(errors);
+
+        const double ticks = opts.ticks;
+        r.bytesPerTick /= ticks;
+        r.packetsPerTick /= ticks;
+        r.wallMicros /= ticks;
+        r.cpuMicros /= ticks;
+        return r;
+    }
+
+    std::vector<uint32_t> ParseList(const char *s)
+    {
+        std::vector<uint32_t> out;
+        for (char *end = nullptr; *s; s = (*end == ',') ? end + 1 : end)
+        {
+            out.push_back(static_cast<uint32_t>(std::strtoul(s, &end, 10)));
+            if (end == s)
+                break;
+        }
+        return out;
+    }
+
+    void PrintUsage(const char *exe)
+    {
+        std::printf("Usage: %s [options]\n"
+                    "  --clients <N,N,...>    client counts (default 16,64,256)\n"
+                    "  --aoi-radius <units>   radius compared against all-to-all (default 1000)\n"
+                    "  --arena <units>        side of the square the clients spread over (default 8000)\n"
+                    "  --format <raw|compact|delta>  broadcast wire format (default raw)\n"
+                    "  --client-budget <B>    per-client byte budget (default unlimited)\n"
+                    "  --ticks <N>            measured ticks per case (default 300)\n"
+                    "  --workers <N,N,...>    sweep encode worker threads at the AOI radius instead\n",
+                    exe);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options opts;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--clients") == 0 && value)
+            opts.clients = ParseList(argv[++i]);
+        else if (std::strcmp(arg, "--aoi-radius") == 0 && value)
+            opts.radius = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(arg, "--arena") == 0 && value)
+            opts.arena = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(arg, "--client-budget") == 0 && value)
+            opts.budget = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(arg, "--workers") == 0 && value)
+            opts.workers = ParseList(argv[++i]);
+        else if (std::strcmp(arg, "--ticks") == 0 && value)
+            opts.ticks = std::max<uint32_t>(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1);
+        else if (std::strcmp(arg, "--format") == 0 && value)
+        {
+            const char *f = argv[++i];
+            if (std::strcmp(f, "raw") == 0)
+                opts.format = BroadcastFormat::Raw;
+            else if (std::strcmp(f, "compact") == 0)
+                opts.format = BroadcastFormat::Compact;
+            else if (std::strcmp(f, "delta") == 0)
+                opts.format = BroadcastFormat::Delta;
+            else
+            {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("nw-bench-broadcast: %s format, %.0f x %.0f arena, %u measured ticks per case\n",
+                FormatName(opts.format), opts.arena, opts.arena, opts.ticks);
+    if (!opts.workers.empty())
+    {
+        // Per-receiver encodes spread over the pool; the tick thread
+        // takes part too, so 0 workers is the single-threaded baseline.
+        std::printf("%8s  %8s %10s %10s %9s\n", "clients", "workers", "tick us", "cpu us", "speedup");
+        for (uint32_t clients : opts.clients)
+        {
+            double baseMicros = 0.0;
+            for (uint32_t workers : opts.workers)
+            {
+                const Result r = RunCase(opts, Case{clients, opts.radius, workers});
+                if (baseMicros == 0.0)
+                    baseMicros = r.wallMicros;
+                std::printf("%8u  %8u %10.1f %10.1f %8.2fx\n", clients, workers, r.wallMicros,
+                            r.cpuMicros, baseMicros / r.wallMicros);
+            }
+        }
+        return 0;
+    }
+
+    std::printf("%8s  %-12s %12s %14s %13s %10s %10s\n", "clients", "mode", "KB/tick", "B/client/tick",
+                "packets/tick", "tick us", "cpu us");
+    for (uint32_t clients : opts.clients)
+    {
+        double allToAllBytes = 0.0;
+        for (float radius : {0.0f, opts.radius})
+        {
+            const Result r = RunCase(opts, Case{clients, radius, 0});
+            char mode[32];
+            if (radius > 0.0f)
+                std::snprintf(mode, sizeof(mode), "aoi %.0f", radius);
+            else
+                std::snprintf(mode, sizeof(mode), "all-to-all");
+            std::printf("%8u  %-12s %12.1f %14.0f %13.0f %10.1f %10.1f", clients, mode,
+                        r.bytesPerTick / 1024.0, r.bytesPerTick / clients, r.packetsPerTick,
+                        r.wallMicros, r.cpuMicros);
+            if (radius > 0.0f && allToAllBytes > 0.0)
+                std::printf("  (%.0f%% of all-to-all bytes)", 100.0 * r.bytesPerTick / allToAllBytes);
+            else
+                allToAllBytes = r.bytesPerTick;
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,350 @@
+// ────────────────────────────────────────────────────────────────────
+// nw-bench-clienttable – per-tick client loops, map vs slot map layout
+//
+// Replays the client-state work of a server tick at a fixed client count
+// against two layouts: the original unordered_map<ClientID, ClientState>
+// of whole client structs, and ClientTable (generational slot map with
+// hot columns and ClientHandle references). Each tick applies one
+// position update per client through the connection index, scans for
+// timeouts, collects the broadcast entries in clientID order, updates
+// budgeted send priorities, and churns a few clients.
+// ────────────────────────────────────────────────────────────────────
+
+#include "ClientTable.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t kPriorityCandidates = 64; // entities ranked per receiver
+    constexpr uint32_t kChurnPerTick = 2;        // clients replaced each tick
+
+    enum Phase
+    {
+        Updates,
+        Timeouts,
+        Collect,
+        Priority,
+        Churn,
+        PhaseCount
+    };
+    const char *const kPhaseNames[PhaseCount] = {"updates", "timeouts", "collect", "priority",
+                                                 "churn"};
+
+    struct Options
+    {
+        uint32_t clients = 1000;
+        uint32_t ticks = 2000;
+    };
+
+    struct Result
+    {
+        double micros[PhaseCount] = {};
+        uint64_t checksum = 0; // keeps the loops from being optimised away
+    };
+
+    NetTransformState MakeTransform(std::mt19937 &rng)
+    {
+        std::uniform_real_distribution<float> pos(-4000.0f, 4000.0f);
+        NetTransformState t{};
+        t.posX = pos(rng);
+        t.posY = pos(rng);
+        t.posZ = pos(rng);
+        t.rotW = 1.0f;
+        return t;
+    }
+
+    /// Accumulate priority for a strided window of entries and reset the
+    /// first half, the pattern SelectByPriority leaves behind.
+    template <typename Add, typename Reset>
+    void RankCandidates(size_t entryCount, uint32_t receiver, Add &&add, Reset &&reset)
+    {
+        const size_t n = std::min<size_t>(kPriorityCandidates, entryCount);
+        for (size_t k = 0; k < n; ++k)
+            add((receiver * 7 + k * 13) % entryCount, static_cast<float>(k + 1));
+        for (size_t k = 0; k < n / 2; ++k)
+            reset((receiver * 7 + k * 13) % entryCount);
+    }
+
+    // ── Original layout ────────────────────────────────────────────
+    struct LegacyClientState
+    {
+        ClientID id = INVALID_CLIENT_ID;
+        uint32_t connHandle = 0;
+        NetUUID uuid{};
+        NetObjectID objectID = INVALID_NET_OBJECT_ID;
+        NetTransformState lastTransform{};
+        bool hasTransform = false;
+        bool welcomed = false;
+        std::string nickname;
+        ClientID whisperTargetID = INVALID_CLIENT_ID;
+        std::string whisperTargetNickname;
+        std::chrono::steady_clock::time_point releaseFenceUntil{};
+        std::chrono::steady_clock::time_point lastSeen = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point lastChatTime{};
+        std::unordered_map<ClientID, float> sendPriority;
+        struct SentSnapshot
+        {
+            uint32_t tick = 0;
+            std::vector<ClientID> ids;
+        };
+        std::array<SentSnapshot, kSnapshotHistory> sentSnapshots{};
+        uint32_t ackedTick = 0;
+        std::vector<uint8_t> reliableBundle;
+    };
+
+    Result RunLegacy(const Options &opts)
+    {
+        std::mt19937 rng(7);
+        std::unordered_map<ClientID, LegacyClientState> clients;
+        std::unordered_map<uint32_t, ClientID> connIndex;
+        std::vector<uint32_t> conns;
+        ClientID nextID = 1;
+        auto insert = [&](uint32_t conn)
+        {
+            LegacyClientState &c = clients[nextID];
+            c.id = nextID;
+            c.connHandle = conn;
+            c.welcomed = true;
+            c.hasTransform = true;
+            c.objectID = nextID;
+            c.lastTransform = MakeTransform(rng);
+            c.nickname = "Player " + std::to_string(nextID);
+            connIndex[conn] = nextID++;
+        };
+        for (uint32_t i = 0; i < opts.clients; ++i)
+        {
+            conns.push_back(i + 1);
+            insert(i + 1);
+        }
+
+        Result r;
+        std::vector<NetBroadcastEntry> entries;
+        uint32_t nextConn = opts.clients + 1;
+        for (uint32_t tick = 0; tick < opts.ticks; ++tick)
+        {
+            const Clock::time_point now = Clock::now();
+            Clock::time_point t0 = now;
+            auto lap = [&](Phase p)
+            {
+                const Clock::time_point t1 = Clock::now();
+                r.micros[p] += std::chrono::duration<double, std::micro>(t1 - t0).count();
+                t0 = t1;
+            };
+
+            for (uint32_t conn : conns)
+            {
+                auto it = connIndex.find(conn);
+                auto cit = clients.find(it->second);
+                cit->second.lastTransform.posX += 1.0f;
+                cit->second.lastSeen = now;
+            }
+            lap(Updates);
+
+            for (const auto &kv : clients)
+                r.checksum += (now - kv.second.lastSeen) > std::chrono::seconds(5);
+            lap(Timeouts);
+
+            entries.clear();
+            for (const auto &kv : clients)
+            {
+                const LegacyClientState &c = kv.second;
+                if (!c.welcomed || !c.hasTransform)
+                    continue;
+                NetBroadcastEntry e;
+                e.clientID = c.id;
+                e.objectID = c.objectID;
+                e.transform = c.lastTransform;
+                entries.push_back(e);
+            }
+            std::sort(entries.begin(), entries.end(),
+                      [](const NetBroadcastEntry &a, const NetBroadcastEntry &b)
+                      { return a.clientID < b.clientID; });
+            r.checksum += entries.size();
+            lap(Collect);
+
+            uint32_t receiver = 0;
+            for (auto &kv : clients)
+            {
+                auto &priority = kv.second.sendPriority;
+                RankCandidates(
+                    entries.size(), receiver++,
+                    [&](size_t e, float v) { priority[entries[e].clientID] += v; },
+                    [&](size_t e)
+                    {
+                        auto it = priority.find(entries[e].clientID);
+                        if (it != priority.end())
+                            it->second = 0.0f;
+                    });
+            }
+            lap(Priority);
+
+            for (uint32_t k = 0; k < kChurnPerTick; ++k)
+            {
+                const size_t victim = rng() % conns.size();
+                const ClientID id = connIndex[conns[victim]];
+                clients.erase(id);
+                for (auto &kv : clients)
+                    kv.second.sendPriority.erase(id);
+                connIndex.erase(conns[victim]);
+                conns[victim] = nextConn;
+                insert(nextConn++);
+            }
+            lap(Churn);
+        }
+        return r;
+    }
+
+    // ── ClientTable ────────────────────────────────────────────────
+    Result RunTable(const Options &opts)
+    {
+        std::mt19937 rng(7);
+        ClientTable clients;
+        std::unordered_map<uint32_t, ClientHandle> connIndex;
+        std::vector<uint32_t> conns;
+        ClientID nextID = 1;
+        auto insert = [&](uint32_t conn)
+        {
+            const uint32_t i = clients.Insert(nextID, conn);
+            clients.SetFlag(i, ClientTable::Welcomed, true);
+            clients.SetFlag(i, ClientTable::HasTransform, true);
+            clients.objectIDs[i] = nextID;
+            clients.transforms[i] = MakeTransform(rng);
+            clients.cold[i].nickname = "Player " + std::to_string(nextID);
+            connIndex[conn] = clients.HandleOf(i);
+            ++nextID;
+        };
+        for (uint32_t i = 0; i < opts.clients; ++i)
+        {
+            conns.push_back(i + 1);
+            insert(i + 1);
+        }
+
+        Result r;
+        std::vector<uint32_t> members;
+        std::vector<NetBroadcastEntry> entries;
+        std::vector<ClientHandle> owners;
+        uint32_t nextConn = opts.clients + 1;
+        constexpr uint8_t kBroadcastable = ClientTable::Welcomed | ClientTable::HasTransform;
+        for (uint32_t tick = 0; tick < opts.ticks; ++tick)
+        {
+            const Clock::time_point now = Clock::now();
+            Clock::time_point t0 = now;
+            auto lap = [&](Phase p)
+            {
+                const Clock::time_point t1 = Clock::now();
+                r.micros[p] += std::chrono::duration<double, std::micro>(t1 - t0).count();
+                t0 = t1;
+            };
+
+            for (uint32_t conn : conns)
+            {
+                const uint32_t i = clients.Resolve(connIndex.find(conn)->second);
+                clients.transforms[i].posX += 1.0f;
+                clients.lastSeen[i] = now;
+            }
+            lap(Updates);
+
+            for (const Clock::time_point &seen : clients.lastSeen)
+                r.checksum += (now - seen) > std::chrono::seconds(5);
+            lap(Timeouts);
+
+            members.clear();
+            for (uint32_t i = 0; i < clients.Size(); ++i)
+                members.push_back(i);
+            std::sort(members.begin(), members.end(), [&](uint32_t a, uint32_t b)
+                      { return clients.ids[a] < clients.ids[b]; });
+            entries.clear();
+            owners.clear();
+            for (uint32_t i : members)
+            {
+                if ((clients.flags[i] & kBroadcastable) != kBroadcastable)
+                    continue;
+                NetBroadcastEntry e;
+                e.clientID = clients.ids[i];
+                e.objectID = clients.objectIDs[i];
+                e.transform = clients.transforms[i];
+                entries.push_back(e);
+                owners.push_back(clients.HandleOf(i));
+            }
+            r.checksum += entries.size();
+            lap(Collect);
+
+            for (uint32_t i = 0; i < clients.Size(); ++i)
+            {
+                ClientColdState &cold = clients.cold[i];
+                RankCandidates(
+                    entries.size(), i,
+                    [&](size_t e, float v) { cold.PriorityOf(owners[e]) += v; },
+                    [&](size_t e) { cold.PriorityOf(owners[e]) = 0.0f; });
+            }
+            lap(Priority);
+
+            for (uint32_t k = 0; k < kChurnPerTick; ++k)
+            {
+                const size_t victim = rng() % conns.size();
+                auto it = connIndex.find(conns[victim]);
+                clients.Remove(clients.Resolve(it->second));
+                connIndex.erase(it);
+                conns[victim] = nextConn;
+                insert(nextConn++);
+            }
+            lap(Churn);
+        }
+        return r;
+    }
+
+    void PrintRow(const char *name, const Result &r, uint32_t ticks)
+    {
+        double total = 0.0;
+        std::printf("%-24s", name);
+        for (int p = 0; p < PhaseCount; ++p)
+        {
+            std::printf(" %9.1f", r.micros[p] / ticks);
+            total += r.micros[p];
+        }
+        std::printf(" %9.1f\n", total / ticks);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options opts;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--clients") == 0 && i + 1 < argc)
+            opts.clients = std::max<uint32_t>(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1);
+        else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+            opts.ticks = std::max<uint32_t>(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1);
+        else
+        {
+            std::printf("Usage: %s [--clients N (default 1000)] [--ticks N (default 2000)]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const Result legacy = RunLegacy(opts);
+    const Result table = RunTable(opts);
+
+    std::printf("nw-bench-clienttable: %u clients, %u ticks, microseconds per tick\n",
+                opts.clients, opts.ticks);
+    std::printf("%-24s", "layout");
+    for (const char *name : kPhaseNames)
+        std::printf(" %9s", name);
+    std::printf(" %9s\n", "total");
+    PrintRow("unordered_map<ID,state>", legacy, opts.ticks);
+    PrintRow("ClientTable", table, opts.ticks);
+    return legacy.checksum == table.checksum ? 0 : 2;
+}
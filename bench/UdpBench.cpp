@@ -0,0 +1,435 @@
+// ────────────────────────────────────────────────────────────────────
+// nw-bench-udp – loopback packet rate and system calls per packet
+//
+// Drives the UDP driver's nbnet entry points directly, without a game
+// server: a sender thread floods the server port over loopback from a
+// set of client sockets while the calling thread waits and drains like
+// the nbnet thread does, then the server answers every peer. Each
+// shard count is run with recvfrom / sendto and with recvmmsg /
+// sendmmsg, next to a single non-blocking socket drained on the calling
+// thread, which is what nbnet's stock driver does.
+//
+// Linux only, like UdpDriver.
+// ────────────────────────────────────────────────────────────────────
+
+#include "BenchNet.h"
+#include "UdpDriver.h"
+
+extern "C"
+{
+#include <net_drivers/udp.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint16_t kBenchPort = 47998;
+    constexpr uint32_t kProtocolId = 1;
+    constexpr int kWaitMillis = 1;          // idle wait between drains
+    constexpr uint32_t kSendsPerFlush = 256; // about one tick of answers
+    constexpr uint32_t kSenderBurst = 64;    // datagrams between yields
+
+    /// Swallows the driver's start-up line.
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    struct Options
+    {
+        std::vector<uint32_t> shards{1, 2, 4};
+        double seconds = 2.0;
+        uint32_t peers = 32;
+        uint32_t size = 200; // datagram bytes, a typical position update
+        uint32_t sends = 200000;
+    };
+
+    struct Case
+    {
+        uint32_t shards; // 0: stock single socket on the calling thread
+        bool batched;
+    };
+
+    struct Result
+    {
+        uint64_t offered = 0;   // datagrams the sender got into the kernel
+        uint64_t delivered = 0; // datagrams handed to nbnet
+        double recvCallsPerPacket = 0.0;
+        double recvCpuMicros = 0.0; // process CPU per delivered datagram, sender included
+        double sendPps = 0.0;
+        double sendCallsPerPacket = 0.0;
+        double sendCpuMicros = 0.0;
+        uint64_t sendDrops = 0;
+        uint64_t ringStalls = 0;
+    };
+
+    double ProcessCpuSeconds()
+    {
+        timespec t;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+        return static_cast<double>(t.tv_sec) + static_cast<double>(t.tv_nsec) * 1e-9;
+    }
+
+    sockaddr_in LoopbackAddress(uint16_t port)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        return addr;
+    }
+
+    /// Stand-in for nbnet's stock driver: one non-blocking socket read
+    /// and written on the calling thread, one system call per datagram.
+    class StockSocket
+    {
+    public:
+        bool Start(uint16_t port)
+        {
+            m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_ANY);
+            addr.sin_port = htons(port);
+            const int bufferBytes = 4 << 20;
+            setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+            setsockopt(m_fd, SOL_SOCKET, SO_SNDBUF, &bufferBytes, sizeof(bufferBytes));
+            return m_fd >= 0 && bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+        }
+
+        void Stop()
+        {
+            if (m_fd >= 0)
+                close(m_fd);
+            m_fd = -1;
+            m_peers.clear();
+        }
+
+        int Fd() const { return m_fd; }
+
+        void Drain()
+        {
+            uint8_t buffer[NBN_PACKET_MAX_SIZE];
+            for (;;)
+            {
+                sockaddr_in from{};
+                socklen_t fromLen = sizeof(from);
+                ++receiveCalls;
+                const ssize_t bytes = recvfrom(m_fd, buffer, sizeof(buffer), 0,
+                                               reinterpret_cast<sockaddr *>(&from), &fromLen);
+                if (bytes <= 0)
+                    return;
+                if (std::find_if(m_peers.begin(), m_peers.end(), [&](const sockaddr_in &p)
+                                 { return p.sin_port == from.sin_port; }) == m_peers.end())
+                    m_peers.push_back(from);
+                NBN_Packet packet;
+                if (NBN_Packet_InitRead(&packet, nullptr, buffer, static_cast<unsigned int>(bytes)) == 0)
+                    NBN_Driver_RaiseEvent(NBN_DRIVER_SERV_CLIENT_PACKET_RECEIVED, &packet);
+            }
+        }
+
+        bool SendTo(const NBN_Packet &packet, size_t peer)
+        {
+            const sockaddr_in &to = m_peers[peer % m_peers.size()];
+            ++sendCalls;
+            return sendto(m_fd, packet.buffer, packet.size, MSG_DONTWAIT,
+                          reinterpret_cast<const sockaddr *>(&to), sizeof(to)) >= 0;
+        }
+
+        size_t PeerCount() const { return m_peers.size(); }
+
+        uint64_t receiveCalls = 0;
+        uint64_t sendCalls = 0;
+
+    private:
+        int m_fd = -1;
+        std::vector<sockaddr_in> m_peers;
+    };
+
+    /// Floods the server port from `peers` sockets until stopped.
+    class Flood
+    {
+    public:
+        Flood(uint32_t peers, uint32_t size) : m_payload(size, 0x5A)
+        {
+            const sockaddr_in any = LoopbackAddress(0);
+            for (uint32_t i = 0; i < peers; ++i)
+            {
+                const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+                const int bufferBytes = 1 << 20;
+                setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+                bind(fd, reinterpret_cast<const sockaddr *>(&any), sizeof(any));
+                m_fds.push_back(fd);
+            }
+        }
+
+        ~Flood()
+        {
+            Stop();
+            for (int fd : m_fds)
+                close(fd);
+        }
+
+        void Start(uint16_t port)
+        {
+            m_stop.store(false, std::memory_order_relaxed);
+            m_thread = std::thread([this, port] { Run(port); });
+        }
+
+        /// Stops the flood; returns the datagrams the kernel accepted.
+        uint64_t Stop()
+        {
+            m_stop.store(true, std::memory_order_relaxed);
+            if (m_thread.joinable())
+                m_thread.join();
+            return m_offered;
+        }
+
+    private:
+        void Run(uint16_t port)
+        {
+            const sockaddr_in to = LoopbackAddress(port);
+            m_offered = 0;
+            for (uint64_t n = 0; !m_stop.load(std::memory_order_relaxed);)
+            {
+                for (uint32_t k = 0; k < kSenderBurst; ++k, ++n)
+                {
+                    if (sendto(m_fds[n % m_fds.size()], m_payload.data(), m_payload.size(), 0,
+                               reinterpret_cast<const sockaddr *>(&to), sizeof(to)) > 0)
+                        ++m_offered;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        std::vector<int> m_fds;
+        std::vector<uint8_t> m_payload;
+        std::thread m_thread;
+        std::atomic<bool> m_stop{false};
+        uint64_t m_offered = 0;
+    };
+
+    /// Poll `fd` for up to kWaitMillis, as the idle waits in NetTransport do.
+    void WaitReadable(int fd)
+    {
+        pollfd p{fd, POLLIN, 0};
+        poll(&p, 1, kWaitMillis);
+    }
+
+    Result RunCase(const Options &opts, const Case &c)
+    {
+        Result r;
+        Flood flood(opts.peers, opts.size);
+        StockSocket stock;
+        const NBN_DriverImplementation *driver = nullptr;
+
+        NullBuffer mute;
+        std::streambuf *log = std::cout.rdbuf(&mute);
+        bool started;
+        if (c.shards == 0)
+            started = stock.Start(kBenchPort);
+        else
+        {
+            UdpDriver::Config config;
+            config.receiveShards = c.shards;
+            config.batched = c.batched;
+            started = UdpDriver::Register(config) &&
+                      (driver = BenchNet::Driver(NBN_UDP_DRIVER_ID)) != nullptr &&
+                      driver->serv_start(kProtocolId, kBenchPort, false) == 0;
+        }
+        std::cout.rdbuf(log);
+        if (!started)
+        {
+            std::fprintf(stderr, "nw-bench-udp: cannot start on port %u\n", kBenchPort);
+            std::exit(1);
+        }
+
+        // Counters are totals since the driver was first started.
+        const UdpDriver::Stats before = UdpDriver::GetStats();
+        auto drain = [&]
+        {
+            if (driver)
+            {
+                WaitReadable(UdpDriver::ReadyFd());
+                driver->serv_recv_packets();
+            }
+            else
+            {
+                WaitReadable(stock.Fd());
+                stock.Drain();
+            }
+        };
+
+        // ── Receive ───────────────────────────────────────────────
+        BenchNet::TakeDriverPackets();
+        const double recvCpuStart = ProcessCpuSeconds();
+        flood.Start(kBenchPort);
+        const Clock::time_point end =
+            Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opts.seconds));
+        while (Clock::now() < end)
+            drain();
+        r.offered = flood.Stop();
+        // Whatever is still queued in the kernel or the rings.
+        for (int i = 0; i < 20; ++i)
+            drain();
+        const double recvCpuEnd = ProcessCpuSeconds();
+        r.delivered = BenchNet::TakeDriverPackets();
+
+        const UdpDriver::Stats received = UdpDriver::GetStats();
+        const uint64_t recvCalls =
+            driver ? received.receiveCalls - before.receiveCalls : stock.receiveCalls;
+        r.recvCallsPerPacket = static_cast<double>(recvCalls) / std::max<uint64_t>(r.delivered, 1);
+        r.recvCpuMicros = (recvCpuEnd - recvCpuStart) * 1e6 / std::max<uint64_t>(r.delivered, 1);
+        r.ringStalls = driver ? received.ringStalls - before.ringStalls : 0;
+
+        // ── Send ──────────────────────────────────────────────────
+        // Every peer the flood came from gets an equal share.
+        const std::vector<NBN_Connection *> connections = BenchNet::TakeDriverConnections();
+        if (driver ? connections.empty() : stock.PeerCount() == 0)
+        {
+            std::fprintf(stderr, "nw-bench-udp: nothing arrived over loopback\n");
+            std::exit(1);
+        }
+        NBN_Packet packet{};
+        std::memset(packet.buffer, 0x5A, opts.size);
+        packet.size = opts.size;
+        uint64_t drops = 0;
+        const Clock::time_point sendStart = Clock::now();
+        const double sendCpuStart = ProcessCpuSeconds();
+        for (uint32_t n = 0; n < opts.sends; ++n)
+        {
+            if (driver)
+            {
+                driver->serv_send_packet_to(&packet, connections[n % connections.size()]);
+                if (n % kSendsPerFlush == kSendsPerFlush - 1)
+                    UdpDriver::FlushSends();
+            }
+            else if (!stock.SendTo(packet, n))
+                ++drops;
+        }
+        UdpDriver::FlushSends();
+        const double sendCpuEnd = ProcessCpuSeconds();
+        const double sendSeconds = std::chrono::duration<double>(Clock::now() - sendStart).count();
+
+        const UdpDriver::Stats sent = UdpDriver::GetStats();
+        const uint64_t sendCalls = driver ? sent.sendCalls - received.sendCalls : stock.sendCalls;
+        r.sendDrops = driver ? sent.sendDrops - received.sendDrops : drops;
+        r.sendPps = opts.sends / sendSeconds;
+        r.sendCallsPerPacket = static_cast<double>(sendCalls) / opts.sends;
+        r.sendCpuMicros = (sendCpuEnd - sendCpuStart) * 1e6 / opts.sends;
+
+        if (driver)
+            driver->serv_stop(); // the connections' peers go with it
+        else
+            stock.Stop();
+        for (NBN_Connection *connection : connections)
+            std::free(connection);
+        return r;
+    }
+
+    std::vector<uint32_t> ParseList(const char *s)
+    {
+        std::vector<uint32_t> out;
+        for (char *end = nullptr; *s; s = (*end == ',') ? end + 1 : end)
+        {
+            out.push_back(static_cast<uint32_t>(std::strtoul(s, &end, 10)));
+            if (end == s)
+                break;
+        }
+        return out;
+    }
+
+    void PrintUsage(const char *exe)
+    {
+        std::printf("Usage: %s [options]\n"
+                    "  --shards <N,N,...>   receive shard counts (default 1,2,4)\n"
+                    "  --seconds <s>        receive flood per case (default 2)\n"
+                    "  --peers <N>          client sockets in the flood (default 32)\n"
+                    "  --size <B>           datagram bytes (default 200)\n"
+                    "  --sends <N>          datagrams sent per case (default 200000)\n",
+                    exe);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options opts;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--shards") == 0 && value)
+            opts.shards = ParseList(argv[++i]);
+        else if (std::strcmp(arg, "--seconds") == 0 && value)
+            opts.seconds = std::max(std::strtod(argv[++i], nullptr), 0.1);
+        else if (std::strcmp(arg, "--peers") == 0 && value)
+            opts.peers = std::max<uint32_t>(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1);
+        else if (std::strcmp(arg, "--size") == 0 && value)
+            opts.size = std::clamp<uint32_t>(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1,
+                                             NBN_PACKET_MAX_SIZE);
+        else if (std::strcmp(arg, "--sends") == 0 && value)
+            opts.sends = std::max<uint32_t>(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1);
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!UdpDriver::Register(UdpDriver::Config{}))
+    {
+        std::printf("nw-bench-udp: the sharded UDP driver is not supported on this platform\n");
+        return 1;
+    }
+
+    std::vector<Case> cases{{0, false}};
+    for (uint32_t shards : opts.shards)
+    {
+        cases.push_back(Case{std::max<uint32_t>(shards, 1), false});
+        cases.push_back(Case{std::max<uint32_t>(shards, 1), true});
+    }
+
+    std::printf("nw-bench-udp: %u peers, %u B datagrams, %.1f s flood, %u sends per case, %u cpu(s)\n",
+                opts.peers, opts.size, opts.seconds, opts.sends, std::thread::hardware_concurrency());
+    std::printf("%-20s %10s %7s %10s %10s | %10s %10s %10s %7s\n", "driver", "recv pps", "lost",
+                "calls/pkt", "cpu us/pkt", "send pps", "calls/pkt", "cpu us/pkt", "drops");
+    for (const Case &c : cases)
+    {
+        const Result r = RunCase(opts, c);
+        char name[32];
+        if (c.shards == 0)
+            std::snprintf(name, sizeof(name), "stock (1 socket)");
+        else
+            std::snprintf(name, sizeof(name), "%u shard(s) %s", c.shards, c.batched ? "mmsg" : "single");
+        const double lost = r.offered > r.delivered
+                                ? 100.0 * static_cast<double>(r.offered - r.delivered) / r.offered
+                                : 0.0;
+        std::printf("%-20s %10.0f %6.1f%% %10.3f %10.2f | %10.0f %10.3f %10.2f %7llu", name,
+                    r.delivered / opts.seconds, lost, r.recvCallsPerPacket, r.recvCpuMicros, r.sendPps,
+                    r.sendCallsPerPacket, r.sendCpuMicros, static_cast<unsigned long long>(r.sendDrops));
+        if (r.ringStalls > 0)
+            std::printf("  (%llu ring stalls)", static_cast<unsigned long long>(r.ringStalls));
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -8,10 +8,20 @@ using ClientID = uint32_t;
 /// Unique identifier for a networked game object.
 using NetObjectID = uint32_t;
 
+/// Identifier of a room (one independent match on the server).
+using RoomID = uint32_t;
+
 /// Reserved value: "not assigned yet".
 constexpr ClientID INVALID_CLIENT_ID = 0;
 constexpr NetObjectID INVALID_NET_OBJECT_ID = 0;
 
+/// Room every client is in after joining; it always exists.
+constexpr RoomID DEFAULT_ROOM_ID = 0;
+
+/// nbnet rejection code sent to new connections while the server is
+/// overloaded; the client may retry later.
+constexpr int CONNECTION_REJECT_SERVER_BUSY = 1;
+
 /// Default network settings.
 constexpr uint16_t DEFAULT_SERVER_PORT = 7777;
 constexpr const char *DEFAULT_SERVER_HOST = "127.0.0.1";
@@ -9,12 +9,22 @@ enum class NetMessageType : uint8_t
     ServerWelcome = 0x02,    // S→C  server assigns ClientID
     ClientDisconnect = 0x03, // C→S  graceful disconnect
     Heartbeat = 0x04,        // C→S  keep-alive while idle (menu/options)
+    MessageBundle = 0x05,    // C↔S  several reliable messages in one packet
 
     // ── Flight state sync ────────────────────
     PositionUpdate = 0x10,    // C→S  client sends own flight state
     PositionBroadcast = 0x11, // S→C  server broadcasts all flight states
     ObjectDespawn = 0x12,     // S→C  server tells clients to remove an object
     ObjectRelease = 0x13,     // C→S  client releases object (stay connected)
+    PositionBroadcastCompact = 0x14, // S→C  quantized, bit-packed flight states
+    SnapshotAck = 0x15,              // C→S  last broadcast tick fully received
+    PositionBroadcastDelta = 0x16,   // S→C  compact states delta-coded vs an acked tick
+    SnapshotRate = 0x17,             // C→S  preferred position broadcast rate
+    PositionRelay = 0x18,            // S→C  relay-mode states between two broadcasts
+
+    // ── Rooms ────────────────────────────────
+    RoomJoin = 0x20,  // C↔S  C: move me to a room; S: the room you are now in
+    RoomLeave = 0x21, // C→S  go back to the default room
 
     // ── Chat ─────────────────────────────────
     ChatRequest = 0x40,           // C→S  client sends a chat message
@@ -26,8 +36,6 @@ enum class NetMessageType : uint8_t
     PlayerMetaRemove = 0x46,      // S→C remove one player's metadata
 
     // ── Future (reserved) ───────────────────
-    // RoomJoin      = 0x20,
-    // RoomLeave     = 0x21,
     // FireBullet    = 0x30,
     // HitConfirm    = 0x31,
 };
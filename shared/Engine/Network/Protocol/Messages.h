@@ -46,6 +46,16 @@ struct MsgHeartbeat
     ClientID clientID = INVALID_CLIENT_ID;
 };
 
+/// C↔S : several complete messages coalesced into one reliable packet.
+/// Variable-length: header + messageCount × (uint16_t length + message bytes).
+/// Bundles never nest.
+struct MsgMessageBundle
+{
+    NetPacketHeader header{NetMessageType::MessageBundle};
+    uint16_t messageCount = 0;
+    // Followed by `messageCount` length-prefixed messages.
+};
+
 // ── Flight state sync ────────────────────────────────────────────────
 
 /// Compact flight state for one object (transform + velocity).
@@ -84,6 +94,90 @@ struct MsgPositionBroadcast
     // Followed by `entryCount` NetBroadcastEntry structs in the buffer.
 };
 
+/// Quantization settings for the compact broadcast formats. Carried in
+/// every compact packet header so the client needs no side configuration.
+struct NetQuantizationParams
+{
+    float worldBound = 8192.0f;     // positions clamped to [-bound, bound]
+    float maxLinearSpeed = 512.0f;  // linear velocity clamped to [-max, max]
+    float maxAngularSpeed = 32.0f;  // angular velocity clamped to [-max, max]
+    uint8_t positionBits = 21;      // per axis (~8 mm at the default bound)
+    uint8_t rotationBits = 10;      // per smallest-three component
+    uint8_t velocityBits = 12;      // per velocity axis
+};
+
+/// S→C : quantized positions of the players visible to this client.
+/// Variable-length: header + bit-packed entries
+/// (see NetQuantization::WriteEntry for the entry layout).
+/// Large ticks are split into `chunkCount` independently decodable chunks;
+/// a client should only treat the tick as complete (and ack it) once
+/// every chunk has arrived.
+struct MsgPositionBroadcastCompact
+{
+    NetPacketHeader header{NetMessageType::PositionBroadcastCompact};
+    uint32_t serverTick = 0;
+    uint16_t entryCount = 0;
+    uint8_t chunkIndex = 0;
+    uint8_t chunkCount = 1;
+    NetQuantizationParams quant{};
+    // Followed by `entryCount` bit-packed entries, padded to a whole byte.
+};
+
+/// C→S : acknowledge the newest broadcast tick the client has decoded.
+/// The server uses it as the baseline for PositionBroadcastDelta.
+struct MsgSnapshotAck
+{
+    NetPacketHeader header{NetMessageType::SnapshotAck};
+    uint32_t serverTick = 0;
+};
+
+/// S→C : compact positions coded against the snapshot the client acked
+/// at `baselineTick`. Both sides keep snapshots sorted by clientID.
+/// Chunked like MsgPositionBroadcastCompact: each chunk covers baseline
+/// entries [baselineBegin, baselineBegin + baselineCount).
+/// Bit-packed body:
+///   for each of `baselineCount` baseline entries:
+///     1 bit present; if present: 1 bit changed; if changed: 4-bit field
+///     mask (pos, rot, linVel, angVel) followed by the changed fields.
+///   then `newCount` full entries (see NetQuantization::WriteEntry).
+struct MsgPositionBroadcastDelta
+{
+    NetPacketHeader header{NetMessageType::PositionBroadcastDelta};
+    uint32_t serverTick = 0;
+    uint32_t baselineTick = 0;
+    uint16_t baselineBegin = 0;
+    uint16_t baselineCount = 0;
+    uint16_t newCount = 0;
+    uint8_t chunkIndex = 0;
+    uint8_t chunkCount = 1;
+    NetQuantizationParams quant{};
+};
+
+/// S→C : relay mode, sent between tick broadcasts. The newest states of
+/// entities that moved since the broadcast of `serverTick`, in the
+/// PositionBroadcast entry layout. Relays order by (serverTick, relaySeq):
+/// after that broadcast, before the next one (relaySeq counts from 1
+/// within a tick). Apply a relay only if it is newer than everything
+/// applied so far; it is partial, so never ack it or keep it as a delta
+/// baseline.
+struct MsgPositionRelay
+{
+    NetPacketHeader header{NetMessageType::PositionRelay};
+    uint32_t serverTick = 0;
+    uint16_t relaySeq = 0;
+    uint16_t entryCount = 0;
+    // Followed by `entryCount` NetBroadcastEntry structs in the buffer.
+};
+
+/// C→S : how many position broadcasts per second this client wants
+/// (0 = server default). The server sends every Nth tick, N rounded from
+/// its tick rate, so the rate never exceeds the tick rate.
+struct MsgSnapshotRate
+{
+    NetPacketHeader header{NetMessageType::SnapshotRate};
+    uint16_t snapshotsPerSecond = 0;
+};
+
 /// S→C : server notifies that a network object should be removed.
 struct MsgObjectDespawn
 {
@@ -101,6 +195,24 @@ struct MsgObjectRelease
     NetObjectID objectID = INVALID_NET_OBJECT_ID;
 };
 
+// ── Rooms ───────────────────────────────────────────────────────────
+
+/// C→S : move to room `roomID` (created on first join) without reconnecting.
+/// S→C : the room the client is in now; sent after every RoomJoin/RoomLeave,
+///       carrying the old room if the move was refused.
+/// Positions, player metadata and public chat are scoped to the room.
+struct MsgRoomJoin
+{
+    NetPacketHeader header{NetMessageType::RoomJoin};
+    RoomID roomID = DEFAULT_ROOM_ID;
+};
+
+/// C→S : leave the current room for the default room.
+struct MsgRoomLeave
+{
+    NetPacketHeader header{NetMessageType::RoomLeave};
+};
+
 // ── Chat ────────────────────────────────────────────────────────────
 
 /// Chat channel / message type.
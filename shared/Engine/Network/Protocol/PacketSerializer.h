@@ -1,7 +1,10 @@
 #pragma once
 #include "Engine/Network/Protocol/Messages.h"
+#include "Engine/Network/Protocol/Quantization.h"
 #include <vector>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <cstdint>
 #include <cstring>
 #include <cassert>
@@ -13,6 +16,104 @@
 namespace PacketSerializer
 {
 
+    // ────────────────────── Buffer writers ──────────────────────
+    //
+    // Zero-allocation counterparts of the Write* functions: they serialize
+    // into caller-provided memory (a stack buffer, a frame arena block, an
+    // nbnet message) and return the number of bytes written, or 0 without
+    // touching `dst` when `cap` is too small.
+
+    /// Largest serialized size of a `Msg` packet, for sizing buffers.
+    template <typename Msg>
+    inline constexpr size_t kMaxPacketSize = sizeof(Msg);
+    template <>
+    inline constexpr size_t kMaxPacketSize<MsgChatBroadcast> =
+        sizeof(MsgChatBroadcast) + 255 + sizeof(uint16_t) + 512;
+    template <>
+    inline constexpr size_t kMaxPacketSize<MsgNicknameUpdateResult> =
+        sizeof(MsgNicknameUpdateResult) + 255;
+    template <>
+    inline constexpr size_t kMaxPacketSize<MsgPlayerMetaUpsert> =
+        sizeof(MsgPlayerMetaUpsert) + 255;
+
+    /// Fixed-size message: a single memcpy of the packed struct.
+    template <typename Msg>
+    inline size_t WriteTo(uint8_t *dst, size_t cap, const Msg &msg)
+    {
+        static_assert(std::is_trivially_copyable<Msg>::value,
+                      "network messages must be packed PODs");
+        if (cap < sizeof(Msg))
+            return 0;
+        std::memcpy(dst, &msg, sizeof(Msg));
+        return sizeof(Msg);
+    }
+
+    /// Message header followed by `tailLen` raw bytes (text, entries, ...).
+    template <typename Msg>
+    inline size_t WriteTo(uint8_t *dst, size_t cap, const Msg &hdr,
+                          const void *tail, size_t tailLen)
+    {
+        static_assert(std::is_trivially_copyable<Msg>::value,
+                      "network messages must be packed PODs");
+        if (cap < sizeof(Msg) + tailLen)
+            return 0;
+        std::memcpy(dst, &hdr, sizeof(Msg));
+        if (tailLen > 0)
+            std::memcpy(dst + sizeof(Msg), tail, tailLen);
+        return sizeof(Msg) + tailLen;
+    }
+
+    /// Build a ChatBroadcast packet (S→C) into `dst`.
+    inline size_t WriteChatBroadcastTo(uint8_t *dst, size_t cap,
+                                       ChatMessageType chatType,
+                                       ClientID senderID,
+                                       std::string_view senderName,
+                                       std::string_view text)
+    {
+        MsgChatBroadcast hdr;
+        hdr.chatType = chatType;
+        hdr.senderClientID = senderID;
+        hdr.senderNameLength = static_cast<uint8_t>(
+            std::min(senderName.size(), static_cast<size_t>(255)));
+        const uint16_t textLen = static_cast<uint16_t>(
+            std::min(text.size(), static_cast<size_t>(512)));
+
+        const size_t total = sizeof(hdr) + hdr.senderNameLength + sizeof(textLen) + textLen;
+        if (cap < total)
+            return 0;
+
+        size_t offset = WriteTo(dst, cap, hdr, senderName.data(), hdr.senderNameLength);
+        std::memcpy(dst + offset, &textLen, sizeof(textLen));
+        offset += sizeof(textLen);
+        if (textLen > 0)
+            std::memcpy(dst + offset, text.data(), textLen);
+        return total;
+    }
+
+    /// Build a NicknameUpdateResult packet (S→C) into `dst`.
+    inline size_t WriteNicknameUpdateResultTo(uint8_t *dst, size_t cap,
+                                              NicknameUpdateStatus status,
+                                              std::string_view nickname)
+    {
+        MsgNicknameUpdateResult hdr;
+        hdr.status = status;
+        hdr.nicknameLength = static_cast<uint8_t>(
+            std::min(nickname.size(), static_cast<size_t>(255)));
+        return WriteTo(dst, cap, hdr, nickname.data(), hdr.nicknameLength);
+    }
+
+    /// Build a PlayerMetaUpsert packet (S→C) into `dst`.
+    inline size_t WritePlayerMetaUpsertTo(uint8_t *dst, size_t cap,
+                                          ClientID clientID,
+                                          std::string_view nickname)
+    {
+        MsgPlayerMetaUpsert hdr;
+        hdr.clientID = clientID;
+        hdr.nicknameLength = static_cast<uint8_t>(
+            std::min(nickname.size(), static_cast<size_t>(255)));
+        return WriteTo(dst, cap, hdr, nickname.data(), hdr.nicknameLength);
+    }
+
     // ────────────────────── Writers ──────────────────────
 
     inline std::vector<uint8_t> WriteClientHello(const NetUUID &uuid)
@@ -45,25 +146,469 @@ namespace PacketSerializer
         return buf;
     }
 
+    /// Append one PositionBroadcast packet to `buf` (any vector-like byte
+    /// container, e.g. an arena-backed std::pmr::vector).
+    template <typename Buffer>
+    inline void AppendPositionBroadcast(Buffer &buf,
+                                        const NetBroadcastEntry *entries,
+                                        size_t count,
+                                        uint32_t serverTick)
+    {
+        MsgPositionBroadcast hdr;
+        hdr.serverTick = serverTick;
+        hdr.entryCount = static_cast<uint16_t>(count);
+        const size_t start = buf.size();
+        buf.resize(start + sizeof(hdr) + count * sizeof(NetBroadcastEntry));
+        std::memcpy(buf.data() + start, &hdr, sizeof(hdr));
+        if (count > 0)
+        {
+            std::memcpy(buf.data() + start + sizeof(hdr),
+                        entries,
+                        count * sizeof(NetBroadcastEntry));
+        }
+    }
+
     inline std::vector<uint8_t> WritePositionBroadcast(
         const std::vector<NetBroadcastEntry> &entries,
         uint32_t serverTick)
     {
-        MsgPositionBroadcast hdr;
+        std::vector<uint8_t> buf;
+        AppendPositionBroadcast(buf, entries.data(), entries.size(), serverTick);
+        return buf;
+    }
+
+    /// A tick's broadcast split into independently decodable packets.
+    using PacketChunks = std::vector<std::vector<uint8_t>>;
+
+    /// Split a PositionBroadcast into packets of at most `maxPayload` bytes,
+    /// appended to `out` (PacketChunks or any vector of byte buffers).
+    /// Each chunk is a complete MsgPositionBroadcast for the same tick.
+    /// `maxPayload` == 0 disables splitting.
+    template <typename Chunks>
+    inline void AppendPositionBroadcastChunks(Chunks &out,
+                                              const NetBroadcastEntry *entries,
+                                              size_t count,
+                                              uint32_t serverTick,
+                                              size_t maxPayload)
+    {
+        size_t perChunk = count;
+        if (maxPayload > sizeof(MsgPositionBroadcast))
+            perChunk = std::max<size_t>(
+                (maxPayload - sizeof(MsgPositionBroadcast)) / sizeof(NetBroadcastEntry), 1);
+        perChunk = std::min(std::max<size_t>(perChunk, 1), static_cast<size_t>(UINT16_MAX));
+
+        for (size_t begin = 0; begin < count; begin += perChunk)
+        {
+            const size_t end = std::min(count, begin + perChunk);
+            out.emplace_back();
+            AppendPositionBroadcast(out.back(), entries + begin, end - begin, serverTick);
+        }
+    }
+
+    /// Append one PositionRelay packet to `buf`.
+    template <typename Buffer>
+    inline void AppendPositionRelay(Buffer &buf,
+                                    const NetBroadcastEntry *entries,
+                                    size_t count,
+                                    uint32_t serverTick,
+                                    uint16_t relaySeq)
+    {
+        MsgPositionRelay hdr;
         hdr.serverTick = serverTick;
-        hdr.entryCount = static_cast<uint16_t>(entries.size());
-        size_t totalSize = sizeof(hdr) + entries.size() * sizeof(NetBroadcastEntry);
-        std::vector<uint8_t> buf(totalSize);
-        std::memcpy(buf.data(), &hdr, sizeof(hdr));
-        if (!entries.empty())
+        hdr.relaySeq = relaySeq;
+        hdr.entryCount = static_cast<uint16_t>(count);
+        const size_t start = buf.size();
+        buf.resize(start + sizeof(hdr) + count * sizeof(NetBroadcastEntry));
+        std::memcpy(buf.data() + start, &hdr, sizeof(hdr));
+        if (count > 0)
         {
-            std::memcpy(buf.data() + sizeof(hdr),
-                        entries.data(),
-                        entries.size() * sizeof(NetBroadcastEntry));
+            std::memcpy(buf.data() + start + sizeof(hdr),
+                        entries,
+                        count * sizeof(NetBroadcastEntry));
         }
+    }
+
+    /// Split a PositionRelay into packets of at most `maxPayload` bytes
+    /// (0 = single packet), all with the same tick and sequence.
+    template <typename Chunks>
+    inline void AppendPositionRelayChunks(Chunks &out,
+                                          const NetBroadcastEntry *entries,
+                                          size_t count,
+                                          uint32_t serverTick,
+                                          uint16_t relaySeq,
+                                          size_t maxPayload)
+    {
+        size_t perChunk = count;
+        if (maxPayload > sizeof(MsgPositionRelay))
+            perChunk = (maxPayload - sizeof(MsgPositionRelay)) / sizeof(NetBroadcastEntry);
+        perChunk = std::min(std::max<size_t>(perChunk, 1), static_cast<size_t>(UINT16_MAX));
+
+        for (size_t begin = 0; begin < count; begin += perChunk)
+        {
+            const size_t end = std::min(count, begin + perChunk);
+            out.emplace_back();
+            AppendPositionRelay(out.back(), entries + begin, end - begin, serverTick, relaySeq);
+        }
+    }
+
+    inline PacketChunks WritePositionBroadcastChunks(
+        const std::vector<NetBroadcastEntry> &entries,
+        uint32_t serverTick,
+        size_t maxPayload)
+    {
+        PacketChunks chunks;
+        AppendPositionBroadcastChunks(chunks, entries.data(), entries.size(),
+                                      serverTick, maxPayload);
+        return chunks;
+    }
+
+    /// Append one PositionBroadcastCompact packet (S→C) built from already
+    /// quantized entries to `buf`.
+    template <typename Buffer>
+    inline void AppendPositionBroadcastCompact(
+        Buffer &buf,
+        const NetQuantization::QuantizedEntry *entries,
+        size_t count,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant,
+        uint8_t chunkIndex = 0,
+        uint8_t chunkCount = 1)
+    {
+        MsgPositionBroadcastCompact hdr;
+        hdr.serverTick = serverTick;
+        hdr.entryCount = static_cast<uint16_t>(
+            std::min(count, static_cast<size_t>(UINT16_MAX)));
+        hdr.chunkIndex = chunkIndex;
+        hdr.chunkCount = chunkCount;
+        hdr.quant = quant;
+
+        const size_t start = buf.size();
+        buf.reserve(start + sizeof(hdr) +
+                    (hdr.entryCount * NetQuantization::EntryBits(quant) + 7) / 8);
+        buf.resize(start + sizeof(hdr));
+        std::memcpy(buf.data() + start, &hdr, sizeof(hdr));
+
+        NetQuantization::BitWriter<Buffer> writer(buf);
+        for (size_t i = 0; i < hdr.entryCount; ++i)
+            NetQuantization::WriteEntry(writer, entries[i], quant);
+        writer.Flush();
+    }
+
+    /// Build one PositionBroadcastCompact packet (S→C) from already
+    /// quantized entries.
+    inline std::vector<uint8_t> WritePositionBroadcastCompact(
+        const NetQuantization::QuantizedEntry *entries,
+        size_t count,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant,
+        uint8_t chunkIndex = 0,
+        uint8_t chunkCount = 1)
+    {
+        std::vector<uint8_t> buf;
+        AppendPositionBroadcastCompact(buf, entries, count, serverTick, quant,
+                                       chunkIndex, chunkCount);
+        return buf;
+    }
+
+    inline std::vector<uint8_t> WritePositionBroadcastCompact(
+        const std::vector<NetQuantization::QuantizedEntry> &entries,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant)
+    {
+        return WritePositionBroadcastCompact(entries.data(), entries.size(), serverTick, quant);
+    }
+
+    /// Build a PositionBroadcastCompact packet (S→C).
+    inline std::vector<uint8_t> WritePositionBroadcastCompact(
+        const std::vector<NetBroadcastEntry> &entries,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant)
+    {
+        std::vector<NetQuantization::QuantizedEntry> quantized;
+        quantized.reserve(entries.size());
+        for (const auto &e : entries)
+            quantized.push_back(NetQuantization::QuantizeEntry(e, quant));
+        return WritePositionBroadcastCompact(quantized, serverTick, quant);
+    }
+
+    /// Split a PositionBroadcastCompact into chunks of at most `maxPayload`
+    /// bytes (0 = single packet), appended to `out`. chunkCount is one
+    /// byte, so a tick needing more than 255 chunks is spread evenly over
+    /// 255 larger ones.
+    template <typename Chunks>
+    inline void AppendPositionBroadcastCompactChunks(
+        Chunks &out,
+        const NetQuantization::QuantizedEntry *entries,
+        size_t count,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant,
+        size_t maxPayload)
+    {
+        size_t perChunk = count;
+        if (maxPayload > sizeof(MsgPositionBroadcastCompact))
+            perChunk = (maxPayload - sizeof(MsgPositionBroadcastCompact)) * 8 /
+                       NetQuantization::EntryBits(quant);
+        perChunk = std::max<size_t>(perChunk, (count + UINT8_MAX - 1) / UINT8_MAX);
+        perChunk = std::min(std::max<size_t>(perChunk, 1), static_cast<size_t>(UINT16_MAX));
+        const size_t chunkCount = std::max<size_t>((count + perChunk - 1) / perChunk, 1);
+
+        for (size_t c = 0; c < chunkCount; ++c)
+        {
+            const size_t begin = c * perChunk;
+            const size_t end = std::min(count, begin + perChunk);
+            out.emplace_back();
+            AppendPositionBroadcastCompact(
+                out.back(), entries + begin, end - begin, serverTick, quant,
+                static_cast<uint8_t>(c), static_cast<uint8_t>(chunkCount));
+        }
+    }
+
+    inline PacketChunks WritePositionBroadcastCompactChunks(
+        const std::vector<NetQuantization::QuantizedEntry> &entries,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant,
+        size_t maxPayload)
+    {
+        PacketChunks chunks;
+        AppendPositionBroadcastCompactChunks(chunks, entries.data(), entries.size(),
+                                             serverTick, quant, maxPayload);
+        return chunks;
+    }
+
+    /// Append one PositionBroadcastDelta chunk (S→C) to `buf`, covering
+    /// `baseline` entries [baselineBegin, baselineBegin + baselineCount) and
+    /// the `current` entries in the same clientID range. `baseline` is the
+    /// full snapshot the client acked at `baselineTick`; both `baseline`
+    /// and `current` must be sorted by clientID.
+    template <typename Buffer>
+    inline void AppendPositionBroadcastDelta(
+        Buffer &buf,
+        const NetQuantization::QuantizedEntry *baseline,
+        size_t baselineBegin,
+        size_t baselineCount,
+        uint32_t baselineTick,
+        const NetQuantization::QuantizedEntry *current,
+        size_t currentCount,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant,
+        uint8_t chunkIndex = 0,
+        uint8_t chunkCount = 1)
+    {
+        using NetQuantization::QuantizedEntry;
+
+        MsgPositionBroadcastDelta hdr;
+        hdr.serverTick = serverTick;
+        hdr.baselineTick = baselineTick;
+        hdr.baselineBegin = static_cast<uint16_t>(baselineBegin);
+        hdr.baselineCount = static_cast<uint16_t>(
+            std::min(baselineCount, static_cast<size_t>(UINT16_MAX)));
+        hdr.chunkIndex = chunkIndex;
+        hdr.chunkCount = chunkCount;
+        hdr.quant = quant;
+
+        const QuantizedEntry *base = baseline + baselineBegin;
+
+        const size_t start = buf.size();
+        buf.resize(start + sizeof(hdr));
+        NetQuantization::BitWriter<Buffer> writer(buf);
+
+        auto sameEntity = [](const QuantizedEntry &a, const QuantizedEntry &b)
+        { return a.clientID == b.clientID && a.objectID == b.objectID; };
+
+        // Pass 1: walk the baseline, marking which entries are still present.
+        size_t j = 0;
+        for (size_t i = 0; i < hdr.baselineCount; ++i)
+        {
+            const QuantizedEntry &b = base[i];
+            while (j < currentCount && current[j].clientID < b.clientID)
+                ++j;
+
+            const bool present = j < currentCount && sameEntity(current[j], b);
+            writer.WriteBool(present);
+            if (!present)
+                continue;
+
+            const uint8_t mask = NetQuantization::DiffFields(b, current[j]);
+            writer.WriteBool(mask != 0);
+            if (mask != 0)
+            {
+                writer.Write(mask, 4);
+                NetQuantization::WriteFields(writer, current[j], mask, quant);
+            }
+        }
+
+        // Pass 2: entities the client has no baseline for go out in full.
+        size_t i = 0;
+        uint16_t newCount = 0;
+        for (size_t k = 0; k < currentCount && newCount < UINT16_MAX; ++k)
+        {
+            const QuantizedEntry &c = current[k];
+            while (i < hdr.baselineCount && base[i].clientID < c.clientID)
+                ++i;
+            if (i < hdr.baselineCount && sameEntity(base[i], c))
+                continue;
+            NetQuantization::WriteEntry(writer, c, quant);
+            ++newCount;
+        }
+        writer.Flush();
+
+        hdr.newCount = newCount;
+        std::memcpy(buf.data() + start, &hdr, sizeof(hdr));
+    }
+
+    /// Build one PositionBroadcastDelta chunk (S→C); see AppendPositionBroadcastDelta.
+    inline std::vector<uint8_t> WritePositionBroadcastDelta(
+        const NetQuantization::QuantizedEntry *baseline,
+        size_t baselineBegin,
+        size_t baselineCount,
+        uint32_t baselineTick,
+        const NetQuantization::QuantizedEntry *current,
+        size_t currentCount,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant,
+        uint8_t chunkIndex = 0,
+        uint8_t chunkCount = 1)
+    {
+        std::vector<uint8_t> buf;
+        AppendPositionBroadcastDelta(buf, baseline, baselineBegin, baselineCount, baselineTick,
+                                     current, currentCount, serverTick, quant,
+                                     chunkIndex, chunkCount);
         return buf;
     }
 
+    inline std::vector<uint8_t> WritePositionBroadcastDelta(
+        const std::vector<NetQuantization::QuantizedEntry> &baseline,
+        uint32_t baselineTick,
+        const std::vector<NetQuantization::QuantizedEntry> &current,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant)
+    {
+        return WritePositionBroadcastDelta(baseline.data(), 0, baseline.size(), baselineTick,
+                                           current.data(), current.size(), serverTick, quant);
+    }
+
+    /// Split a PositionBroadcastDelta into chunks of at most `maxPayload`
+    /// bytes (0 = single packet), appended to `out`. Chunks partition the
+    /// merged clientID order, so each one decodes on its own against the
+    /// acked baseline. As with the compact format, a tick needing more
+    /// than 255 chunks gets larger ones instead.
+    template <typename Chunks>
+    inline void AppendPositionBroadcastDeltaChunks(
+        Chunks &out,
+        const NetQuantization::QuantizedEntry *baseline,
+        size_t baselineCount,
+        uint32_t baselineTick,
+        const NetQuantization::QuantizedEntry *current,
+        size_t currentCount,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant,
+        size_t maxPayload)
+    {
+        size_t budgetBits = SIZE_MAX;
+        if (maxPayload > sizeof(MsgPositionBroadcastDelta))
+            budgetBits = (maxPayload - sizeof(MsgPositionBroadcastDelta)) * 8;
+        const uint32_t fullBits = NetQuantization::EntryBits(quant);
+
+        // Chunks are written as soon as their range closes; chunkCount is
+        // patched into every header once the total is known.
+        const size_t firstChunk = out.size();
+        size_t emitted = 0;
+        size_t baseBegin = 0, curBegin = 0;
+        auto emit = [&](size_t baseEnd, size_t curEnd)
+        {
+            out.emplace_back();
+            AppendPositionBroadcastDelta(
+                out.back(), baseline, baseBegin, baseEnd - baseBegin, baselineTick,
+                current + curBegin, curEnd - curBegin, serverTick, quant,
+                static_cast<uint8_t>(emitted), 0);
+            ++emitted;
+            baseBegin = baseEnd;
+            curBegin = curEnd;
+        };
+
+        // Encoded cost of the next step of the merged walk.
+        auto step = [&](size_t &i, size_t &j) -> size_t
+        {
+            if (j >= currentCount ||
+                (i < baselineCount && baseline[i].clientID < current[j].clientID))
+            {
+                ++i;
+                return 1; // gone from this client's view
+            }
+            if (i >= baselineCount || current[j].clientID < baseline[i].clientID)
+            {
+                ++j;
+                return fullBits; // new to this client
+            }
+            size_t cost = 1 + fullBits; // object swapped: drop + full
+            if (baseline[i].objectID == current[j].objectID)
+            {
+                const uint8_t mask = NetQuantization::DiffFields(baseline[i], current[j]);
+                cost = 2 + (mask ? 4 + NetQuantization::FieldBits(mask, quant) : 0);
+            }
+            ++i;
+            ++j;
+            return cost;
+        };
+
+        // A closed chunk holds more than budgetBits minus one step, at most
+        // 1 + fullBits. If the walk could need more than 254 of those,
+        // measure it and widen the budget so chunkCount fits in a byte.
+        const size_t maxStep = 1 + size_t{fullBits};
+        const size_t maxChunks = UINT8_MAX - 1;
+        if (budgetBits != SIZE_MAX &&
+            (budgetBits <= maxStep ||
+             (baselineCount + currentCount) * maxStep > maxChunks * (budgetBits - maxStep)))
+        {
+            size_t totalBits = 0;
+            for (size_t i = 0, j = 0; i < baselineCount || j < currentCount;)
+                totalBits += step(i, j);
+            budgetBits = std::max(budgetBits, totalBits / maxChunks + maxStep + 1);
+        }
+
+        // Greedily pack the merged walk by exact encoded cost.
+        size_t rangeBits = 0;
+        size_t i = 0, j = 0;
+        while (i < baselineCount || j < currentCount)
+        {
+            size_t nextI = i, nextJ = j;
+            const size_t cost = step(nextI, nextJ);
+            if (rangeBits > 0 && rangeBits + cost > budgetBits)
+            {
+                emit(i, j);
+                rangeBits = 0;
+            }
+            rangeBits += cost;
+            i = nextI;
+            j = nextJ;
+        }
+        emit(i, j);
+
+        for (size_t c = 0; c < emitted; ++c)
+        {
+            auto &pkt = out[firstChunk + c];
+            MsgPositionBroadcastDelta hdr;
+            std::memcpy(&hdr, pkt.data(), sizeof(hdr));
+            hdr.chunkCount = static_cast<uint8_t>(emitted);
+            std::memcpy(pkt.data(), &hdr, sizeof(hdr));
+        }
+    }
+
+    inline PacketChunks WritePositionBroadcastDeltaChunks(
+        const std::vector<NetQuantization::QuantizedEntry> &baseline,
+        uint32_t baselineTick,
+        const std::vector<NetQuantization::QuantizedEntry> &current,
+        uint32_t serverTick,
+        const NetQuantizationParams &quant,
+        size_t maxPayload)
+    {
+        PacketChunks chunks;
+        AppendPositionBroadcastDeltaChunks(chunks, baseline.data(), baseline.size(), baselineTick,
+                                           current.data(), current.size(), serverTick, quant,
+                                           maxPayload);
+        return chunks;
+    }
+
     inline std::vector<uint8_t> WriteClientDisconnect(ClientID cid)
     {
         MsgClientDisconnect msg;
@@ -92,6 +637,24 @@ namespace PacketSerializer
         return buf;
     }
 
+    inline std::vector<uint8_t> WriteSnapshotAck(uint32_t serverTick)
+    {
+        MsgSnapshotAck msg;
+        msg.serverTick = serverTick;
+        std::vector<uint8_t> buf(sizeof(msg));
+        std::memcpy(buf.data(), &msg, sizeof(msg));
+        return buf;
+    }
+
+    inline std::vector<uint8_t> WriteSnapshotRate(uint16_t snapshotsPerSecond)
+    {
+        MsgSnapshotRate msg;
+        msg.snapshotsPerSecond = snapshotsPerSecond;
+        std::vector<uint8_t> buf(sizeof(msg));
+        std::memcpy(buf.data(), &msg, sizeof(msg));
+        return buf;
+    }
+
     inline std::vector<uint8_t> WriteObjectDespawn(ClientID ownerClientID, NetObjectID objectID)
     {
         MsgObjectDespawn msg;
@@ -102,6 +665,23 @@ namespace PacketSerializer
         return buf;
     }
 
+    inline std::vector<uint8_t> WriteRoomJoin(RoomID roomID)
+    {
+        MsgRoomJoin msg;
+        msg.roomID = roomID;
+        std::vector<uint8_t> buf(sizeof(msg));
+        std::memcpy(buf.data(), &msg, sizeof(msg));
+        return buf;
+    }
+
+    inline std::vector<uint8_t> WriteRoomLeave()
+    {
+        MsgRoomLeave msg;
+        std::vector<uint8_t> buf(sizeof(msg));
+        std::memcpy(buf.data(), &msg, sizeof(msg));
+        return buf;
+    }
+
     // ────────────────────── Readers ──────────────────────
 
     /// Peek at the message type (first byte).
@@ -144,6 +724,34 @@ namespace PacketSerializer
         return out;
     }
 
+    struct PositionRelayData
+    {
+        bool ok = false;
+        uint32_t serverTick = 0;
+        uint16_t relaySeq = 0;
+        std::vector<NetBroadcastEntry> entries;
+    };
+
+    /// `ok` is false when the packet is shorter than its entry count says.
+    inline PositionRelayData ReadPositionRelay(const uint8_t *data, size_t len)
+    {
+        PositionRelayData out{};
+        if (len < sizeof(MsgPositionRelay))
+            return out;
+        auto hdr = Read<MsgPositionRelay>(data, len);
+        const size_t offset = sizeof(MsgPositionRelay);
+        if (size_t{hdr.entryCount} * sizeof(NetBroadcastEntry) > len - offset)
+            return out;
+        out.serverTick = hdr.serverTick;
+        out.relaySeq = hdr.relaySeq;
+        out.entries.resize(hdr.entryCount);
+        if (hdr.entryCount > 0)
+            std::memcpy(out.entries.data(), data + offset,
+                        hdr.entryCount * sizeof(NetBroadcastEntry));
+        out.ok = true;
+        return out;
+    }
+
     /// Read the variable-length broadcast entries that follow MsgPositionBroadcast.
     inline std::vector<NetBroadcastEntry> ReadBroadcastEntries(
         const uint8_t *data, size_t len)
@@ -151,6 +759,192 @@ namespace PacketSerializer
         return ReadPositionBroadcast(data, len).entries;
     }
 
+    /// Decoded compact / delta broadcast in quantized form. Clients keep these
+    /// (sorted by clientID) as baselines for later PositionBroadcastDelta.
+    /// A chunked tick is complete once `chunkCount` distinct chunks have
+    /// been merged; only then should the client store it and send SnapshotAck.
+    struct QuantizedBroadcastData
+    {
+        bool ok = false;
+        uint32_t serverTick = 0;
+        uint8_t chunkIndex = 0;
+        uint8_t chunkCount = 1;
+        NetQuantizationParams quant{};
+        std::vector<NetQuantization::QuantizedEntry> entries;
+    };
+
+    inline QuantizedBroadcastData ReadPositionBroadcastCompactQuantized(
+        const uint8_t *data, size_t len)
+    {
+        QuantizedBroadcastData out{};
+        if (len < sizeof(MsgPositionBroadcastCompact))
+            return out;
+        auto hdr = Read<MsgPositionBroadcastCompact>(data, len);
+        out.serverTick = hdr.serverTick;
+        out.chunkIndex = hdr.chunkIndex;
+        out.chunkCount = hdr.chunkCount;
+        out.quant = hdr.quant;
+        if (!NetQuantization::IsValid(hdr.quant))
+            return out;
+
+        const size_t offset = sizeof(MsgPositionBroadcastCompact);
+        if (offset > len)
+            return out;
+        NetQuantization::BitReader reader(data + offset, len - offset);
+        out.entries.reserve(hdr.entryCount);
+        for (uint16_t i = 0; i < hdr.entryCount; ++i)
+        {
+            auto q = NetQuantization::ReadEntry(reader, hdr.quant);
+            if (reader.Overflowed())
+                return out;
+            out.entries.push_back(q);
+        }
+        std::sort(out.entries.begin(), out.entries.end(),
+                  [](const auto &a, const auto &b)
+                  { return a.clientID < b.clientID; });
+        out.ok = true;
+        return out;
+    }
+
+    /// Decode a PositionBroadcastDelta chunk against the complete snapshot
+    /// stored for its baselineTick (see MsgPositionBroadcastDelta). The
+    /// result holds this chunk's entries only. `ok` is false when the
+    /// baseline does not match or the packet is truncated.
+    inline QuantizedBroadcastData ReadPositionBroadcastDelta(
+        const uint8_t *data, size_t len,
+        const QuantizedBroadcastData &baseline)
+    {
+        QuantizedBroadcastData out{};
+        if (len < sizeof(MsgPositionBroadcastDelta))
+            return out;
+        auto hdr = Read<MsgPositionBroadcastDelta>(data, len);
+        out.serverTick = hdr.serverTick;
+        out.chunkIndex = hdr.chunkIndex;
+        out.chunkCount = hdr.chunkCount;
+        out.quant = hdr.quant;
+        if (!NetQuantization::IsValid(hdr.quant) ||
+            !NetQuantization::SameParams(hdr.quant, baseline.quant) ||
+            baseline.serverTick != hdr.baselineTick ||
+            static_cast<size_t>(hdr.baselineBegin) + hdr.baselineCount > baseline.entries.size())
+        {
+            return out;
+        }
+
+        const size_t offset = sizeof(MsgPositionBroadcastDelta);
+        if (offset > len)
+            return out;
+        NetQuantization::BitReader reader(data + offset, len - offset);
+        out.entries.reserve(hdr.baselineCount + hdr.newCount);
+        for (uint16_t i = 0; i < hdr.baselineCount; ++i)
+        {
+            if (!reader.ReadBool())
+                continue;
+            NetQuantization::QuantizedEntry q = baseline.entries[hdr.baselineBegin + i];
+            if (reader.ReadBool())
+            {
+                const uint8_t mask = static_cast<uint8_t>(reader.Read(4));
+                NetQuantization::ReadFields(reader, q, mask, hdr.quant);
+            }
+            out.entries.push_back(q);
+        }
+        for (uint16_t i = 0; i < hdr.newCount; ++i)
+            out.entries.push_back(NetQuantization::ReadEntry(reader, hdr.quant));
+        if (reader.Overflowed())
+            return out;
+
+        std::sort(out.entries.begin(), out.entries.end(),
+                  [](const auto &a, const auto &b)
+                  { return a.clientID < b.clientID; });
+        out.ok = true;
+        return out;
+    }
+
+    inline PositionBroadcastData Dequantize(const QuantizedBroadcastData &in)
+    {
+        PositionBroadcastData out{};
+        out.serverTick = in.serverTick;
+        out.entries.reserve(in.entries.size());
+        for (const auto &q : in.entries)
+            out.entries.push_back(NetQuantization::DequantizeEntry(q, in.quant));
+        return out;
+    }
+
+    /// Read a PositionBroadcastCompact packet. Entries come back dequantized
+    /// and sorted by clientID; a malformed packet yields no entries.
+    inline PositionBroadcastData ReadPositionBroadcastCompact(
+        const uint8_t *data, size_t len)
+    {
+        return Dequantize(ReadPositionBroadcastCompactQuantized(data, len));
+    }
+
+    // ────────────────────── Message bundles ──────────────────────
+
+    /// Append one complete message to the MessageBundle being built in
+    /// `bundle` (an empty vector starts a new bundle).
+    /// Returns false if the message cannot be framed.
+    inline bool AppendToBundle(std::vector<uint8_t> &bundle,
+                               const uint8_t *data, size_t len)
+    {
+        if (len < sizeof(NetPacketHeader) || len > UINT16_MAX)
+            return false;
+
+        MsgMessageBundle hdr;
+        if (bundle.empty())
+        {
+            bundle.resize(sizeof(hdr));
+        }
+        else
+        {
+            std::memcpy(&hdr, bundle.data(), sizeof(hdr));
+            if (hdr.messageCount == UINT16_MAX)
+                return false;
+        }
+        ++hdr.messageCount;
+        std::memcpy(bundle.data(), &hdr, sizeof(hdr));
+
+        const uint16_t len16 = static_cast<uint16_t>(len);
+        const size_t offset = bundle.size();
+        bundle.resize(offset + sizeof(len16) + len);
+        std::memcpy(bundle.data() + offset, &len16, sizeof(len16));
+        std::memcpy(bundle.data() + offset + sizeof(len16), data, len);
+        return true;
+    }
+
+    /// Bytes AppendToBundle would add for a `len`-byte message.
+    inline size_t BundledSize(size_t len)
+    {
+        return sizeof(uint16_t) + len;
+    }
+
+    /// Call `fn(data, len)` for every message in a MessageBundle, in order.
+    /// Stops and returns false at the first malformed or nested entry.
+    template <typename Fn>
+    inline bool ForEachBundledMessage(const uint8_t *data, size_t len, Fn &&fn)
+    {
+        if (len < sizeof(MsgMessageBundle))
+            return false;
+        auto hdr = Read<MsgMessageBundle>(data, len);
+
+        size_t offset = sizeof(MsgMessageBundle);
+        for (uint16_t i = 0; i < hdr.messageCount; ++i)
+        {
+            if (offset + sizeof(uint16_t) > len)
+                return false;
+            uint16_t msgLen = 0;
+            std::memcpy(&msgLen, data + offset, sizeof(msgLen));
+            offset += sizeof(msgLen);
+
+            if (msgLen < sizeof(NetPacketHeader) || offset + msgLen > len)
+                return false;
+            if (PeekType(data + offset, msgLen) == NetMessageType::MessageBundle)
+                return false;
+
+            fn(data + offset, static_cast<size_t>(msgLen));
+            offset += msgLen;
+        }
+        return true;
+    }
+
     // ────────────────────── Chat Writers ──────────────────────
 
     /// Build a ChatRequest packet (C→S).
@@ -179,30 +973,9 @@ namespace PacketSerializer
                                                    const std::string &senderName,
                                                    const std::string &text)
     {
-        uint8_t nameLen = static_cast<uint8_t>(
-            std::min(senderName.size(), static_cast<size_t>(255)));
-        uint16_t textLen = static_cast<uint16_t>(
-            std::min(text.size(), static_cast<size_t>(512)));
-        size_t totalSize = sizeof(MsgChatBroadcast) + nameLen + sizeof(uint16_t) + textLen;
-        std::vector<uint8_t> buf(totalSize);
-
-        MsgChatBroadcast hdr;
-        hdr.chatType = chatType;
-        hdr.senderClientID = senderID;
-        hdr.senderNameLength = nameLen;
-        std::memcpy(buf.data(), &hdr, sizeof(hdr));
-
-        size_t offset = sizeof(hdr);
-        if (nameLen > 0)
-        {
-            std::memcpy(buf.data() + offset, senderName.data(), nameLen);
-            offset += nameLen;
-        }
-        uint16_t textLenNet = textLen;
-        std::memcpy(buf.data() + offset, &textLenNet, sizeof(textLenNet));
-        offset += sizeof(textLenNet);
-        if (textLen > 0)
-            std::memcpy(buf.data() + offset, text.data(), textLen);
+        std::vector<uint8_t> buf(kMaxPacketSize<MsgChatBroadcast>);
+        buf.resize(WriteChatBroadcastTo(buf.data(), buf.size(),
+                                        chatType, senderID, senderName, text));
         return buf;
     }
 
@@ -282,18 +1055,8 @@ namespace PacketSerializer
     inline std::vector<uint8_t> WriteNicknameUpdateResult(
         NicknameUpdateStatus status, const std::string &nickname)
     {
-        uint8_t len8 = static_cast<uint8_t>(
-            std::min(nickname.size(), static_cast<size_t>(255)));
-
-        size_t totalSize = sizeof(MsgNicknameUpdateResult) + len8;
-        std::vector<uint8_t> buf(totalSize);
-
-        MsgNicknameUpdateResult hdr;
-        hdr.status = status;
-        hdr.nicknameLength = len8;
-        std::memcpy(buf.data(), &hdr, sizeof(hdr));
-        if (len8 > 0)
-            std::memcpy(buf.data() + sizeof(hdr), nickname.data(), len8);
+        std::vector<uint8_t> buf(kMaxPacketSize<MsgNicknameUpdateResult>);
+        buf.resize(WriteNicknameUpdateResultTo(buf.data(), buf.size(), status, nickname));
         return buf;
     }
 
@@ -303,12 +1066,15 @@ namespace PacketSerializer
         std::string nickname;
     };
 
-    inline std::vector<uint8_t> WritePlayerMetaSnapshot(
-        const std::vector<PlayerMetaEntryData> &entries)
+    /// Append a PlayerMetaSnapshot to `buf`. `entries` is any indexable
+    /// container whose elements have `clientID` and a string-like `nickname`
+    /// (e.g. PlayerMetaEntryData, or a std::string_view based view).
+    template <typename Buffer, typename Entries>
+    inline void AppendPlayerMetaSnapshot(Buffer &buf, const Entries &entries)
     {
         MsgPlayerMetaSnapshot hdr;
         hdr.entryCount = static_cast<uint16_t>(
-            std::min(entries.size(), static_cast<size_t>(UINT16_MAX)));
+            std::min(static_cast<size_t>(entries.size()), static_cast<size_t>(UINT16_MAX)));
 
         size_t totalSize = sizeof(MsgPlayerMetaSnapshot);
         for (size_t i = 0; i < hdr.entryCount; ++i)
@@ -319,10 +1085,11 @@ namespace PacketSerializer
             totalSize += sizeof(MsgPlayerMetaEntry) + len8;
         }
 
-        std::vector<uint8_t> buf(totalSize);
-        std::memcpy(buf.data(), &hdr, sizeof(hdr));
+        const size_t start = buf.size();
+        buf.resize(start + totalSize);
+        std::memcpy(buf.data() + start, &hdr, sizeof(hdr));
 
-        size_t offset = sizeof(MsgPlayerMetaSnapshot);
+        size_t offset = start + sizeof(MsgPlayerMetaSnapshot);
         for (size_t i = 0; i < hdr.entryCount; ++i)
         {
             const auto &entry = entries[i];
@@ -340,23 +1107,21 @@ namespace PacketSerializer
                 offset += ehdr.nicknameLength;
             }
         }
+    }
+
+    inline std::vector<uint8_t> WritePlayerMetaSnapshot(
+        const std::vector<PlayerMetaEntryData> &entries)
+    {
+        std::vector<uint8_t> buf;
+        AppendPlayerMetaSnapshot(buf, entries);
         return buf;
     }
 
     inline std::vector<uint8_t> WritePlayerMetaUpsert(ClientID clientID,
                                                        const std::string &nickname)
     {
-        const uint8_t len8 = static_cast<uint8_t>(
-            std::min(nickname.size(), static_cast<size_t>(255)));
-        const size_t totalSize = sizeof(MsgPlayerMetaUpsert) + len8;
-        std::vector<uint8_t> buf(totalSize);
-
-        MsgPlayerMetaUpsert hdr;
-        hdr.clientID = clientID;
-        hdr.nicknameLength = len8;
-        std::memcpy(buf.data(), &hdr, sizeof(hdr));
-        if (len8 > 0)
-            std::memcpy(buf.data() + sizeof(hdr), nickname.data(), len8);
+        std::vector<uint8_t> buf(kMaxPacketSize<MsgPlayerMetaUpsert>);
+        buf.resize(WritePlayerMetaUpsertTo(buf.data(), buf.size(), clientID, nickname));
         return buf;
     }
 
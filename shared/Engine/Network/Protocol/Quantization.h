@@ -0,0 +1,382 @@
+#pragma once
+#include "Engine/Network/Protocol/Messages.h"
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+/// Bit packing and fixed-point helpers for the compact broadcast formats.
+/// Header-only and shared with the client, like PacketSerializer.
+namespace NetQuantization
+{
+
+    // ────────────────────── Bit streams ──────────────────────
+
+    /// Appends little-endian bit fields to a byte buffer. Any vector-like
+    /// container of bytes works (e.g. an arena-backed std::pmr::vector).
+    template <typename Buffer = std::vector<uint8_t>>
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(Buffer &out) : m_out(out) {}
+
+        /// Write the low `bits` bits of `value` (bits <= 32).
+        void Write(uint32_t value, uint8_t bits)
+        {
+            const uint64_t mask = (bits >= 32) ? 0xFFFFFFFFull : ((1ull << bits) - 1);
+            m_scratch |= (static_cast<uint64_t>(value) & mask) << m_scratchBits;
+            m_scratchBits += bits;
+            while (m_scratchBits >= 8)
+            {
+                m_out.push_back(static_cast<uint8_t>(m_scratch));
+                m_scratch >>= 8;
+                m_scratchBits -= 8;
+            }
+        }
+
+        void WriteBool(bool value) { Write(value ? 1u : 0u, 1); }
+
+        /// Pad the last partial byte with zeros.
+        void Flush()
+        {
+            if (m_scratchBits > 0)
+            {
+                m_out.push_back(static_cast<uint8_t>(m_scratch));
+                m_scratch = 0;
+                m_scratchBits = 0;
+            }
+        }
+
+    private:
+        Buffer &m_out;
+        uint64_t m_scratch = 0;
+        uint32_t m_scratchBits = 0;
+    };
+
+    /// Reads fields written by BitWriter. Reading past the end yields zeros
+    /// and sets Overflowed().
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t *data, size_t len) : m_data(data), m_len(len) {}
+
+        uint32_t Read(uint8_t bits)
+        {
+            while (m_scratchBits < bits)
+            {
+                uint64_t byte = 0;
+                if (m_offset < m_len)
+                    byte = m_data[m_offset];
+                else
+                    m_overflowed = true;
+                ++m_offset;
+                m_scratch |= byte << m_scratchBits;
+                m_scratchBits += 8;
+            }
+            const uint64_t mask = (bits >= 32) ? 0xFFFFFFFFull : ((1ull << bits) - 1);
+            const uint32_t value = static_cast<uint32_t>(m_scratch & mask);
+            m_scratch >>= bits;
+            m_scratchBits -= bits;
+            return value;
+        }
+
+        bool ReadBool() { return Read(1) != 0; }
+        bool Overflowed() const { return m_overflowed; }
+
+    private:
+        const uint8_t *m_data = nullptr;
+        size_t m_len = 0;
+        size_t m_offset = 0;
+        uint64_t m_scratch = 0;
+        uint32_t m_scratchBits = 0;
+        bool m_overflowed = false;
+    };
+
+    // ────────────────────── Scalars ──────────────────────
+
+    /// Number of bits needed to cover [-bound, bound] at `precision` steps.
+    inline uint8_t BitsForRange(float bound, float precision)
+    {
+        if (bound <= 0.0f || precision <= 0.0f)
+            return 32;
+        const double steps = 2.0 * static_cast<double>(bound) / precision + 1.0;
+        const int bits = static_cast<int>(std::ceil(std::log2(steps)));
+        return static_cast<uint8_t>(std::clamp(bits, 1, 32));
+    }
+
+    /// Map `v` in [-bound, bound] to an unsigned `bits`-wide integer.
+    inline uint32_t QuantizeFloat(float v, float bound, uint8_t bits)
+    {
+        const uint64_t maxValue = (bits >= 32) ? 0xFFFFFFFFull : ((1ull << bits) - 1);
+        if (!(v == v)) // NaN
+            v = 0.0f;
+        const double clamped = std::clamp(static_cast<double>(v), -static_cast<double>(bound),
+                                          static_cast<double>(bound));
+        const double normalized = (clamped + bound) / (2.0 * bound);
+        return static_cast<uint32_t>(std::llround(normalized * static_cast<double>(maxValue)));
+    }
+
+    inline float DequantizeFloat(uint32_t q, float bound, uint8_t bits)
+    {
+        const uint64_t maxValue = (bits >= 32) ? 0xFFFFFFFFull : ((1ull << bits) - 1);
+        const double normalized = static_cast<double>(q) / static_cast<double>(maxValue);
+        return static_cast<float>(normalized * 2.0 * bound - bound);
+    }
+
+    // ────────────────────── Entries ──────────────────────
+
+    /// Smallest-three components of a unit quaternion lie in this range.
+    constexpr float kSmallestThreeBound = 0.70710678f;
+
+    /// One broadcast entry in quantized integer form. Comparing two of these
+    /// tells whether a client would observe any change on the wire.
+    struct QuantizedEntry
+    {
+        ClientID clientID = INVALID_CLIENT_ID;
+        NetObjectID objectID = INVALID_NET_OBJECT_ID;
+        uint32_t pos[3] = {};
+        uint8_t rotLargest = 0; // index (w,x,y,z) of the dropped component
+        uint32_t rot[3] = {};
+        uint32_t linVel[3] = {};
+        uint32_t angVel[3] = {};
+
+        bool operator==(const QuantizedEntry &o) const
+        {
+            return clientID == o.clientID && objectID == o.objectID &&
+                   std::memcmp(pos, o.pos, sizeof(pos)) == 0 &&
+                   rotLargest == o.rotLargest &&
+                   std::memcmp(rot, o.rot, sizeof(rot)) == 0 &&
+                   std::memcmp(linVel, o.linVel, sizeof(linVel)) == 0 &&
+                   std::memcmp(angVel, o.angVel, sizeof(angVel)) == 0;
+        }
+        bool operator!=(const QuantizedEntry &o) const { return !(*this == o); }
+    };
+
+    inline QuantizedEntry QuantizeEntry(const NetBroadcastEntry &e,
+                                        const NetQuantizationParams &qp)
+    {
+        QuantizedEntry q;
+        q.clientID = e.clientID;
+        q.objectID = e.objectID;
+
+        const NetTransformState &t = e.transform;
+        q.pos[0] = QuantizeFloat(t.posX, qp.worldBound, qp.positionBits);
+        q.pos[1] = QuantizeFloat(t.posY, qp.worldBound, qp.positionBits);
+        q.pos[2] = QuantizeFloat(t.posZ, qp.worldBound, qp.positionBits);
+
+        // Smallest three: drop the largest component (sign-folded to be
+        // positive, since q and -q are the same rotation) and send the rest.
+        float comp[4] = {t.rotW, t.rotX, t.rotY, t.rotZ};
+        const float norm = std::sqrt(comp[0] * comp[0] + comp[1] * comp[1] +
+                                     comp[2] * comp[2] + comp[3] * comp[3]);
+        if (norm > 0.0f)
+        {
+            for (float &c : comp)
+                c /= norm;
+        }
+        else
+        {
+            comp[0] = 1.0f;
+        }
+        uint8_t largest = 0;
+        for (uint8_t i = 1; i < 4; ++i)
+        {
+            if (std::fabs(comp[i]) > std::fabs(comp[largest]))
+                largest = i;
+        }
+        const float sign = comp[largest] < 0.0f ? -1.0f : 1.0f;
+        q.rotLargest = largest;
+        for (uint8_t i = 0, j = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+            q.rot[j++] = QuantizeFloat(comp[i] * sign, kSmallestThreeBound, qp.rotationBits);
+        }
+
+        q.linVel[0] = QuantizeFloat(t.linVelX, qp.maxLinearSpeed, qp.velocityBits);
+        q.linVel[1] = QuantizeFloat(t.linVelY, qp.maxLinearSpeed, qp.velocityBits);
+        q.linVel[2] = QuantizeFloat(t.linVelZ, qp.maxLinearSpeed, qp.velocityBits);
+        q.angVel[0] = QuantizeFloat(t.angVelX, qp.maxAngularSpeed, qp.velocityBits);
+        q.angVel[1] = QuantizeFloat(t.angVelY, qp.maxAngularSpeed, qp.velocityBits);
+        q.angVel[2] = QuantizeFloat(t.angVelZ, qp.maxAngularSpeed, qp.velocityBits);
+        return q;
+    }
+
+    inline NetBroadcastEntry DequantizeEntry(const QuantizedEntry &q,
+                                             const NetQuantizationParams &qp)
+    {
+        NetBroadcastEntry e;
+        e.clientID = q.clientID;
+        e.objectID = q.objectID;
+
+        NetTransformState &t = e.transform;
+        t.posX = DequantizeFloat(q.pos[0], qp.worldBound, qp.positionBits);
+        t.posY = DequantizeFloat(q.pos[1], qp.worldBound, qp.positionBits);
+        t.posZ = DequantizeFloat(q.pos[2], qp.worldBound, qp.positionBits);
+
+        float comp[4] = {};
+        float sumSq = 0.0f;
+        const uint8_t largest = static_cast<uint8_t>(q.rotLargest & 3);
+        for (uint8_t i = 0, j = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+            comp[i] = DequantizeFloat(q.rot[j++], kSmallestThreeBound, qp.rotationBits);
+            sumSq += comp[i] * comp[i];
+        }
+        comp[largest] = std::sqrt(std::max(0.0f, 1.0f - sumSq));
+        t.rotW = comp[0];
+        t.rotX = comp[1];
+        t.rotY = comp[2];
+        t.rotZ = comp[3];
+
+        t.linVelX = DequantizeFloat(q.linVel[0], qp.maxLinearSpeed, qp.velocityBits);
+        t.linVelY = DequantizeFloat(q.linVel[1], qp.maxLinearSpeed, qp.velocityBits);
+        t.linVelZ = DequantizeFloat(q.linVel[2], qp.maxLinearSpeed, qp.velocityBits);
+        t.angVelX = DequantizeFloat(q.angVel[0], qp.maxAngularSpeed, qp.velocityBits);
+        t.angVelY = DequantizeFloat(q.angVel[1], qp.maxAngularSpeed, qp.velocityBits);
+        t.angVelZ = DequantizeFloat(q.angVel[2], qp.maxAngularSpeed, qp.velocityBits);
+        return e;
+    }
+
+    /// Size in bits of one fully encoded entry.
+    inline uint32_t EntryBits(const NetQuantizationParams &qp)
+    {
+        return 32u + 32u +                  // clientID, objectID
+               3u * qp.positionBits +       // position
+               2u + 3u * qp.rotationBits +  // smallest-three rotation
+               6u * qp.velocityBits;        // linear + angular velocity
+    }
+
+    template <typename Buffer>
+    inline void WriteEntry(BitWriter<Buffer> &w, const QuantizedEntry &q,
+                           const NetQuantizationParams &qp)
+    {
+        w.Write(q.clientID, 32);
+        w.Write(q.objectID, 32);
+        for (uint32_t v : q.pos)
+            w.Write(v, qp.positionBits);
+        w.Write(q.rotLargest, 2);
+        for (uint32_t v : q.rot)
+            w.Write(v, qp.rotationBits);
+        for (uint32_t v : q.linVel)
+            w.Write(v, qp.velocityBits);
+        for (uint32_t v : q.angVel)
+            w.Write(v, qp.velocityBits);
+    }
+
+    inline QuantizedEntry ReadEntry(BitReader &r, const NetQuantizationParams &qp)
+    {
+        QuantizedEntry q;
+        q.clientID = r.Read(32);
+        q.objectID = r.Read(32);
+        for (uint32_t &v : q.pos)
+            v = r.Read(qp.positionBits);
+        q.rotLargest = static_cast<uint8_t>(r.Read(2));
+        for (uint32_t &v : q.rot)
+            v = r.Read(qp.rotationBits);
+        for (uint32_t &v : q.linVel)
+            v = r.Read(qp.velocityBits);
+        for (uint32_t &v : q.angVel)
+            v = r.Read(qp.velocityBits);
+        return q;
+    }
+
+    /// Field groups used by the delta format's per-entry change mask.
+    enum FieldMask : uint8_t
+    {
+        FieldPosition = 1 << 0,
+        FieldRotation = 1 << 1,
+        FieldLinearVelocity = 1 << 2,
+        FieldAngularVelocity = 1 << 3,
+    };
+
+    inline uint8_t DiffFields(const QuantizedEntry &a, const QuantizedEntry &b)
+    {
+        uint8_t mask = 0;
+        if (std::memcmp(a.pos, b.pos, sizeof(a.pos)) != 0)
+            mask |= FieldPosition;
+        if (a.rotLargest != b.rotLargest || std::memcmp(a.rot, b.rot, sizeof(a.rot)) != 0)
+            mask |= FieldRotation;
+        if (std::memcmp(a.linVel, b.linVel, sizeof(a.linVel)) != 0)
+            mask |= FieldLinearVelocity;
+        if (std::memcmp(a.angVel, b.angVel, sizeof(a.angVel)) != 0)
+            mask |= FieldAngularVelocity;
+        return mask;
+    }
+
+    /// Size in bits of the field groups selected by `mask`.
+    inline uint32_t FieldBits(uint8_t mask, const NetQuantizationParams &qp)
+    {
+        uint32_t bits = 0;
+        if (mask & FieldPosition)
+            bits += 3u * qp.positionBits;
+        if (mask & FieldRotation)
+            bits += 2u + 3u * qp.rotationBits;
+        if (mask & FieldLinearVelocity)
+            bits += 3u * qp.velocityBits;
+        if (mask & FieldAngularVelocity)
+            bits += 3u * qp.velocityBits;
+        return bits;
+    }
+
+    /// Write only the field groups selected by `mask`.
+    template <typename Buffer>
+    inline void WriteFields(BitWriter<Buffer> &w, const QuantizedEntry &q, uint8_t mask,
+                            const NetQuantizationParams &qp)
+    {
+        if (mask & FieldPosition)
+            for (uint32_t v : q.pos)
+                w.Write(v, qp.positionBits);
+        if (mask & FieldRotation)
+        {
+            w.Write(q.rotLargest, 2);
+            for (uint32_t v : q.rot)
+                w.Write(v, qp.rotationBits);
+        }
+        if (mask & FieldLinearVelocity)
+            for (uint32_t v : q.linVel)
+                w.Write(v, qp.velocityBits);
+        if (mask & FieldAngularVelocity)
+            for (uint32_t v : q.angVel)
+                w.Write(v, qp.velocityBits);
+    }
+
+    /// Overwrite the field groups selected by `mask` in `q`.
+    inline void ReadFields(BitReader &r, QuantizedEntry &q, uint8_t mask,
+                           const NetQuantizationParams &qp)
+    {
+        if (mask & FieldPosition)
+            for (uint32_t &v : q.pos)
+                v = r.Read(qp.positionBits);
+        if (mask & FieldRotation)
+        {
+            q.rotLargest = static_cast<uint8_t>(r.Read(2));
+            for (uint32_t &v : q.rot)
+                v = r.Read(qp.rotationBits);
+        }
+        if (mask & FieldLinearVelocity)
+            for (uint32_t &v : q.linVel)
+                v = r.Read(qp.velocityBits);
+        if (mask & FieldAngularVelocity)
+            for (uint32_t &v : q.angVel)
+                v = r.Read(qp.velocityBits);
+    }
+
+    /// Reject headers whose bit widths would make the reader misbehave.
+    inline bool IsValid(const NetQuantizationParams &qp)
+    {
+        return qp.positionBits >= 1 && qp.positionBits <= 32 &&
+               qp.rotationBits >= 1 && qp.rotationBits <= 32 &&
+               qp.velocityBits >= 1 && qp.velocityBits <= 32 &&
+               qp.worldBound > 0.0f && qp.maxLinearSpeed > 0.0f &&
+               qp.maxAngularSpeed > 0.0f;
+    }
+
+    inline bool SameParams(const NetQuantizationParams &a, const NetQuantizationParams &b)
+    {
+        return std::memcmp(&a, &b, sizeof(NetQuantizationParams)) == 0;
+    }
+
+} // namespace NetQuantization
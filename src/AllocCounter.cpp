@@ -0,0 +1,49 @@
+// ────────────────────────────────────────────────────────────────────
+// Global heap allocation counter (debug builds with NW_COUNT_ALLOCATIONS)
+// ────────────────────────────────────────────────────────────────────
+
+#include "AllocCounter.h"
+
+#if defined(NW_COUNT_ALLOCATIONS)
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<uint64_t> g_allocations{0};
+}
+
+// The array and nothrow forms forward to these by default.
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+uint64_t AllocCounter::Count()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+uint64_t AllocCounter::Count()
+{
+    return 0;
+}
+
+#endif
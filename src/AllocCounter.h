@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+
+/// Debug counter of global operator new calls, used to check that steady
+/// state ticks do not touch the heap. Only active when the server is built
+/// with NW_COUNT_ALLOCATIONS (CMake option of the same name); otherwise
+/// Count() is always 0. Allocations made by nbnet itself (C malloc) are
+/// not counted.
+namespace AllocCounter
+{
+    constexpr bool Enabled =
+#if defined(NW_COUNT_ALLOCATIONS)
+        true;
+#else
+        false;
+#endif
+
+    /// Total operator new calls since process start.
+    uint64_t Count();
+}
@@ -0,0 +1,159 @@
+// ────────────────────────────────────────────────────────────────────
+// Per-message-type and per-client bandwidth accounting
+// ────────────────────────────────────────────────────────────────────
+
+#include "BandwidthStats.h"
+#include "Engine/Network/Protocol/MessageTypes.h"
+
+#include <algorithm>
+
+BandwidthStats::BandwidthStats()
+    : m_typeSlots(kSlots)
+{
+}
+
+void BandwidthStats::AddClient(uint32_t connHandle)
+{
+    m_clients[connHandle] = ClientCounters{};
+}
+
+void BandwidthStats::RemoveClient(uint32_t connHandle)
+{
+    m_clients.erase(connHandle);
+}
+
+void BandwidthStats::RecordMany(Direction dir, const uint32_t *connHandles, size_t count,
+                                const uint8_t *data, size_t len)
+{
+    if (len == 0 || count == 0)
+        return;
+    const uint8_t type = data[0];
+    m_typeSlots[m_current][dir][type].Add(count, len);
+    m_typeTotal[dir][type].Add(count, len);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto it = m_clients.find(connHandles[i]);
+        if (it == m_clients.end())
+            continue;
+        it->second.slots[m_current][dir].Add(1, len);
+        it->second.total[dir].Add(1, len);
+    }
+}
+
+bool BandwidthStats::AdvanceTo(Clock::time_point now)
+{
+    if (m_slotEnd == Clock::time_point{})
+        m_slotEnd = now + std::chrono::seconds(1);
+    if (now < m_slotEnd)
+        return false;
+
+    // A long stall closes several seconds at once; past a whole window
+    // every slot is clear anyway.
+    uint32_t closed = 0;
+    while (now >= m_slotEnd && closed < kSlots)
+    {
+        m_current = (m_current + 1) % kSlots;
+        m_typeSlots[m_current] = Slot{};
+        for (auto &entry : m_clients)
+            entry.second.slots[m_current] = {};
+        m_closedSlots = std::min(m_closedSlots + 1, kWindowSeconds);
+        m_slotEnd += std::chrono::seconds(1);
+        ++closed;
+    }
+    if (now >= m_slotEnd)
+        m_slotEnd = now + std::chrono::seconds(1);
+    return true;
+}
+
+BandwidthStats::Counter BandwidthStats::TypeWindow(Direction dir, uint32_t type) const
+{
+    Counter sum;
+    for (uint32_t k = 1; k <= m_closedSlots; ++k)
+        sum += m_typeSlots[(m_current + kSlots - k) % kSlots][dir][type];
+    return sum;
+}
+
+std::array<BandwidthStats::Counter, BandwidthStats::kDirections>
+BandwidthStats::ClientWindow(const ClientCounters &c) const
+{
+    std::array<Counter, kDirections> sum{};
+    for (uint32_t k = 1; k <= m_closedSlots; ++k)
+    {
+        const auto &slot = c.slots[(m_current + kSlots - k) % kSlots];
+        for (uint32_t d = 0; d < kDirections; ++d)
+            sum[d] += slot[d];
+    }
+    return sum;
+}
+
+BandwidthStats::Counter BandwidthStats::WindowTotal(Direction dir) const
+{
+    Counter sum;
+    for (uint32_t t = 0; t < kMessageTypes; ++t)
+        sum += TypeWindow(dir, t);
+    return sum;
+}
+
+void BandwidthStats::TopTypes(Direction dir, size_t limit, std::vector<TypeUsage> &out) const
+{
+    out.clear();
+    for (uint32_t t = 0; t < kMessageTypes; ++t)
+    {
+        if (m_typeTotal[dir][t].messages == 0)
+            continue;
+        out.push_back(TypeUsage{static_cast<uint8_t>(t), TypeWindow(dir, t), m_typeTotal[dir][t]});
+    }
+    std::sort(out.begin(), out.end(), [](const TypeUsage &a, const TypeUsage &b)
+              { return a.window.bytes != b.window.bytes ? a.window.bytes > b.window.bytes
+                                                        : a.total.bytes > b.total.bytes; });
+    if (out.size() > limit)
+        out.resize(limit);
+}
+
+void BandwidthStats::TopClients(Direction dir, bool bothWays, size_t limit,
+                                std::vector<ClientUsage> &out) const
+{
+    out.clear();
+    for (const auto &entry : m_clients)
+        out.push_back(ClientUsage{entry.first, ClientWindow(entry.second), entry.second.total});
+
+    auto weight = [dir, bothWays](const ClientUsage &c)
+    { return bothWays ? c.window[In].bytes + c.window[Out].bytes : c.window[dir].bytes; };
+    const size_t keep = std::min(limit, out.size());
+    std::partial_sort(out.begin(), out.begin() + static_cast<ptrdiff_t>(keep), out.end(),
+                      [&](const ClientUsage &a, const ClientUsage &b)
+                      { return weight(a) > weight(b); });
+    out.resize(keep);
+}
+
+const char *BandwidthStats::MessageName(uint8_t type)
+{
+    switch (static_cast<NetMessageType>(type))
+    {
+    case NetMessageType::ClientHello: return "ClientHello";
+    case NetMessageType::ServerWelcome: return "ServerWelcome";
+    case NetMessageType::ClientDisconnect: return "ClientDisconnect";
+    case NetMessageType::Heartbeat: return "Heartbeat";
+    case NetMessageType::MessageBundle: return "MessageBundle";
+    case NetMessageType::PositionUpdate: return "PositionUpdate";
+    case NetMessageType::PositionBroadcast: return "PositionBroadcast";
+    case NetMessageType::ObjectDespawn: return "ObjectDespawn";
+    case NetMessageType::ObjectRelease: return "ObjectRelease";
+    case NetMessageType::PositionBroadcastCompact: return "PositionBroadcastCompact";
+    case NetMessageType::SnapshotAck: return "SnapshotAck";
+    case NetMessageType::PositionBroadcastDelta: return "PositionBroadcastDelta";
+    case NetMessageType::SnapshotRate: return "SnapshotRate";
+    case NetMessageType::PositionRelay: return "PositionRelay";
+    case NetMessageType::RoomJoin: return "RoomJoin";
+    case NetMessageType::RoomLeave: return "RoomLeave";
+    case NetMessageType::ChatRequest: return "ChatRequest";
+    case NetMessageType::ChatBroadcast: return "ChatBroadcast";
+    case NetMessageType::NicknameUpdateRequest: return "NicknameUpdateRequest";
+    case NetMessageType::NicknameUpdateResult: return "NicknameUpdateResult";
+    case NetMessageType::PlayerMetaSnapshot: return "PlayerMetaSnapshot";
+    case NetMessageType::PlayerMetaUpsert: return "PlayerMetaUpsert";
+    case NetMessageType::PlayerMetaRemove: return "PlayerMetaRemove";
+    }
+    return nullptr;
+}
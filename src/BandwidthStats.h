@@ -0,0 +1,117 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/// Application-level bandwidth accounting: messages and payload bytes per
+/// message type and per client, in each direction, over a rolling window
+/// of the last kWindowSeconds whole seconds plus totals for the run.
+///
+/// GameServer counts where it hands payloads to the transport and in
+/// DispatchPacket, so bundled reliable messages count one by one (the
+/// bundle envelope does not) and a broadcast counts once per recipient.
+/// nbnet's own headers, acks and resends are not included. Clients are
+/// keyed by connection handle; counting never allocates.
+class BandwidthStats
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Direction : uint8_t
+    {
+        In,  // client → server
+        Out, // server → client
+    };
+    static constexpr uint32_t kDirections = 2;
+    static constexpr uint32_t kMessageTypes = 256;
+    static constexpr uint32_t kWindowSeconds = 10;
+
+    struct Counter
+    {
+        uint64_t messages = 0;
+        uint64_t bytes = 0;
+
+        void Add(uint64_t n, uint64_t len)
+        {
+            messages += n;
+            bytes += n * len;
+        }
+        Counter &operator+=(const Counter &o)
+        {
+            messages += o.messages;
+            bytes += o.bytes;
+            return *this;
+        }
+    };
+
+    BandwidthStats();
+
+    /// Start / stop tracking a connection. Traffic for unknown handles
+    /// still counts per message type.
+    void AddClient(uint32_t connHandle);
+    void RemoveClient(uint32_t connHandle);
+
+    void Record(Direction dir, uint32_t connHandle, const uint8_t *data, size_t len)
+    {
+        RecordMany(dir, &connHandle, 1, data, len);
+    }
+    /// One payload to (or from) each of `count` connections.
+    void RecordMany(Direction dir, const uint32_t *connHandles, size_t count,
+                    const uint8_t *data, size_t len);
+
+    /// Close the slots of every second that ended before `now`. Returns
+    /// true when the window moved.
+    bool AdvanceTo(Clock::time_point now);
+
+    /// Seconds the window currently covers (fewer than kWindowSeconds
+    /// right after start).
+    uint32_t WindowSeconds() const { return m_closedSlots; }
+
+    struct TypeUsage
+    {
+        uint8_t type;
+        Counter window;
+        Counter total;
+    };
+    struct ClientUsage
+    {
+        uint32_t connHandle;
+        std::array<Counter, kDirections> window;
+        std::array<Counter, kDirections> total;
+    };
+
+    /// Message types with traffic in `dir`, most window bytes first,
+    /// at most `limit` of them.
+    void TopTypes(Direction dir, size_t limit, std::vector<TypeUsage> &out) const;
+    /// Clients by window bytes in `dir` (both directions when `bothWays`),
+    /// heaviest first, at most `limit` of them.
+    void TopClients(Direction dir, bool bothWays, size_t limit, std::vector<ClientUsage> &out) const;
+    /// Window and total traffic over all types in `dir`.
+    Counter WindowTotal(Direction dir) const;
+
+    static const char *MessageName(uint8_t type);
+
+private:
+    using Slot = std::array<std::array<Counter, kMessageTypes>, kDirections>;
+    /// kWindowSeconds closed slots and the one being filled.
+    static constexpr uint32_t kSlots = kWindowSeconds + 1;
+
+    struct ClientCounters
+    {
+        std::array<std::array<Counter, kDirections>, kSlots> slots{};
+        std::array<Counter, kDirections> total{};
+    };
+
+    Counter TypeWindow(Direction dir, uint32_t type) const;
+    std::array<Counter, kDirections> ClientWindow(const ClientCounters &c) const;
+
+    std::vector<Slot> m_typeSlots; // kSlots, heap: ~8 KB each
+    Slot m_typeTotal{};
+    std::unordered_map<uint32_t, ClientCounters> m_clients;
+    uint32_t m_current = 0;     // slot being filled
+    uint32_t m_closedSlots = 0; // closed slots in the window, up to kWindowSeconds
+    Clock::time_point m_slotEnd{};
+};
@@ -3,6 +3,7 @@
 // ────────────────────────────────────────────────────────────────────
 
 #include "GameServer.h"
+#include "Tracer.h"
 
 #include <cctype>
 
@@ -35,10 +36,10 @@ static constexpr std::chrono::milliseconds CHAT_RATE_LIMIT{300}; // 0.3 s
 
 std::string GameServer::GetClientDisplayName(ClientID clientID) const
 {
-    auto it = m_clients.find(clientID);
-    if (it == m_clients.end() || it->second.nickname.empty())
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos || m_clients.cold[index].nickname.empty())
         return "Player " + std::to_string(clientID);
-    return it->second.nickname;
+    return m_clients.cold[index].nickname;
 }
 
 std::string GameServer::NormalizeNickname(const std::string &nickname)
@@ -70,16 +71,22 @@ void GameServer::SendNicknameUpdateResult(ClientID clientID,
                                           NicknameUpdateStatus status,
                                           const std::string &nickname)
 {
-    auto pkt = PacketSerializer::WriteNicknameUpdateResult(status, nickname);
-    SendTo(clientID, pkt.data(), pkt.size(), 0);
+    uint8_t pkt[PacketSerializer::kMaxPacketSize<MsgNicknameUpdateResult>];
+    const size_t len =
+        PacketSerializer::WriteNicknameUpdateResultTo(pkt, sizeof(pkt), status, nickname);
+    SendTo(clientID, pkt, len, 0);
 }
 
 void GameServer::HandleNicknameUpdateRequest(ClientID clientID,
                                              const uint8_t *data, size_t len)
 {
-    auto it = m_clients.find(clientID);
-    if (it == m_clients.end() || !it->second.welcomed)
+    NW_TRACE_FUNCTION();
+    if (len < sizeof(MsgNicknameUpdateRequest))
         return;
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos || !m_clients.IsWelcomed(index))
+        return;
+    ClientColdState &cs = m_clients.cold[index];
 
     auto req = PacketSerializer::ReadNicknameUpdateRequest(data, len);
     const std::string requested = req.nickname;
@@ -109,11 +116,11 @@ void GameServer::HandleNicknameUpdateRequest(ClientID clientID,
         return;
     }
 
-    if (!it->second.nickname.empty())
+    if (!cs.nickname.empty())
     {
-        m_nicknameIndex.erase(NormalizeNickname(it->second.nickname));
+        m_nicknameIndex.erase(NormalizeNickname(cs.nickname));
     }
-    it->second.nickname = requested;
+    cs.nickname = requested;
     m_nicknameIndex[requestedNorm] = clientID;
 
     SendNicknameUpdateResult(clientID, NicknameUpdateStatus::Accepted, requested);
@@ -124,9 +131,13 @@ void GameServer::HandleNicknameUpdateRequest(ClientID clientID,
 void GameServer::HandleChatRequest(ClientID clientID,
                                    const uint8_t *data, size_t len)
 {
-    auto it = m_clients.find(clientID);
-    if (it == m_clients.end() || !it->second.welcomed)
+    NW_TRACE_FUNCTION();
+    if (len < sizeof(MsgChatRequest))
+        return;
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos || !m_clients.IsWelcomed(index))
         return;
+    ClientColdState &cs = m_clients.cold[index];
 
     auto req = PacketSerializer::ReadChatRequest(data, len);
 
@@ -140,21 +151,21 @@ void GameServer::HandleChatRequest(ClientID clientID,
     }
 
     // 2. Rate limit
-    auto now = std::chrono::steady_clock::now();
-    if ((now - it->second.lastChatTime) < CHAT_RATE_LIMIT)
+    const auto now = m_receiveTime;
+    if ((now - cs.lastChatTime) < CHAT_RATE_LIMIT)
     {
         std::cerr << "[GameServer] Chat rate-limited for " << clientID << "\n";
         SendSystemMessage("Message rate-limited. Please slow down.", clientID);
         return;
     }
-    it->second.lastChatTime = now;
+    cs.lastChatTime = now;
 
     const std::string senderName = GetClientDisplayName(clientID);
 
     auto setPublicMode = [&]()
     {
-        it->second.whisperTargetID = INVALID_CLIENT_ID;
-        it->second.whisperTargetNickname.clear();
+        cs.whisperTargetID = INVALID_CLIENT_ID;
+        cs.whisperTargetNickname.clear();
     };
 
     auto sendHelp = [this, clientID]()
@@ -208,8 +219,8 @@ void GameServer::HandleChatRequest(ClientID clientID,
             }
 
             const ClientID targetID = targetIdIt->second;
-            auto targetStateIt = m_clients.find(targetID);
-            if (targetStateIt == m_clients.end() || !targetStateIt->second.welcomed)
+            const uint32_t target = m_clients.Find(targetID);
+            if (target == ClientTable::npos || !m_clients.IsWelcomed(target))
             {
                 setPublicMode();
                 SendSystemMessage(
@@ -220,8 +231,8 @@ void GameServer::HandleChatRequest(ClientID clientID,
             }
 
             const std::string targetDisplayName = GetClientDisplayName(targetID);
-            it->second.whisperTargetID = targetID;
-            it->second.whisperTargetNickname = targetDisplayName;
+            cs.whisperTargetID = targetID;
+            cs.whisperTargetNickname = targetDisplayName;
             SendSystemMessage(
                 "[CHAT_MODE:WHISPER:" + targetDisplayName +
                     "] Whisper mode on for '" + targetDisplayName +
@@ -234,16 +245,16 @@ void GameServer::HandleChatRequest(ClientID clientID,
         return;
     }
 
-    if (it->second.whisperTargetID != INVALID_CLIENT_ID)
+    if (cs.whisperTargetID != INVALID_CLIENT_ID)
     {
-        const ClientID targetID = it->second.whisperTargetID;
-        auto targetStateIt = m_clients.find(targetID);
-        if (targetStateIt == m_clients.end() || !targetStateIt->second.welcomed)
+        const ClientID targetID = cs.whisperTargetID;
+        const uint32_t target = m_clients.Find(targetID);
+        if (target == ClientTable::npos || !m_clients.IsWelcomed(target))
         {
             const std::string offlineName =
-                it->second.whisperTargetNickname.empty()
+                cs.whisperTargetNickname.empty()
                     ? "selected player"
-                    : ("'" + it->second.whisperTargetNickname + "'");
+                    : ("'" + cs.whisperTargetNickname + "'");
             setPublicMode();
             SendSystemMessage(
                 "[CHAT_MODE:PUBLIC] Whisper target " + offlineName +
@@ -253,7 +264,7 @@ void GameServer::HandleChatRequest(ClientID clientID,
         }
 
         const std::string targetDisplayName = GetClientDisplayName(targetID);
-        it->second.whisperTargetNickname = targetDisplayName;
+        cs.whisperTargetNickname = targetDisplayName;
 
         std::cout << "[Chat] [Whisper] " << senderName << " -> "
                   << targetDisplayName << ": " << req.text << "\n";
@@ -273,8 +284,10 @@ void GameServer::HandleChatRequest(ClientID clientID,
     {
     case ChatMessageType::Public:
     {
-        std::cout << "[Chat] [Public] " << senderName << ": " << req.text << "\n";
-        BroadcastChat(ChatMessageType::Public, clientID, senderName, req.text);
+        const RoomID room = m_clients.roomIDs[index];
+        std::cout << "[Chat] [Public] [Room " << room << "] " << senderName << ": "
+                  << req.text << "\n";
+        BroadcastChat(room, ChatMessageType::Public, clientID, senderName, req.text);
         break;
     }
     case ChatMessageType::Whisper:
@@ -290,25 +303,23 @@ void GameServer::HandleChatRequest(ClientID clientID,
     }
 }
 
-void GameServer::BroadcastChat(ChatMessageType chatType, ClientID senderID,
+void GameServer::BroadcastChat(RoomID room, ChatMessageType chatType, ClientID senderID,
                                const std::string &senderName, const std::string &text)
 {
-    auto pkt = PacketSerializer::WriteChatBroadcast(chatType, senderID, senderName, text);
-    for (auto &[id, cs] : m_clients)
-    {
-        (void)id;
-        if (!cs.welcomed)
-            continue;
-        SendTo(cs.id, pkt.data(), pkt.size(), 0); // reliable
-    }
+    uint8_t pkt[PacketSerializer::kMaxPacketSize<MsgChatBroadcast>];
+    const size_t len = PacketSerializer::WriteChatBroadcastTo(
+        pkt, sizeof(pkt), chatType, senderID, senderName, text);
+    BroadcastTo(room, pkt, len, 0); // reliable
 }
 
 void GameServer::SendChatTo(ClientID targetID, ChatMessageType chatType,
                             ClientID senderID, const std::string &senderName,
                             const std::string &text)
 {
-    auto pkt = PacketSerializer::WriteChatBroadcast(chatType, senderID, senderName, text);
-    SendTo(targetID, pkt.data(), pkt.size(), 0); // reliable
+    uint8_t pkt[PacketSerializer::kMaxPacketSize<MsgChatBroadcast>];
+    const size_t len = PacketSerializer::WriteChatBroadcastTo(
+        pkt, sizeof(pkt), chatType, senderID, senderName, text);
+    SendTo(targetID, pkt, len, 0); // reliable
 }
 
 void GameServer::SendSystemMessage(const std::string &text, ClientID targetID)
@@ -316,13 +327,11 @@ void GameServer::SendSystemMessage(const std::string &text, ClientID targetID)
     if (targetID != INVALID_CLIENT_ID)
     {
         // Send to specific client
-        auto pkt = PacketSerializer::WriteChatBroadcast(
-            ChatMessageType::System, INVALID_CLIENT_ID, "System", text);
-        SendTo(targetID, pkt.data(), pkt.size(), 0);
+        SendChatTo(targetID, ChatMessageType::System, INVALID_CLIENT_ID, "System", text);
     }
     else
     {
         // Broadcast to all
-        BroadcastChat(ChatMessageType::System, INVALID_CLIENT_ID, "System", text);
+        BroadcastChat(kAllRooms, ChatMessageType::System, INVALID_CLIENT_ID, "System", text);
     }
 }
@@ -0,0 +1,272 @@
+#pragma once
+#include "Engine/Network/NetTypes.h"
+#include "Engine/Network/Protocol/Messages.h"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Broadcast ticks kept for delta baselines (~1 s at 30 Hz).
+constexpr uint32_t kSnapshotHistory = 32;
+
+/// Stable reference to a client: survives other clients being removed,
+/// and resolves to nothing once its own client is gone.
+struct ClientHandle
+{
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const ClientHandle &o) const
+    {
+        return slot == o.slot && generation == o.generation;
+    }
+    bool operator!=(const ClientHandle &o) const { return !(*this == o); }
+    bool operator<(const ClientHandle &o) const
+    {
+        return slot != o.slot ? slot < o.slot : generation < o.generation;
+    }
+};
+
+/// Per-client state that tick loops rarely touch: identity, chat and
+/// per-receiver broadcast bookkeeping.
+struct ClientColdState
+{
+    NetUUID uuid{}; // persistent client identity
+    std::string nickname;
+    ClientID whisperTargetID = INVALID_CLIENT_ID;
+    std::string whisperTargetNickname;
+    // ObjectRelease arrived; ignore late unreliable PositionUpdate briefly.
+    std::chrono::steady_clock::time_point releaseFenceUntil{};
+    std::chrono::steady_clock::time_point lastChatTime{}; // rate limit
+
+    /// Broadcast priority accumulators for entities this client receives,
+    /// indexed by the entity owner's slot. Reset when the entity is sent;
+    /// an accumulator left by a departed owner (older generation) reads
+    /// as zero, so removal needs no sweep over every client.
+    struct SendPriority
+    {
+        uint32_t generation = 0;
+        float value = 0.0f;
+    };
+    std::vector<SendPriority> sendPriority;
+
+    /// Accumulator for `owner`, grown and reset on first use.
+    float &PriorityOf(ClientHandle owner)
+    {
+        if (owner.slot >= sendPriority.size())
+            sendPriority.resize(owner.slot + 1);
+        SendPriority &p = sendPriority[owner.slot];
+        if (p.generation != owner.generation)
+            p = SendPriority{owner.generation, 0.0f};
+        return p.value;
+    }
+    /// Current value for `owner` without growing the column.
+    float PeekPriority(ClientHandle owner) const
+    {
+        if (owner.slot >= sendPriority.size() ||
+            sendPriority[owner.slot].generation != owner.generation)
+            return 0.0f;
+        return sendPriority[owner.slot].value;
+    }
+
+    /// Delta baselines: which entities (sorted ClientIDs) this client
+    /// was sent on each recent tick, indexed by tick % kSnapshotHistory.
+    struct SentSnapshot
+    {
+        uint32_t tick = 0;
+        std::vector<ClientID> ids;
+    };
+    std::array<SentSnapshot, kSnapshotHistory> sentSnapshots{};
+    uint32_t ackedTick = 0; // newest tick acknowledged via SnapshotAck
+
+    /// Reliable messages queued this tick (MessageBundle being built),
+    /// flushed by FlushReliableBundles() before packets go out.
+    std::vector<uint8_t> reliableBundle;
+};
+
+/// Generational slot map of connected clients.
+///
+/// Clients are stored densely (removal swaps the last client into the hole),
+/// with the per-tick data split into structure-of-arrays columns so loops
+/// such as BroadcastPositions walk contiguous memory. Everything else sits
+/// in the parallel `cold` column. Dense indices are only valid until the
+/// next Insert/Remove; state kept across those (connection index, relay
+/// queue, room membership, send priorities) holds a ClientHandle. ClientIDs
+/// are the wire identity and are looked up by hash only when a message
+/// names one.
+class ClientTable
+{
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    enum Flags : uint8_t
+    {
+        Welcomed = 1 << 0,     // ClientHello processed
+        HasTransform = 1 << 1, // reported a PositionUpdate for a live object
+    };
+
+    // ── Hot columns (dense, index 0..Size()-1) ─────────────────────
+    std::vector<ClientID> ids;
+    std::vector<uint32_t> connHandles; // NBN_ConnectionHandle
+    std::vector<uint8_t> flags;
+    std::vector<NetObjectID> objectIDs;
+    std::vector<NetTransformState> transforms;
+    std::vector<std::chrono::steady_clock::time_point> lastSeen;
+    std::vector<RoomID> roomIDs;
+    std::vector<uint8_t> sendIntervals; // position broadcast every N ticks
+
+    // ── Cold column ───────────────────────────────────────────────
+    std::vector<ClientColdState> cold;
+
+    uint32_t Size() const { return static_cast<uint32_t>(ids.size()); }
+    bool Empty() const { return ids.empty(); }
+
+    /// Dense index of `id`, or npos.
+    uint32_t Find(ClientID id) const
+    {
+        auto it = m_idToSlot.find(id);
+        return it != m_idToSlot.end() ? m_slotToDense[it->second] : npos;
+    }
+
+    bool IsWelcomed(uint32_t i) const { return (flags[i] & Welcomed) != 0; }
+    bool HasTransformAt(uint32_t i) const { return (flags[i] & HasTransform) != 0; }
+    void SetFlag(uint32_t i, Flags flag, bool on)
+    {
+        flags[i] = on ? static_cast<uint8_t>(flags[i] | flag)
+                      : static_cast<uint8_t>(flags[i] & ~flag);
+    }
+
+    /// Add a client; `id` must not be present. Returns its dense index.
+    uint32_t Insert(ClientID id, uint32_t connHandle)
+    {
+        assert(Find(id) == npos);
+
+        uint32_t slot;
+        if (!m_freeSlots.empty())
+        {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else
+        {
+            slot = static_cast<uint32_t>(m_slotToDense.size());
+            m_slotToDense.push_back(npos);
+            m_generations.push_back(0);
+        }
+
+        const uint32_t dense = Size();
+        m_slotToDense[slot] = dense;
+        m_denseToSlot.push_back(slot);
+        m_idToSlot[id] = slot;
+
+        ids.push_back(id);
+        connHandles.push_back(connHandle);
+        flags.push_back(0);
+        objectIDs.push_back(INVALID_NET_OBJECT_ID);
+        transforms.push_back(NetTransformState{});
+        lastSeen.push_back(std::chrono::steady_clock::now());
+        roomIDs.push_back(DEFAULT_ROOM_ID);
+        sendIntervals.push_back(1);
+        cold.emplace_back();
+        return dense;
+    }
+
+    /// Remove the client at dense index `i`. The last client moves into `i`.
+    void Remove(uint32_t i)
+    {
+        assert(i < Size());
+        const uint32_t last = Size() - 1;
+        const uint32_t slot = m_denseToSlot[i];
+
+        m_idToSlot.erase(ids[i]);
+        ++m_generations[slot];
+        m_slotToDense[slot] = npos;
+        m_freeSlots.push_back(slot);
+
+        if (i != last)
+        {
+            ids[i] = ids[last];
+            connHandles[i] = connHandles[last];
+            flags[i] = flags[last];
+            objectIDs[i] = objectIDs[last];
+            transforms[i] = transforms[last];
+            lastSeen[i] = lastSeen[last];
+            roomIDs[i] = roomIDs[last];
+            sendIntervals[i] = sendIntervals[last];
+            cold[i] = std::move(cold[last]);
+
+            m_denseToSlot[i] = m_denseToSlot[last];
+            m_slotToDense[m_denseToSlot[i]] = i;
+        }
+
+        ids.pop_back();
+        connHandles.pop_back();
+        flags.pop_back();
+        objectIDs.pop_back();
+        transforms.pop_back();
+        lastSeen.pop_back();
+        roomIDs.pop_back();
+        sendIntervals.pop_back();
+        cold.pop_back();
+        m_denseToSlot.pop_back();
+    }
+
+    /// Give the client at dense index `i` a different ClientID (returning
+    /// players reclaim their old ID). `newID` must not be present.
+    void Rekey(uint32_t i, ClientID newID)
+    {
+        assert(Find(newID) == npos);
+        const uint32_t slot = m_denseToSlot[i];
+        m_idToSlot.erase(ids[i]);
+        m_idToSlot[newID] = slot;
+        ids[i] = newID;
+    }
+
+    ClientHandle HandleOf(uint32_t i) const
+    {
+        const uint32_t slot = m_denseToSlot[i];
+        return ClientHandle{slot, m_generations[slot]};
+    }
+
+    /// Dense index for `h`, or npos if that client has been removed.
+    uint32_t Resolve(ClientHandle h) const
+    {
+        if (h.slot >= m_generations.size() || m_generations[h.slot] != h.generation)
+            return npos;
+        return m_slotToDense[h.slot];
+    }
+
+    void Clear()
+    {
+        ids.clear();
+        connHandles.clear();
+        flags.clear();
+        objectIDs.clear();
+        transforms.clear();
+        lastSeen.clear();
+        roomIDs.clear();
+        sendIntervals.clear();
+        cold.clear();
+        m_idToSlot.clear();
+        m_denseToSlot.clear();
+        // Keep generations so stale handles never resolve to new clients.
+        m_freeSlots.clear();
+        for (uint32_t slot = 0; slot < m_slotToDense.size(); ++slot)
+        {
+            m_slotToDense[slot] = npos;
+            ++m_generations[slot];
+            m_freeSlots.push_back(slot);
+        }
+    }
+
+private:
+    std::unordered_map<ClientID, uint32_t> m_idToSlot; // ClientID → slot
+    std::vector<uint32_t> m_slotToDense;                // slot → dense index
+    std::vector<uint32_t> m_denseToSlot;                // dense index → slot
+    std::vector<uint32_t> m_generations;                // per slot
+    std::vector<uint32_t> m_freeSlots;
+};
@@ -2,12 +2,10 @@
 // GameServer connection and packet dispatch
 // ────────────────────────────────────────────────────────────────────
 
-extern "C"
-{
-#include <nbnet.h>
-}
-
 #include "GameServer.h"
+#include "Tracer.h"
+
+#include <algorithm>
 
 namespace
 {
@@ -15,54 +13,51 @@ namespace
     constexpr std::chrono::milliseconds kReleaseFenceDuration{350};
 }
 
-void GameServer::HandleNewConnection()
+void GameServer::HandleNewConnection(uint32_t conn)
 {
-    NBN_ConnectionHandle conn = NBN_GameServer_GetIncomingConnection();
-
-    // Always accept (authentication can be added later)
-    NBN_GameServer_AcceptIncomingConnection();
-
+    NW_TRACE_FUNCTION();
+    // The transport has already accepted it (authentication can be added later)
     const ClientID newID = m_nextClientID++;
 
-    ClientState state;
-    state.id = newID;
-    state.connHandle = conn;
-    state.lastSeen = std::chrono::steady_clock::now();
-
-    m_clients[newID] = state;
-    m_connIndex[conn] = newID;
+    const uint32_t index = m_clients.Insert(newID, conn);
+    m_clients.sendIntervals[index] = SendIntervalFor(0);
+    m_connIndex[conn] = m_clients.HandleOf(index);
+    m_bandwidth.AddClient(conn);
 
     std::cout << "[GameServer] Peer connected (awaiting Hello), assigned temp ClientID "
               << newID << "\n";
 }
 
-void GameServer::HandleClientDisconnected()
+ClientID GameServer::ClientOfConn(uint32_t connHandle) const
 {
-    NBN_ConnectionHandle conn = NBN_GameServer_GetDisconnectedClient();
-
-    auto it = m_connIndex.find(conn);
+    auto it = m_connIndex.find(connHandle);
     if (it == m_connIndex.end())
-        return;
-
-    RemoveClient(it->second, "disconnected");
+        return INVALID_CLIENT_ID;
+    const uint32_t index = m_clients.Resolve(it->second);
+    return index != ClientTable::npos ? m_clients.ids[index] : INVALID_CLIENT_ID;
 }
 
-void GameServer::HandleClientMessage()
+void GameServer::HandleClientDisconnected(uint32_t conn)
 {
-    NBN_MessageInfo info = NBN_GameServer_GetMessageInfo();
-
-    if (info.type != NBN_BYTE_ARRAY_MESSAGE_TYPE || !info.data)
+    NW_TRACE_FUNCTION();
+    const ClientID clientID = ClientOfConn(conn);
+    if (clientID == INVALID_CLIENT_ID)
         return;
 
-    NBN_ByteArrayMessage *msg =
-        static_cast<NBN_ByteArrayMessage *>(info.data);
+    RemoveClient(clientID, "disconnected");
+}
 
-    // Look up who sent it (info.sender is NBN_ConnectionHandle)
-    auto it = m_connIndex.find(info.sender);
-    if (it == m_connIndex.end())
+void GameServer::HandleClientMessage(const NetEvent &event)
+{
+    // Look up who sent it (connHandle is NBN_ConnectionHandle)
+    const ClientID clientID = ClientOfConn(event.connHandle);
+    if (clientID == INVALID_CLIENT_ID)
         return;
 
-    DispatchPacket(it->second, msg->bytes, msg->length);
+    // With the I/O thread the packet may have waited in the queue for
+    // part of a tick; keep-alive uses the time it actually arrived.
+    m_receiveTime = event.received;
+    DispatchPacket(clientID, event.data, event.len);
 }
 
 void GameServer::DispatchPacket(ClientID clientID,
@@ -72,13 +67,37 @@ void GameServer::DispatchPacket(ClientID clientID,
         return;
 
     // Treat any valid packet from a known client as keep-alive.
-    auto itClient = m_clients.find(clientID);
-    if (itClient != m_clients.end())
-        itClient->second.lastSeen = std::chrono::steady_clock::now();
+    const uint32_t index = m_clients.Find(clientID);
+    if (index != ClientTable::npos)
+        m_clients.lastSeen[index] = m_receiveTime;
 
     NetMessageType type = PacketSerializer::PeekType(data, len);
+    // A bundle's messages are counted one by one as they are dispatched.
+    if (index != ClientTable::npos && type != NetMessageType::MessageBundle)
+        m_bandwidth.Record(BandwidthStats::In, m_clients.connHandles[index], data, len);
+    const auto handlerStart = TickProfiler::Clock::now();
     switch (type)
     {
+    case NetMessageType::MessageBundle:
+    {
+        if (index == ClientTable::npos)
+            break;
+
+        // A bundled ClientHello may re-key this connection to a returning
+        // player's ClientID, so re-resolve the sender after every message.
+        const uint32_t connHandle = m_clients.connHandles[index];
+        ClientID sender = clientID;
+        const bool ok = PacketSerializer::ForEachBundledMessage(
+            data, len, [&](const uint8_t *msg, size_t msgLen)
+            {
+                DispatchPacket(sender, msg, msgLen);
+                sender = ClientOfConn(connHandle);
+            });
+        if (!ok)
+            std::cerr << "[GameServer] Malformed message bundle from "
+                      << clientID << "\n";
+        break;
+    }
     case NetMessageType::ClientHello:
         HandleClientHello(clientID, data, len);
         break;
@@ -95,23 +114,45 @@ void GameServer::DispatchPacket(ClientID clientID,
         HandleClientDisconnect(clientID);
         break;
     case NetMessageType::ChatRequest:
-        HandleChatRequest(clientID, data, len);
+        if (!DeferIfShedding(clientID, data, len))
+            HandleChatRequest(clientID, data, len);
         break;
     case NetMessageType::NicknameUpdateRequest:
-        HandleNicknameUpdateRequest(clientID, data, len);
+        if (!DeferIfShedding(clientID, data, len))
+            HandleNicknameUpdateRequest(clientID, data, len);
+        break;
+    case NetMessageType::SnapshotAck:
+        HandleSnapshotAck(clientID, data, len);
+        break;
+    case NetMessageType::RoomJoin:
+        HandleRoomJoin(clientID, data, len);
+        break;
+    case NetMessageType::RoomLeave:
+        HandleRoomLeave(clientID);
+        break;
+    case NetMessageType::SnapshotRate:
+        HandleSnapshotRate(clientID, data, len);
         break;
     default:
         std::cerr << "[GameServer] Unknown message type "
                   << static_cast<int>(type) << "\n";
         break;
     }
+
+    // A bundle's messages were timed one by one above.
+    if (type != NetMessageType::MessageBundle)
+        m_profiler.RecordHandler(static_cast<uint8_t>(type),
+                                 TickProfiler::Clock::now() - handlerStart);
 }
 
 void GameServer::HandleClientHello(ClientID clientID,
                                    const uint8_t *data, size_t len)
 {
-    auto it = m_clients.find(clientID);
-    if (it == m_clients.end() || it->second.welcomed)
+    NW_TRACE_FUNCTION();
+    if (len < sizeof(MsgClientHello))
+        return;
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos || m_clients.IsWelcomed(index))
         return;
 
     // Read UUID from the Hello packet
@@ -131,9 +172,9 @@ void GameServer::HandleClientHello(ClientID clientID,
             // reject the later login instead of replacing the active session.
             if (oldID != clientID)
             {
-                auto existingIt = m_clients.find(oldID);
-                if (existingIt != m_clients.end() &&
-                    existingIt->second.connHandle != it->second.connHandle)
+                const uint32_t existing = m_clients.Find(oldID);
+                if (existing != ClientTable::npos &&
+                    m_clients.connHandles[existing] != m_clients.connHandles[index])
                 {
                     std::cout << "[GameServer] Duplicate UUID blocked, keep online ClientID "
                               << oldID << "\n";
@@ -144,81 +185,90 @@ void GameServer::HandleClientHello(ClientID clientID,
             std::cout << "[GameServer] Returning player UUID recognised, "
                       << "reusing ClientID " << oldID << "\n";
 
-            // Update the state to use the old ClientID
-            ClientState &cs = it->second;
-            cs.id = oldID;
-            cs.uuid = uuid;
-            cs.welcomed = true;
-            if (cs.nickname.empty())
-                cs.nickname = "Player " + std::to_string(oldID);
-            cs.lastSeen = std::chrono::steady_clock::now();
-
-            // Re-index: move state from temp clientID to old clientID
-            ClientState movedState = cs;
-            m_clients.erase(it);
-            m_clients[oldID] = movedState;
-            m_connIndex[movedState.connHandle] = oldID;
-            m_nicknameIndex[NormalizeNickname(movedState.nickname)] = oldID;
+            // Re-index: the state keeps its slot, only the key changes
+            if (oldID != clientID)
+                m_clients.Rekey(index, oldID);
+            ClientColdState &cold = m_clients.cold[index];
+            cold.uuid = uuid;
+            m_clients.SetFlag(index, ClientTable::Welcomed, true);
+            if (cold.nickname.empty())
+                cold.nickname = "Player " + std::to_string(oldID);
+            m_clients.lastSeen[index] = m_receiveTime;
+
+            m_nicknameIndex[NormalizeNickname(cold.nickname)] = oldID;
 
+            const std::string nickname = cold.nickname;
             SendWelcome(oldID);
-            SendNicknameUpdateResult(oldID, NicknameUpdateStatus::Accepted, movedState.nickname);
+            SendNicknameUpdateResult(oldID, NicknameUpdateStatus::Accepted, nickname);
             SendPlayerMetaSnapshot(oldID);
-            BroadcastPlayerMetaUpsert(oldID, movedState.nickname, false);
+            BroadcastPlayerMetaUpsert(oldID, nickname, false);
             return;
         }
 
         // New player — register UUID
-        it->second.uuid = uuid;
+        m_clients.cold[index].uuid = uuid;
         m_uuidIndex[uuid] = clientID;
         std::cout << "[GameServer] New player UUID registered, ClientID "
                   << clientID << "\n";
     }
 
-    it->second.welcomed = true;
-    if (it->second.nickname.empty())
-        it->second.nickname = "Player " + std::to_string(clientID);
-    m_nicknameIndex[NormalizeNickname(it->second.nickname)] = clientID;
-    it->second.lastSeen = std::chrono::steady_clock::now();
+    m_clients.SetFlag(index, ClientTable::Welcomed, true);
+    ClientColdState &cold = m_clients.cold[index];
+    if (cold.nickname.empty())
+        cold.nickname = "Player " + std::to_string(clientID);
+    m_nicknameIndex[NormalizeNickname(cold.nickname)] = clientID;
+    m_clients.lastSeen[index] = m_receiveTime;
+
+    const std::string nickname = cold.nickname;
     SendWelcome(clientID);
-    SendNicknameUpdateResult(clientID, NicknameUpdateStatus::Accepted, it->second.nickname);
+    SendNicknameUpdateResult(clientID, NicknameUpdateStatus::Accepted, nickname);
     SendPlayerMetaSnapshot(clientID);
-    BroadcastPlayerMetaUpsert(clientID, it->second.nickname, false);
+    BroadcastPlayerMetaUpsert(clientID, nickname, false);
     std::cout << "[GameServer] Assigned ClientID " << clientID << "\n";
 }
 
 void GameServer::HandlePositionUpdate(ClientID clientID,
                                       const uint8_t *data, size_t len)
 {
+    NW_TRACE_FUNCTION();
+    if (len < sizeof(MsgPositionUpdate))
+        return;
     auto msg = PacketSerializer::Read<MsgPositionUpdate>(data, len);
 
-    auto it = m_clients.find(clientID);
-    if (it == m_clients.end())
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos)
         return;
-    if (!it->second.welcomed)
+    if (!m_clients.IsWelcomed(index))
         return;
 
-    const auto now = std::chrono::steady_clock::now();
-    if (now < it->second.releaseFenceUntil)
+    const auto now = m_receiveTime;
+    if (now < m_clients.cold[index].releaseFenceUntil)
     {
         // Ignore late unreliable updates that race with ObjectRelease.
         return;
     }
 
-    it->second.objectID = msg.objectID;
-    it->second.lastTransform = msg.transform;
-    it->second.hasTransform = true;
-    it->second.lastSeen = now;
+    m_clients.objectIDs[index] = msg.objectID;
+    m_clients.transforms[index] = msg.transform;
+    m_clients.SetFlag(index, ClientTable::HasTransform, true);
+    m_clients.lastSeen[index] = now;
+
+    if (m_config.relayWindow.count() > 0)
+        m_relayPending.push_back(m_clients.HandleOf(index));
 }
 
 void GameServer::HandleObjectRelease(ClientID clientID,
                                      const uint8_t *data, size_t len)
 {
+    NW_TRACE_FUNCTION();
+    if (len < sizeof(MsgObjectRelease))
+        return;
     auto msg = PacketSerializer::Read<MsgObjectRelease>(data, len);
 
-    auto it = m_clients.find(clientID);
-    if (it == m_clients.end())
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos)
         return;
-    if (!it->second.welcomed)
+    if (!m_clients.IsWelcomed(index))
         return;
 
     const NetObjectID releasedObjectID = msg.objectID;
@@ -227,21 +277,17 @@ void GameServer::HandleObjectRelease(ClientID clientID,
 
     // ObjectRelease is authoritative for gameplay exit:
     // always broadcast despawn for the released object id.
-    for (const auto &[id, cs] : m_clients)
-    {
-        (void)id;
-        if (!cs.welcomed || cs.id == clientID)
-            continue;
-        SendObjectDespawn(cs.id, clientID, releasedObjectID);
-    }
+    MsgObjectDespawn despawn;
+    despawn.ownerClientID = clientID;
+    despawn.objectID = releasedObjectID;
+    BroadcastMessage(m_clients.roomIDs[index], despawn, 0, clientID); // reliable
 
     // Clear object state but keep the connection alive for menu/options chat.
-    it->second.objectID = INVALID_NET_OBJECT_ID;
-    it->second.hasTransform = false;
-    it->second.lastTransform = {};
-    const auto now = std::chrono::steady_clock::now();
-    it->second.lastSeen = now;
-    it->second.releaseFenceUntil = now + kReleaseFenceDuration;
+    m_clients.objectIDs[index] = INVALID_NET_OBJECT_ID;
+    m_clients.SetFlag(index, ClientTable::HasTransform, false);
+    m_clients.transforms[index] = {};
+    m_clients.lastSeen[index] = m_receiveTime;
+    m_clients.cold[index].releaseFenceUntil = m_receiveTime + kReleaseFenceDuration;
 
     std::cout << "[GameServer] Client " << clientID
               << " released object " << releasedObjectID << "\n";
@@ -250,6 +296,9 @@ void GameServer::HandleObjectRelease(ClientID clientID,
 void GameServer::HandleHeartbeat(ClientID clientID,
                                  const uint8_t *data, size_t len)
 {
+    NW_TRACE_FUNCTION();
+    if (len < sizeof(MsgHeartbeat))
+        return;
     auto msg = PacketSerializer::Read<MsgHeartbeat>(data, len);
     if (msg.clientID != INVALID_CLIENT_ID && msg.clientID != clientID)
     {
@@ -258,12 +307,168 @@ void GameServer::HandleHeartbeat(ClientID clientID,
         return;
     }
 
-    auto it = m_clients.find(clientID);
-    if (it != m_clients.end())
-        it->second.lastSeen = std::chrono::steady_clock::now();
+    const uint32_t index = m_clients.Find(clientID);
+    if (index != ClientTable::npos)
+        m_clients.lastSeen[index] = m_receiveTime;
+}
+
+void GameServer::HandleSnapshotAck(ClientID clientID,
+                                   const uint8_t *data, size_t len)
+{
+    NW_TRACE_FUNCTION();
+    if (len < sizeof(MsgSnapshotAck))
+        return;
+    auto msg = PacketSerializer::Read<MsgSnapshotAck>(data, len);
+
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos || !m_clients.IsWelcomed(index))
+        return;
+
+    // Acks arrive unreliably and may be reordered; only move forward, and
+    // only to a tick this client was actually sent (it may skip ticks at a
+    // lower send rate).
+    const uint32_t tick = msg.serverTick;
+    ClientColdState &cold = m_clients.cold[index];
+    if (tick > m_serverTick || tick <= cold.ackedTick ||
+        cold.sentSnapshots[tick % kSnapshotHistory].tick != tick)
+        return;
+    cold.ackedTick = tick;
+}
+
+void GameServer::HandleSnapshotRate(ClientID clientID,
+                                    const uint8_t *data, size_t len)
+{
+    NW_TRACE_FUNCTION();
+    if (len < sizeof(MsgSnapshotRate))
+        return;
+    auto msg = PacketSerializer::Read<MsgSnapshotRate>(data, len);
+
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos)
+        return;
+
+    const uint8_t interval = SendIntervalFor(msg.snapshotsPerSecond);
+    if (interval == m_clients.sendIntervals[index])
+        return;
+    m_clients.sendIntervals[index] = interval;
+    std::cout << "[GameServer] Client " << clientID << " snapshot rate "
+              << m_config.tickRate / interval << "/s (every " << static_cast<int>(interval)
+              << " ticks)\n";
 }
 
 void GameServer::HandleClientDisconnect(ClientID clientID)
 {
+    NW_TRACE_FUNCTION();
     RemoveClient(clientID, "requested disconnect", true);
 }
+
+void GameServer::HandleRoomJoin(ClientID clientID, const uint8_t *data, size_t len)
+{
+    NW_TRACE_FUNCTION();
+    if (len < sizeof(MsgRoomJoin))
+        return;
+    auto msg = PacketSerializer::Read<MsgRoomJoin>(data, len);
+
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos || !m_clients.IsWelcomed(index))
+        return;
+
+    MoveToRoom(index, msg.roomID);
+}
+
+void GameServer::HandleRoomLeave(ClientID clientID)
+{
+    NW_TRACE_FUNCTION();
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos || !m_clients.IsWelcomed(index))
+        return;
+
+    MoveToRoom(index, DEFAULT_ROOM_ID);
+}
+
+Room *GameServer::EnsureRoom(RoomID id)
+{
+    auto it = m_rooms.find(id);
+    if (it != m_rooms.end())
+        return it->second.get();
+    if (id == kAllRooms || m_rooms.size() >= std::max<uint32_t>(m_config.maxRooms, 1))
+        return nullptr;
+
+    auto room = std::make_unique<Room>();
+    room->id = id;
+    Room *raw = room.get();
+    m_rooms.emplace(id, std::move(room));
+    return raw;
+}
+
+void GameServer::MoveToRoom(uint32_t index, RoomID roomID)
+{
+    const ClientID clientID = m_clients.ids[index];
+    const RoomID oldRoom = m_clients.roomIDs[index];
+
+    // The reply always names the room the client ends up in.
+    MsgRoomJoin reply;
+    reply.roomID = oldRoom;
+    if (roomID == oldRoom)
+    {
+        SendMessageTo(clientID, reply, 0); // reliable
+        return;
+    }
+    if (!EnsureRoom(roomID))
+    {
+        SendMessageTo(clientID, reply, 0); // reliable
+        SendSystemMessage("Room " + std::to_string(roomID) + " is not available.", clientID);
+        return;
+    }
+
+    // Leave the old room: its members forget this client, and the client
+    // forgets their objects.
+    const NetObjectID objectID = m_clients.objectIDs[index];
+    if (objectID != INVALID_NET_OBJECT_ID)
+    {
+        MsgObjectDespawn despawn;
+        despawn.ownerClientID = clientID;
+        despawn.objectID = objectID;
+        BroadcastMessage(oldRoom, despawn, 0, clientID); // reliable
+    }
+    BroadcastPlayerMetaRemove(clientID);
+    for (uint32_t i = 0; i < m_clients.Size(); ++i)
+    {
+        if (i == index || m_clients.roomIDs[i] != oldRoom ||
+            m_clients.objectIDs[i] == INVALID_NET_OBJECT_ID)
+            continue;
+        MsgObjectDespawn despawn;
+        despawn.ownerClientID = m_clients.ids[i];
+        despawn.objectID = m_clients.objectIDs[i];
+        SendMessageTo(clientID, despawn, 0); // reliable
+    }
+
+    // The object and delta baselines belong to the old room; the client
+    // spawns afresh in the new one.
+    m_clients.objectIDs[index] = INVALID_NET_OBJECT_ID;
+    m_clients.SetFlag(index, ClientTable::HasTransform, false);
+    m_clients.transforms[index] = {};
+    ClientColdState &cold = m_clients.cold[index];
+    cold.releaseFenceUntil = m_receiveTime + kReleaseFenceDuration;
+    cold.ackedTick = 0;
+    for (auto &sent : cold.sentSnapshots)
+        sent.tick = 0;
+    cold.sendPriority.clear();
+    // Others start this client's entity afresh too.
+    const ClientHandle self = m_clients.HandleOf(index);
+    for (ClientColdState &cs : m_clients.cold)
+    {
+        if (self.slot < cs.sendPriority.size())
+            cs.sendPriority[self.slot].value = 0.0f;
+    }
+
+    m_clients.roomIDs[index] = roomID;
+    reply.roomID = roomID;
+    SendMessageTo(clientID, reply, 0); // reliable
+
+    const std::string nickname = cold.nickname;
+    SendPlayerMetaSnapshot(clientID);
+    BroadcastPlayerMetaUpsert(clientID, nickname, false);
+    std::cout << "[GameServer] Client " << clientID << " moved from room "
+              << oldRoom << " to room " << roomID << "\n";
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+/// Bump allocator for memory that only lives for one server tick.
+///
+/// Used as a std::pmr::memory_resource: containers built on it never free
+/// individually, everything is released at once by Reset() at the end of
+/// GameServer::Tick(). Blocks are kept between ticks, and a tick that
+/// spilled into extra blocks makes Reset() merge them into one, so steady
+/// state ticks allocate nothing from the heap.
+class FrameArena final : public std::pmr::memory_resource
+{
+public:
+    explicit FrameArena(size_t initialBytes = 64 * 1024)
+    {
+        AddBlock(initialBytes);
+    }
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /// Release everything allocated this tick. Any container still using
+    /// the arena must already be gone.
+    void Reset()
+    {
+        m_peakBytes = std::max(m_peakBytes, m_frameBytes);
+        if (m_blocks.size() > 1)
+        {
+            size_t total = 0;
+            for (const Block &b : m_blocks)
+                total += b.size;
+            m_blocks.clear();
+            AddBlock(total);
+        }
+        m_current = 0;
+        m_offset = 0;
+        m_frameBytes = 0;
+    }
+
+    /// Bytes handed out since the last Reset().
+    size_t FrameBytes() const { return m_frameBytes; }
+    /// Largest FrameBytes() seen at a Reset().
+    size_t PeakBytes() const { return m_peakBytes; }
+    size_t Capacity() const
+    {
+        size_t total = 0;
+        for (const Block &b : m_blocks)
+            total += b.size;
+        return total;
+    }
+    /// Number of blocks taken from the heap so far (grows only on spikes).
+    uint64_t BlockAllocations() const { return m_blockAllocations; }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0;
+    };
+
+    void AddBlock(size_t size)
+    {
+        m_blocks.push_back(Block{std::make_unique<std::byte[]>(size), size});
+        ++m_blockAllocations;
+    }
+
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        for (;;)
+        {
+            if (m_current < m_blocks.size())
+            {
+                Block &b = m_blocks[m_current];
+                const auto base = reinterpret_cast<uintptr_t>(b.data.get());
+                const uintptr_t aligned =
+                    (base + m_offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+                if (aligned + bytes <= base + b.size)
+                {
+                    m_frameBytes += aligned + bytes - (base + m_offset);
+                    m_offset = aligned + bytes - base;
+                    return reinterpret_cast<void *>(aligned);
+                }
+                // Does not fit: move on to the next retained block.
+                ++m_current;
+                m_offset = 0;
+                continue;
+            }
+            AddBlock(std::max(bytes + alignment, m_blocks.back().size * 2));
+        }
+    }
+
+    void do_deallocate(void *, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::vector<Block> m_blocks;
+    size_t m_current = 0; // block being bumped
+    size_t m_offset = 0;  // bytes used in m_blocks[m_current]
+    size_t m_frameBytes = 0;
+    size_t m_peakBytes = 0;
+    uint64_t m_blockAllocations = 0;
+};
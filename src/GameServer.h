@@ -1,8 +1,21 @@
 #pragma once
 #include "Engine/Network/NetTypes.h"
 #include "Engine/Network/Protocol/PacketSerializer.h"
+#include "BandwidthStats.h"
+#include "ClientTable.h"
+#include "FrameArena.h"
+#include "LiveStats.h"
+#include "NetTransport.h"
+#include "Room.h"
+#include "ServerConfig.h"
+#include "TickProfiler.h"
+#include "UdpDriver.h"
+#include "WorkerPool.h"
 
+#include <array>
 #include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -17,7 +30,7 @@
 class GameServer
 {
 public:
-    GameServer() = default;
+    explicit GameServer(const ServerConfig &config = {});
     ~GameServer();
 
     /// Start listening on the given port.
@@ -32,11 +45,37 @@ public:
 
     bool IsRunning() const { return m_running; }
 
+    /// No client is in gameplay (none has reported a transform), so there
+    /// is nothing to broadcast. Always false with idle mode disabled.
+    bool IsIdle() const;
+    /// Idle servers: sleep until network traffic arrives or the idle wake
+    /// interval passes, then Tick() once. Returns true on traffic.
+    bool WaitForTraffic();
+    /// Relay mode: handle traffic as it arrives until shortly before
+    /// `nextTick`, forwarding position updates of small rooms to their
+    /// peers right away. Returns at once when relay mode is off.
+    void RelayUntil(std::chrono::steady_clock::time_point nextTick);
+
+    /// Current load-shedding level picked by the tick watchdog.
+    LoadLevel CurrentLoadLevel() const { return m_watchdog.Level(); }
+    const TickWatchdog &Watchdog() const { return m_watchdog; }
+    /// Log tick load and shedding counters, then start a new window.
+    void LogLoadReport();
+    /// Log per-phase and per-handler latency percentiles for the window
+    /// since the last call (the whole run is logged again on Stop()).
+    void LogTickProfile();
+    /// Log traffic over the rolling bandwidth window: totals, the
+    /// heaviest message types each way and the top talking clients.
+    void LogBandwidthReport();
+    const BandwidthStats &Bandwidth() const { return m_bandwidth; }
+
 private:
     // ── Internal helpers ───────────────────────────────────────────
-    void HandleNewConnection();
-    void HandleClientDisconnected();
-    void HandleClientMessage();
+    /// Drain and dispatch every network event received so far.
+    void PollNetworkEvents();
+    void HandleNewConnection(uint32_t conn);
+    void HandleClientDisconnected(uint32_t conn);
+    void HandleClientMessage(const NetEvent &event);
 
     void DispatchPacket(ClientID clientID, const uint8_t *data, size_t len);
     void HandleClientHello(ClientID clientID, const uint8_t *data, size_t len);
@@ -44,26 +83,124 @@ private:
     void HandleObjectRelease(ClientID clientID, const uint8_t *data, size_t len);
     void HandleHeartbeat(ClientID clientID, const uint8_t *data, size_t len);
     void HandleClientDisconnect(ClientID clientID);
+    void HandleSnapshotAck(ClientID clientID, const uint8_t *data, size_t len);
+    void HandleRoomJoin(ClientID clientID, const uint8_t *data, size_t len);
+    void HandleRoomLeave(ClientID clientID);
+    void HandleSnapshotRate(ClientID clientID, const uint8_t *data, size_t len);
     void HandleChatRequest(ClientID clientID, const uint8_t *data, size_t len);
     void HandleNicknameUpdateRequest(ClientID clientID, const uint8_t *data, size_t len);
 
     void SendWelcome(ClientID clientID);
-    void SendObjectDespawn(ClientID toClientID, ClientID ownerClientID, NetObjectID objectID);
+    /// Deferred to the next tick while shedding non-critical work.
     void SendPlayerMetaSnapshot(ClientID clientID);
+    void SendPlayerMetaSnapshotNow(ClientID clientID);
     void BroadcastPlayerMetaUpsert(ClientID subjectClientID, const std::string &nickname,
                                    bool includeSubject = true);
     void BroadcastPlayerMetaRemove(ClientID removedClientID);
     void SendTo(ClientID clientID, const uint8_t *data, size_t len, uint8_t channel);
+    /// Send one payload to many connections; nbnet stores it once (refcounted).
+    void SendToMany(const uint32_t *connHandles, size_t count,
+                    const uint8_t *data, size_t len, uint8_t channel);
+    /// BroadcastTo target meaning every room.
+    static constexpr RoomID kAllRooms = UINT32_MAX;
+    /// SendToMany to every welcomed client in `room` except `exclude`.
+    void BroadcastTo(RoomID room, const uint8_t *data, size_t len, uint8_t channel,
+                     ClientID exclude = INVALID_CLIENT_ID);
+    /// Serialize a fixed-size message on the stack, then SendTo / BroadcastTo.
+    template <typename Msg>
+    void SendMessageTo(ClientID clientID, const Msg &msg, uint8_t channel)
+    {
+        uint8_t buf[sizeof(Msg)];
+        SendTo(clientID, buf, PacketSerializer::WriteTo(buf, sizeof(buf), msg), channel);
+    }
+    template <typename Msg>
+    void BroadcastMessage(RoomID room, const Msg &msg, uint8_t channel,
+                          ClientID exclude = INVALID_CLIENT_ID)
+    {
+        uint8_t buf[sizeof(Msg)];
+        BroadcastTo(room, buf, PacketSerializer::WriteTo(buf, sizeof(buf), msg), channel,
+                    exclude);
+    }
+    void FlushReliableBundles();
     void RemoveClient(ClientID clientID, const char *reason, bool closeTransport = false);
+    /// Tick-scoped containers, allocated from m_frameArena.
+    using FrameBytes = std::pmr::vector<uint8_t>;
+    using FrameChunks = std::pmr::vector<FrameBytes>;
+
+    /// Room `id`, created on first use; nullptr when maxRooms is reached.
+    Room *EnsureRoom(RoomID id);
+    /// Move the client at dense `index` into `room` and re-sync it.
+    void MoveToRoom(uint32_t index, RoomID room);
+
+    /// Per-tick broadcast settings shared by every room and encode job.
+    struct BroadcastPlan
+    {
+        bool delta = false;
+        float radius = 0.0f; // effective AOI radius (0 = off)
+        bool thinFar = false;
+        float farDistance = 0.0f;
+        size_t maxEntries = 0; // per-receiver entry budget (0 = unlimited)
+    };
+    /// One receiver whose position packet is encoded on its own. `full`
+    /// is set when it turns out to see the whole room after all.
+    struct EncodeJob
+    {
+        Room *room;
+        uint32_t receiver;
+        bool full;
+    };
+
     void BroadcastPositions();
+    BroadcastPlan MakeBroadcastPlan() const;
+    /// Snapshot one room and sort its due members into whole-room copy or
+    /// per-receiver jobs. Runs on a worker thread, one room per call.
+    void PrepareRoomBroadcast(Room &room, const BroadcastPlan &plan);
+    /// Encode one receiver's packet against its room's snapshot. Runs on
+    /// a worker thread; writes only the receiver's cold state and `ws`.
+    void EncodeForReceiver(EncodeJob &job, const BroadcastPlan &plan, EncodeWorkspace &ws);
+    /// Encode the room once for every receiver sharing the whole-room copy.
+    void EncodeRoomFull(Room &room);
+    /// Relay mode: send the positions updated since the last relay to the
+    /// peers of each small room, then flush the transport.
+    void FlushRelay();
+    void EncodePositions(const NetBroadcastEntry *entries, size_t count,
+                         FrameChunks &out);
+    size_t MaxEntriesForBudget(uint32_t budgetBytes) const;
+    /// maxBroadcastPayload for the broadcast format in use; 0 (never
+    /// split) for raw broadcasts, which carry no chunk index.
+    size_t BroadcastChunkPayload() const;
+    /// Entries of `entryBits` each that fit in `budgetBytes` once split at
+    /// `maxPayload`, every packet carrying an `overhead`-byte header.
+    size_t EntriesWithinBudget(uint32_t budgetBytes, size_t overhead, size_t entryBits,
+                               size_t maxPayload) const;
+    /// Ticks between position broadcasts for a client asking for
+    /// `snapshotsPerSecond` (0 = the configured default).
+    uint8_t SendIntervalFor(uint32_t snapshotsPerSecond) const;
+    void EncodeDeltaFor(const Room &room, uint32_t receiver, const uint32_t *indices,
+                        size_t count, EncodeWorkspace &ws, FrameChunks &out);
+    void SelectByPriority(uint32_t receiver, const Room &room,
+                          std::vector<uint32_t> &candidates, size_t maxEntries);
     void RemoveTimedOutClients();
 
+    // ── Load shedding ───────────────────────────────────────────
+    /// Keep a copy of a non-critical packet for the next tick when the
+    /// watchdog says so. Returns true if it was deferred.
+    bool DeferIfShedding(ClientID clientID, const uint8_t *data, size_t len);
+    /// Run the work deferred by the previous tick.
+    void RunDeferredWork();
+    void OnLoadLevelChanged();
+    /// Rewrite the live stats segment at the end of a tick.
+    void PublishLiveStats(std::chrono::steady_clock::duration tickWork);
+    /// Re-rank the top talkers copied into every live stats snapshot.
+    void RefreshLiveTopClients();
+
     // ── Chat helpers ────────────────────────────────────────────
-    void BroadcastChat(ChatMessageType chatType, ClientID senderID,
+    void BroadcastChat(RoomID room, ChatMessageType chatType, ClientID senderID,
                        const std::string &senderName, const std::string &text);
     void SendChatTo(ClientID targetID, ChatMessageType chatType, ClientID senderID,
                     const std::string &senderName, const std::string &text);
-    /// Send a system message to a specific client or all clients (targetID=0 for all).
+    /// Send a system message to a specific client or all clients in every
+    /// room (targetID=0 for all).
     void SendSystemMessage(const std::string &text, ClientID targetID = INVALID_CLIENT_ID);
     void SendNicknameUpdateResult(ClientID clientID, NicknameUpdateStatus status,
                                   const std::string &nickname);
@@ -72,34 +209,27 @@ private:
     static bool IsValidNickname(const std::string &nickname);
 
     // ── Data ───────────────────────────────────────────────────────
+    ServerConfig m_config;
+    NetQuantizationParams m_quant; // derived from m_config for the compact format
     bool m_running = false;
+    /// All nbnet traffic after start-up (inline or on the I/O thread).
+    NetTransport m_transport;
+    /// Arrival time of the message being dispatched: the keep-alive,
+    /// release-fence and chat rate-limit stamp. Deferred packets restore it.
+    std::chrono::steady_clock::time_point m_receiveTime{};
     ClientID m_nextClientID = 1; // 0 is INVALID
 
-    /// Per-client state stored on the server.
-    struct ClientState
-    {
-        ClientID id = INVALID_CLIENT_ID;
-        uint32_t connHandle = 0; // NBN_ConnectionHandle
-        NetUUID uuid{};          // persistent client identity
-
-        NetObjectID objectID = INVALID_NET_OBJECT_ID;
-        NetTransformState lastTransform{};
-        bool hasTransform = false;
-        bool welcomed = false;
-        std::string nickname;
-        ClientID whisperTargetID = INVALID_CLIENT_ID;
-        std::string whisperTargetNickname;
-        // ObjectRelease arrived; ignore late unreliable PositionUpdate briefly.
-        std::chrono::steady_clock::time_point releaseFenceUntil{};
-        std::chrono::steady_clock::time_point lastSeen = std::chrono::steady_clock::now();
-        std::chrono::steady_clock::time_point lastChatTime{}; // rate limit
-    };
+    /// Queue a reliable message into the bundle of client `index` (dense).
+    void QueueReliable(uint32_t index, const uint8_t *data, size_t len);
 
-    /// ClientID → state
-    std::unordered_map<ClientID, ClientState> m_clients;
+    /// Per-client state stored on the server (dense, slot-mapped by ClientID).
+    ClientTable m_clients;
 
-    /// NBN_ConnectionHandle → ClientID   (reverse index for event dispatch)
-    std::unordered_map<uint32_t, ClientID> m_connIndex;
+    /// NBN_ConnectionHandle → client   (reverse index for event dispatch).
+    /// A handle, so re-keying a returning player needs no update here.
+    std::unordered_map<uint32_t, ClientHandle> m_connIndex;
+    /// ClientID behind `connHandle`, or INVALID_CLIENT_ID.
+    ClientID ClientOfConn(uint32_t connHandle) const;
 
     /// NetUUID → ClientID   (persistent identity mapping)
     std::unordered_map<NetUUID, ClientID, NetUUIDHash> m_uuidIndex;
@@ -109,4 +239,56 @@ private:
     // Application-level timeout for stale clients / objects.
     std::chrono::milliseconds m_clientTimeout{5000}; // 5s
     uint32_t m_serverTick = 0;
+
+    /// Live rooms. The default room always exists; others are created on
+    /// first join and dropped once empty.
+    std::unordered_map<RoomID, std::unique_ptr<Room>> m_rooms;
+    std::vector<Room *> m_tickRooms; // rooms broadcasting this tick (scratch)
+    std::vector<EncodeJob> m_encodeJobs; // this tick's per-receiver encodes (scratch)
+    /// Runs room preparation and per-receiver encoding in parallel.
+    WorkerPool m_workers;
+    std::vector<std::unique_ptr<EncodeWorkspace>> m_workspaces; // one per pool slot
+
+    std::vector<uint32_t> m_broadcastHandles; // scratch
+    /// Relay mode: clients whose position changed since the last relay or
+    /// tick broadcast (may hold duplicates).
+    std::vector<ClientHandle> m_relayPending;
+    /// Relays sent since the last tick broadcast; orders PositionRelay
+    /// packets after it.
+    uint16_t m_relaySeq = 0;
+
+    /// Tick duration against the budget; picks the load-shedding level.
+    TickWatchdog m_watchdog;
+    /// Latency histograms of tick phases and message handlers.
+    TickProfiler m_profiler;
+    /// Shared-memory counters for nw-top (--live-stats).
+    LiveStatsPublisher m_liveStats;
+    /// Top talkers for the live stats segment, refreshed once a second.
+    std::array<LiveStats::ClientTraffic, LiveStats::kTopClients> m_liveTopClients{};
+    uint32_t m_liveTopClientCount = 0;
+    std::vector<BandwidthStats::ClientUsage> m_bandwidthScratch;
+    /// Messages and bytes per message type and per client.
+    BandwidthStats m_bandwidth;
+    /// Packets and metadata snapshots put off to the next tick. Storage is
+    /// kept between ticks.
+    struct DeferredPacket
+    {
+        ClientID clientID;
+        uint32_t offset;
+        uint32_t len;
+        std::chrono::steady_clock::time_point received; // restored as m_receiveTime
+    };
+    std::vector<DeferredPacket> m_deferredPackets;
+    std::vector<uint8_t> m_deferredBytes;
+    std::vector<ClientID> m_deferredMetaSnapshots;
+    uint64_t m_windowDeferred = 0;       // deferred items this report window
+    uint64_t m_rejectedAtLastReport = 0; // transport counter at the last report
+    UdpDriver::Stats m_udpAtLastReport;  // sharded UDP driver totals at the last report
+
+    /// Transient per-tick memory, reset at the end of Tick().
+    FrameArena m_frameArena;
+    /// NW_COUNT_ALLOCATIONS builds: heap allocations over the current
+    /// report window, logged periodically by Tick().
+    uint64_t m_windowAllocations = 0;
+    uint64_t m_windowMaxTickAllocations = 0;
 };
@@ -0,0 +1,92 @@
+#pragma once
+#include "Engine/Network/Protocol/Messages.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/// Uniform-grid spatial hash used for area-of-interest queries.
+///
+/// Rebuilt from scratch every tick: entries are bucketed by cell key and
+/// sorted, so a query is a handful of binary searches over the 27 cells
+/// around the query point. Storage is reused between ticks.
+class InterestGrid
+{
+public:
+    /// Bucket `count` entries into cells of `cellSize` world units.
+    /// Indices reported by QueryRadius refer to positions in `entries`.
+    void Build(const NetBroadcastEntry *entries, size_t count, float cellSize)
+    {
+        m_cellSize = cellSize > 0.0f ? cellSize : 1.0f;
+        m_cells.clear();
+        m_positions.clear();
+        m_cells.reserve(count);
+        m_positions.reserve(count);
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(count); ++i)
+        {
+            const NetTransformState &t = entries[i].transform;
+            m_positions.push_back({t.posX, t.posY, t.posZ});
+            m_cells.emplace_back(CellKey(CellCoord(t.posX), CellCoord(t.posY), CellCoord(t.posZ)), i);
+        }
+        std::sort(m_cells.begin(), m_cells.end());
+    }
+
+    /// Invoke `fn(index)` for every entry within `radius` of (x, y, z).
+    /// `radius` should not exceed the cell size used in Build().
+    template <typename Fn>
+    void QueryRadius(float x, float y, float z, float radius, Fn &&fn) const
+    {
+        const float radiusSq = radius * radius;
+        const int32_t cx = CellCoord(x);
+        const int32_t cy = CellCoord(y);
+        const int32_t cz = CellCoord(z);
+
+        for (int32_t dx = -1; dx <= 1; ++dx)
+            for (int32_t dy = -1; dy <= 1; ++dy)
+                for (int32_t dz = -1; dz <= 1; ++dz)
+                {
+                    const uint64_t key = CellKey(cx + dx, cy + dy, cz + dz);
+                    auto it = std::lower_bound(
+                        m_cells.begin(), m_cells.end(), key,
+                        [](const std::pair<uint64_t, uint32_t> &cell, uint64_t k)
+                        { return cell.first < k; });
+
+                    for (; it != m_cells.end() && it->first == key; ++it)
+                    {
+                        const Position &p = m_positions[it->second];
+                        const float ox = p.x - x;
+                        const float oy = p.y - y;
+                        const float oz = p.z - z;
+                        if (ox * ox + oy * oy + oz * oz <= radiusSq)
+                            fn(it->second);
+                    }
+                }
+    }
+
+private:
+    struct Position
+    {
+        float x, y, z;
+    };
+
+    int32_t CellCoord(float v) const
+    {
+        return static_cast<int32_t>(std::floor(v / m_cellSize));
+    }
+
+    /// Pack three signed 21-bit cell coordinates into one key.
+    static uint64_t CellKey(int32_t cx, int32_t cy, int32_t cz)
+    {
+        constexpr uint64_t kMask = (1u << 21) - 1;
+        return ((static_cast<uint64_t>(cx) & kMask) << 42) |
+               ((static_cast<uint64_t>(cy) & kMask) << 21) |
+               (static_cast<uint64_t>(cz) & kMask);
+    }
+
+    float m_cellSize = 1.0f;
+    std::vector<std::pair<uint64_t, uint32_t>> m_cells; // (cell key, entry index)
+    std::vector<Position> m_positions;
+};
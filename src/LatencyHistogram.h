@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// Fixed-size log-linear latency histogram in the spirit of HdrHistogram.
+///
+/// Values (nanoseconds) below 2^kSubBits land in exact buckets; above
+/// that every power of two is split into 2^kSubBits linear sub-buckets,
+/// so a percentile is never off by more than ~3%. Recording is a couple
+/// of shifts and one increment; nothing allocates after construction.
+class LatencyHistogram
+{
+public:
+    static constexpr uint32_t kSubBits = 5;
+    static constexpr uint32_t kSubBuckets = 1u << kSubBits;
+    static constexpr uint32_t kMaxBits = 40; // ~18 minutes in ns, clamps above
+    static constexpr uint32_t kBucketCount = (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+    LatencyHistogram() : m_counts(new uint64_t[kBucketCount]()) {}
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    void Record(uint64_t value)
+    {
+        value = std::min<uint64_t>(value, (uint64_t{1} << kMaxBits) - 1);
+        ++m_counts[BucketOf(value)];
+        ++m_count;
+        m_max = std::max(m_max, value);
+    }
+
+    uint64_t Count() const { return m_count; }
+    uint64_t Max() const { return m_max; }
+
+    /// Smallest value at or below which `quantile` (0..1) of the samples
+    /// fall, reported as the top of its bucket (and never above Max()).
+    uint64_t Percentile(double quantile) const
+    {
+        if (m_count == 0)
+            return 0;
+        const auto rank = std::max<uint64_t>(
+            static_cast<uint64_t>(quantile * static_cast<double>(m_count) + 0.5), 1);
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < kBucketCount; ++i)
+        {
+            seen += m_counts[i];
+            if (seen >= rank)
+                return std::min(BucketTop(i), m_max);
+        }
+        return m_max;
+    }
+
+    /// Add another histogram's samples to this one.
+    void Merge(const LatencyHistogram &other)
+    {
+        MergeBuckets(other.m_counts.get(), other.m_max);
+    }
+
+    /// The kBucketCount raw bucket counts, e.g. to ship the histogram to
+    /// another process.
+    const uint64_t *Buckets() const { return m_counts.get(); }
+    /// Add samples exported with Buckets() (and that histogram's Max()).
+    void MergeBuckets(const uint64_t *buckets, uint64_t max)
+    {
+        for (uint32_t i = 0; i < kBucketCount; ++i)
+        {
+            m_counts[i] += buckets[i];
+            m_count += buckets[i];
+        }
+        m_max = std::max(m_max, max);
+    }
+
+    void Reset()
+    {
+        std::memset(m_counts.get(), 0, kBucketCount * sizeof(uint64_t));
+        m_count = 0;
+        m_max = 0;
+    }
+
+private:
+    static uint32_t BucketOf(uint64_t value)
+    {
+        if (value < kSubBuckets)
+            return static_cast<uint32_t>(value);
+#if defined(_MSC_VER)
+        unsigned long top;
+        _BitScanReverse64(&top, value);
+#else
+        const uint32_t top = 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+        const uint32_t shift = top - kSubBits;
+        const auto sub = static_cast<uint32_t>(value >> shift) & (kSubBuckets - 1);
+        return (shift + 1) * kSubBuckets + sub;
+    }
+
+    static uint64_t BucketTop(uint32_t bucket)
+    {
+        if (bucket < kSubBuckets)
+            return bucket;
+        const uint32_t shift = bucket / kSubBuckets - 1;
+        const uint64_t sub = bucket % kSubBuckets;
+        return ((kSubBuckets + sub + 1) << shift) - 1;
+    }
+
+    std::unique_ptr<uint64_t[]> m_counts;
+    uint64_t m_count = 0;
+    uint64_t m_max = 0;
+};
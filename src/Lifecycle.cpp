@@ -12,9 +12,34 @@ extern "C"
 }
 
 #include "GameServer.h"
+#include "AllocCounter.h"
+#include "Tracer.h"
+#include "UdpDriver.h"
+
+#include <algorithm>
+#include <cstdio>
 
 static constexpr const char *NW_PROTOCOL_NAME = "neural_wings";
 
+// NW_COUNT_ALLOCATIONS builds log heap allocations every this many ticks.
+static constexpr uint32_t ALLOC_REPORT_INTERVAL = 300; // ~10 s at 30 Hz
+
+// Message types per direction and clients listed by LogBandwidthReport().
+static constexpr size_t kBandwidthReportRows = 5;
+
+// Relay mode hands control back to the tick scheduler this long before
+// the next tick, leaving it its final approach to the deadline.
+static constexpr std::chrono::microseconds kRelayTickMargin{500};
+
+GameServer::GameServer(const ServerConfig &config)
+    : m_config(config),
+      m_watchdog(config.tickRate, config.maxLoadLevel)
+{
+    m_quant.worldBound = m_config.worldBound;
+    m_quant.positionBits =
+        NetQuantization::BitsForRange(m_config.worldBound, m_config.positionPrecision);
+}
+
 GameServer::~GameServer()
 {
     Stop();
@@ -29,7 +54,12 @@ bool GameServer::Start(uint16_t port)
     static bool s_driverRegistered = false;
     if (!s_driverRegistered)
     {
-        NBN_UDP_Register();
+        const bool customUdp = m_config.udpReceiveShards > 0 || m_config.udpBatch;
+        UdpDriver::Config udpConfig;
+        udpConfig.receiveShards = std::max<uint32_t>(m_config.udpReceiveShards, 1);
+        udpConfig.batched = m_config.udpBatch;
+        if (!customUdp || !UdpDriver::Register(udpConfig))
+            NBN_UDP_Register();
 #if defined(NW_ENABLE_WEBRTC_C)
         NBN_WebRTC_C_Config wrtcCfg{};
         wrtcCfg.enable_tls = false;
@@ -51,10 +81,41 @@ bool GameServer::Start(uint16_t port)
         return false;
     }
 
+    if (m_config.liveStats && m_liveStats.Open(port))
+        m_transport.SetTrackReliableBacklog(true);
+    m_transport.Start(m_config.ioThread, port);
+    m_workers.Start(m_config.workerThreads);
+    m_workspaces.clear();
+    for (uint32_t s = 0; s < m_workers.SlotCount(); ++s)
+        m_workspaces.push_back(std::make_unique<EncodeWorkspace>());
+    m_rooms.clear();
+    EnsureRoom(DEFAULT_ROOM_ID);
+    m_watchdog = TickWatchdog(m_config.tickRate, m_config.maxLoadLevel);
+    m_bandwidth = BandwidthStats();
+    m_liveTopClientCount = 0;
+    m_transport.SetAcceptingConnections(true);
     m_running = true;
     m_serverTick = 0;
     std::cout << "[GameServer] Started on port " << port
-              << " (client timeout " << m_clientTimeout.count() << " ms)\n";
+              << " (client timeout " << m_clientTimeout.count() << " ms";
+    if (SendIntervalFor(0) > 1)
+        std::cout << ", positions every " << static_cast<int>(SendIntervalFor(0)) << " ticks";
+    if (m_config.interestRadius > 0.0f)
+        std::cout << ", AOI radius " << m_config.interestRadius;
+    if (m_config.clientByteBudget > 0)
+        std::cout << ", budget " << m_config.clientByteBudget << " B/client/broadcast";
+    if (m_config.broadcastFormat != BroadcastFormat::Raw)
+        std::cout << (m_config.broadcastFormat == BroadcastFormat::Delta ? ", delta" : ", compact")
+                  << " broadcast " << static_cast<int>(m_quant.positionBits)
+                  << "-bit positions";
+    if (m_config.relayWindow.count() > 0)
+        std::cout << ", relay window " << m_config.relayWindow.count() << " us (rooms up to "
+                  << m_config.relayMaxRoomSize << ")";
+    if (m_transport.IsThreaded())
+        std::cout << ", I/O thread";
+    if (m_workers.ThreadCount() > 0)
+        std::cout << ", " << m_workers.ThreadCount() << " encode workers";
+    std::cout << ")\n";
     return true;
 }
 
@@ -65,52 +126,357 @@ void GameServer::Stop()
 
     m_running = false;
 
+    // Joins the I/O thread after it has flushed everything queued.
+    m_transport.Stop();
     NBN_GameServer_Stop();
+    m_workers.Stop();
 
     m_connIndex.clear();
     m_nicknameIndex.clear();
-    m_clients.clear();
+    m_clients.Clear();
+    m_rooms.clear();
+    m_profiler.ReportTotals();
+    m_liveStats.Close();
     std::cout << "[GameServer] Stopped\n";
 }
 
-void GameServer::Tick()
+bool GameServer::IsIdle() const
 {
-    if (!m_running)
+    if (m_config.idleWakeInterval.count() <= 0)
+        return false;
+    for (uint32_t i = 0; i < m_clients.Size(); ++i)
+    {
+        if (m_clients.HasTransformAt(i))
+            return false;
+    }
+    return true;
+}
+
+bool GameServer::WaitForTraffic()
+{
+    return m_transport.WaitForTraffic(m_config.idleWakeInterval);
+}
+
+void GameServer::RelayUntil(std::chrono::steady_clock::time_point nextTick)
+{
+    if (!m_running || m_config.relayWindow.count() <= 0)
         return;
-    ++m_serverTick;
 
-    // 1. Poll all network events
-    int ev;
-    while ((ev = NBN_GameServer_Poll()) != NBN_NO_EVENT)
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point stopAt = nextTick - kRelayTickMargin;
+    Clock::time_point batchDue = Clock::time_point::max();
+    for (Clock::time_point now = Clock::now(); now < stopAt; now = Clock::now())
     {
-        if (ev < 0)
+        const Clock::time_point wakeAt = std::min(stopAt, batchDue);
+        if (wakeAt > now)
+            m_transport.WaitForTraffic(wakeAt - now);
+
+        // The first update of a batch opens the window; later ones ride
+        // along until it closes.
+        const bool hadPending = !m_relayPending.empty();
+        PollNetworkEvents();
+        if (!hadPending && !m_relayPending.empty())
+            batchDue = Clock::now() + m_config.relayWindow;
+
+        if (!m_relayPending.empty() && Clock::now() >= batchDue)
         {
-            std::cerr << "[GameServer] Poll error\n";
-            break;
+            FlushRelay();
+            batchDue = Clock::time_point::max();
         }
+    }
+    if (!m_relayPending.empty())
+        FlushRelay();
+}
 
-        switch (ev)
+void GameServer::PollNetworkEvents()
+{
+    NetEvent ev;
+    while (m_transport.NextEvent(ev))
+    {
+        switch (ev.type)
         {
-        case NBN_NEW_CONNECTION:
-            HandleNewConnection();
+        case NetEvent::Connected:
+            HandleNewConnection(ev.connHandle);
             break;
-        case NBN_CLIENT_DISCONNECTED:
-            HandleClientDisconnected();
+        case NetEvent::Disconnected:
+            HandleClientDisconnected(ev.connHandle);
             break;
-        case NBN_CLIENT_MESSAGE_RECEIVED:
-            HandleClientMessage();
+        case NetEvent::Message:
+            HandleClientMessage(ev);
             break;
         }
     }
+}
+
+void GameServer::Tick()
+{
+    if (!m_running)
+        return;
+    ++m_serverTick;
+    using Clock = TickProfiler::Clock;
+    const auto tickStart = Clock::now();
+    const uint64_t allocsBefore = AllocCounter::Count();
+
+    // Time each phase into its own histogram.
+    Clock::time_point phaseStart = tickStart;
+    auto endPhase = [&](TickPhase phase)
+    {
+        const Clock::time_point now = Clock::now();
+        m_profiler.RecordPhase(phase, now - phaseStart);
+        if (Tracer::Recording())
+            Tracer::Record(TickProfiler::PhaseName(phase), phaseStart, now);
+        phaseStart = now;
+    };
+
+    // 0. Work put off by the previous tick while shedding load
+    RunDeferredWork();
+    endPhase(TickPhase::Deferred);
+
+    // 1. Drain all network events received since the last tick
+    PollNetworkEvents();
+    endPhase(TickPhase::Poll);
 
     RemoveTimedOutClients();
+    endPhase(TickPhase::Timeouts);
 
     // 2. Broadcast game state
     BroadcastPositions();
+    endPhase(TickPhase::Broadcast);
 
     // 3. Flush outgoing packets to all clients
-    if (NBN_GameServer_SendPackets() < 0)
+    FlushReliableBundles();
+    m_transport.Flush();
+    endPhase(TickPhase::Flush);
+
+    // 4. Drop this tick's transient memory
+    m_frameArena.Reset();
+
+    // 5. Adapt to how much of the tick budget this took
+    const Clock::time_point tickEnd = Clock::now();
+    const Clock::duration tickWork = tickEnd - tickStart;
+    m_profiler.RecordPhase(TickPhase::Tick, tickWork);
+    if (Tracer::Recording())
+        Tracer::Record(TickProfiler::PhaseName(TickPhase::Tick), tickStart, tickEnd);
+    if (m_bandwidth.AdvanceTo(tickEnd) && m_liveStats.IsOpen())
+        RefreshLiveTopClients();
+    if (m_watchdog.RecordTick(tickWork))
+        OnLoadLevelChanged();
+
+    if (m_liveStats.IsOpen())
+        PublishLiveStats(tickWork);
+
+    if (AllocCounter::Enabled)
     {
-        std::cerr << "[GameServer] SendPackets failed\n";
+        const uint64_t tickAllocs = AllocCounter::Count() - allocsBefore;
+        m_windowAllocations += tickAllocs;
+        m_windowMaxTickAllocations = std::max(m_windowMaxTickAllocations, tickAllocs);
+        if (m_serverTick % ALLOC_REPORT_INTERVAL == 0)
+        {
+            std::cout << "[GameServer] Heap allocations: " << m_windowAllocations
+                      << " in last " << ALLOC_REPORT_INTERVAL << " ticks (max "
+                      << m_windowMaxTickAllocations << "/tick), frame arena peak "
+                      << m_frameArena.PeakBytes() << " B in "
+                      << m_frameArena.BlockAllocations() << " block allocations\n";
+            m_windowAllocations = 0;
+            m_windowMaxTickAllocations = 0;
+        }
     }
 }
+
+// ── Load shedding ───────────────────────────────────────────────────
+
+bool GameServer::DeferIfShedding(ClientID clientID, const uint8_t *data, size_t len)
+{
+    if (!m_watchdog.AtLeast(LoadLevel::DeferNonCritical))
+        return false;
+
+    DeferredPacket p;
+    p.clientID = clientID;
+    p.offset = static_cast<uint32_t>(m_deferredBytes.size());
+    p.len = static_cast<uint32_t>(len);
+    p.received = m_receiveTime;
+    m_deferredBytes.insert(m_deferredBytes.end(), data, data + len);
+    m_deferredPackets.push_back(p);
+    ++m_windowDeferred;
+    return true;
+}
+
+void GameServer::RunDeferredWork()
+{
+    // Handlers look the client up again, so anyone who left meanwhile is
+    // skipped. Nothing here defers again: each item waits one tick at most.
+    for (const DeferredPacket &p : m_deferredPackets)
+    {
+        const uint8_t *data = m_deferredBytes.data() + p.offset;
+        m_receiveTime = p.received;
+        if (PacketSerializer::PeekType(data, p.len) == NetMessageType::ChatRequest)
+            HandleChatRequest(p.clientID, data, p.len);
+        else
+            HandleNicknameUpdateRequest(p.clientID, data, p.len);
+    }
+    m_deferredPackets.clear();
+    m_deferredBytes.clear();
+
+    for (ClientID id : m_deferredMetaSnapshots)
+        SendPlayerMetaSnapshotNow(id);
+    m_deferredMetaSnapshots.clear();
+}
+
+void GameServer::OnLoadLevelChanged()
+{
+    const LoadLevel level = m_watchdog.Level();
+    std::cout << "[GameServer] Tick load " << static_cast<int>(m_watchdog.LastLoad() * 100.0f)
+              << "% of budget, load level " << static_cast<int>(level) << " ("
+              << TickWatchdog::LevelName(level) << ")\n";
+    m_transport.SetAcceptingConnections(level < LoadLevel::RejectConnections);
+}
+
+void GameServer::PublishLiveStats(std::chrono::steady_clock::duration tickWork)
+{
+    using std::chrono::duration_cast;
+    uint32_t welcomed = 0;
+    for (uint32_t i = 0; i < m_clients.Size(); ++i)
+        welcomed += m_clients.IsWelcomed(i) ? 1u : 0u;
+
+    LiveStats::Snapshot &s = m_liveStats.BeginUpdate();
+    s.serverTick = m_serverTick;
+    s.publishedUnixMs = static_cast<uint64_t>(duration_cast<std::chrono::milliseconds>(
+                                                  std::chrono::system_clock::now().time_since_epoch())
+                                                  .count());
+    s.tickRate = m_config.tickRate;
+    s.clients = m_clients.Size();
+    s.welcomedClients = welcomed;
+    s.rooms = static_cast<uint32_t>(m_rooms.size());
+    s.loadLevel = static_cast<uint32_t>(m_watchdog.Level());
+    s.loadPermille = static_cast<uint32_t>(m_watchdog.LastLoad() * 1000.0f);
+    s.lastTickNs = static_cast<uint64_t>(duration_cast<std::chrono::nanoseconds>(tickWork).count());
+    s.maxTickNs = static_cast<uint64_t>(
+        duration_cast<std::chrono::nanoseconds>(m_watchdog.WindowStats().maxWork).count());
+    s.reliableBacklog = m_transport.ReliableBacklog();
+    s.reliableBacklogMax = m_transport.ReliableBacklogMax();
+    const NetTransport::TrafficTable &in = m_transport.TrafficIn();
+    const NetTransport::TrafficTable &out = m_transport.TrafficOut();
+    for (uint32_t t = 0; t < LiveStats::kMessageTypes; ++t)
+    {
+        s.in[t] = LiveStats::Traffic{in[t].packets, in[t].bytes};
+        s.out[t] = LiveStats::Traffic{out[t].packets, out[t].bytes};
+    }
+    s.topClientCount = m_liveTopClientCount;
+    std::copy(m_liveTopClients.begin(), m_liveTopClients.end(), s.topClients);
+    m_liveStats.EndUpdate();
+}
+
+void GameServer::RefreshLiveTopClients()
+{
+    m_bandwidth.TopClients(BandwidthStats::Out, true, LiveStats::kTopClients, m_bandwidthScratch);
+    m_liveTopClientCount = 0;
+    for (const BandwidthStats::ClientUsage &c : m_bandwidthScratch)
+    {
+        LiveStats::ClientTraffic &t = m_liveTopClients[m_liveTopClientCount++];
+        t.clientID = ClientOfConn(c.connHandle);
+        t.windowSeconds = m_bandwidth.WindowSeconds();
+        t.bytesIn = c.window[BandwidthStats::In].bytes;
+        t.bytesOut = c.window[BandwidthStats::Out].bytes;
+        t.messagesIn = c.window[BandwidthStats::In].messages;
+        t.messagesOut = c.window[BandwidthStats::Out].messages;
+    }
+}
+
+void GameServer::LogTickProfile()
+{
+    m_profiler.Report();
+}
+
+void GameServer::LogBandwidthReport()
+{
+    const uint32_t seconds = m_bandwidth.WindowSeconds();
+    if (seconds == 0)
+        return;
+    const double perSecond = 1.0 / seconds;
+    char line[160];
+
+    std::cout << "[GameServer] Bandwidth over the last " << seconds
+              << " s (message payloads, per second):\n";
+    std::vector<BandwidthStats::TypeUsage> types;
+    for (BandwidthStats::Direction dir : {BandwidthStats::In, BandwidthStats::Out})
+    {
+        const char *arrow = dir == BandwidthStats::In ? "in " : "out";
+        const BandwidthStats::Counter all = m_bandwidth.WindowTotal(dir);
+        std::snprintf(line, sizeof(line), "[GameServer]   %s %-24s %10.1f msg %12.0f B\n", arrow, "all",
+                      all.messages * perSecond, all.bytes * perSecond);
+        std::cout << line;
+
+        m_bandwidth.TopTypes(dir, kBandwidthReportRows, types);
+        for (const BandwidthStats::TypeUsage &t : types)
+        {
+            if (t.window.messages == 0)
+                continue;
+            char unknown[16];
+            const char *name = BandwidthStats::MessageName(t.type);
+            if (!name)
+            {
+                std::snprintf(unknown, sizeof(unknown), "type 0x%02x", t.type);
+                name = unknown;
+            }
+            std::snprintf(line, sizeof(line), "[GameServer]   %s   %-22s %10.1f msg %12.0f B %5.1f%%\n",
+                          arrow, name, t.window.messages * perSecond, t.window.bytes * perSecond,
+                          100.0 * t.window.bytes / std::max<uint64_t>(all.bytes, 1));
+            std::cout << line;
+        }
+    }
+
+    m_bandwidth.TopClients(BandwidthStats::Out, true, kBandwidthReportRows, m_bandwidthScratch);
+    for (const BandwidthStats::ClientUsage &c : m_bandwidthScratch)
+    {
+        const ClientID clientID = ClientOfConn(c.connHandle);
+        if (clientID == INVALID_CLIENT_ID)
+            continue;
+        std::snprintf(line, sizeof(line),
+                      "[GameServer]   client %-6u %-18s in %10.0f B %7.1f msg, out %10.0f B %7.1f msg\n",
+                      clientID, GetClientDisplayName(clientID).c_str(),
+                      c.window[BandwidthStats::In].bytes * perSecond,
+                      c.window[BandwidthStats::In].messages * perSecond,
+                      c.window[BandwidthStats::Out].bytes * perSecond,
+                      c.window[BandwidthStats::Out].messages * perSecond);
+        std::cout << line;
+    }
+}
+
+void GameServer::LogLoadReport()
+{
+    using us = std::chrono::microseconds;
+    const TickWatchdog::Stats &stats = m_watchdog.WindowStats();
+    const uint64_t rejected = m_transport.RejectedConnections();
+    TickWatchdog::Clock::duration avgWork{};
+    if (stats.ticks > 0)
+        avgWork = stats.totalWork / static_cast<int64_t>(stats.ticks);
+
+    std::cout << "[GameServer] Tick load over " << stats.ticks << " ticks: work avg "
+              << std::chrono::duration_cast<us>(avgWork).count() << " us, max "
+              << std::chrono::duration_cast<us>(stats.maxWork).count() << " us of "
+              << std::chrono::duration_cast<us>(m_watchdog.Budget()).count()
+              << " us budget, over budget " << stats.overBudgetTicks << "; level "
+              << static_cast<int>(m_watchdog.Level()) << " ("
+              << TickWatchdog::LevelName(m_watchdog.Level()) << "), ticks per level";
+    for (uint64_t n : stats.ticksAtLevel)
+        std::cout << " " << n;
+    std::cout << ", escalations " << stats.escalations << ", recoveries " << stats.recoveries
+              << ", deferred " << m_windowDeferred << ", rejected connections "
+              << rejected - m_rejectedAtLastReport << "\n";
+
+    if (UdpDriver::ReadyFd() >= 0)
+    {
+        const UdpDriver::Stats udp = UdpDriver::GetStats();
+        const UdpDriver::Stats &last = m_udpAtLastReport;
+        std::cout << "[GameServer] UDP driver: received " << udp.packetsReceived - last.packetsReceived
+                  << " packets in " << udp.receiveCalls - last.receiveCalls << " calls, sent "
+                  << udp.packetsSent - last.packetsSent << " in " << udp.sendCalls - last.sendCalls
+                  << " calls, send drops " << udp.sendDrops - last.sendDrops << ", ring stalls "
+                  << udp.ringStalls - last.ringStalls << "\n";
+        m_udpAtLastReport = udp;
+    }
+
+    m_watchdog.ResetWindow();
+    m_windowDeferred = 0;
+    m_rejectedAtLastReport = rejected;
+}
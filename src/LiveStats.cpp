@@ -0,0 +1,80 @@
+// ────────────────────────────────────────────────────────────────────
+// Live stats shared-memory segment (server side)
+// ────────────────────────────────────────────────────────────────────
+
+#include "LiveStats.h"
+
+#include <iostream>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define NW_HAVE_POSIX_SHM 1
+#endif
+
+LiveStatsPublisher::~LiveStatsPublisher()
+{
+    Close();
+}
+
+#if defined(NW_HAVE_POSIX_SHM)
+
+bool LiveStatsPublisher::Open(uint16_t port)
+{
+    Close();
+    m_name = LiveStats::SegmentName(port);
+
+    // A segment left behind by a crashed server is simply reused.
+    const int fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "[LiveStats] shm_open " << m_name << " failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    void *mem = MAP_FAILED;
+    if (ftruncate(fd, sizeof(LiveStats::Segment)) == 0)
+        mem = mmap(nullptr, sizeof(LiveStats::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+    {
+        std::cerr << "[LiveStats] cannot map " << m_name << ": " << std::strerror(errno) << "\n";
+        shm_unlink(m_name.c_str());
+        return false;
+    }
+
+    // Readers check magic and version, so fill those last.
+    std::memset(mem, 0, sizeof(LiveStats::Segment));
+    m_segment = new (mem) LiveStats::Segment{};
+    m_segment->size = sizeof(LiveStats::Segment);
+    m_segment->pid = static_cast<uint32_t>(getpid());
+    m_segment->version = LiveStats::kVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_segment->magic = LiveStats::kMagic;
+
+    std::cout << "[LiveStats] Publishing to shared memory " << m_name << "\n";
+    return true;
+}
+
+void LiveStatsPublisher::Close()
+{
+    if (!m_segment)
+        return;
+    munmap(m_segment, sizeof(LiveStats::Segment));
+    shm_unlink(m_name.c_str());
+    m_segment = nullptr;
+}
+
+#else
+
+bool LiveStatsPublisher::Open(uint16_t)
+{
+    std::cerr << "[LiveStats] Shared-memory stats are not supported on this platform\n";
+    return false;
+}
+
+void LiveStatsPublisher::Close() {}
+
+#endif
@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/// Live counters the server publishes in a POSIX shared-memory segment
+/// ("/neural_wings.<port>") for external viewers such as nw-top.
+///
+/// The segment is rewritten once per tick under a seqlock: the sequence
+/// is odd while the server writes, and a reader keeps a copy only if the
+/// sequence was even and unchanged around it. The server never waits on
+/// a reader and no syscall happens per tick.
+namespace LiveStats
+{
+    constexpr uint32_t kMagic = 0x534C574E; // "NWLS"
+    /// Bump on any layout change; readers refuse other versions.
+    constexpr uint32_t kVersion = 2;
+    constexpr uint32_t kMessageTypes = 256;
+    constexpr uint32_t kTopClients = 8;
+
+    /// Totals for one message type (the payload's first byte).
+    struct Traffic
+    {
+        uint64_t packets;
+        uint64_t bytes;
+    };
+
+    /// One client's traffic over the server's rolling bandwidth window.
+    struct ClientTraffic
+    {
+        uint32_t clientID;
+        uint32_t windowSeconds;
+        uint64_t bytesIn;
+        uint64_t bytesOut;
+        uint64_t messagesIn;
+        uint64_t messagesOut;
+    };
+
+    struct Snapshot
+    {
+        uint64_t serverTick;
+        uint64_t publishedUnixMs; // wall clock, to spot a stalled server
+        uint32_t tickRate;
+        uint32_t clients;
+        uint32_t welcomedClients;
+        uint32_t rooms;
+        uint32_t loadLevel;       // LoadLevel
+        uint32_t loadPermille;    // tick work / budget, last watchdog window
+        uint64_t lastTickNs;      // work of the tick that published this
+        uint64_t maxTickNs;       // longest tick in the current report window
+        uint32_t reliableBacklog; // reliable messages not yet acked, all clients
+        uint32_t reliableBacklogMax; // worst single client
+        Traffic in[kMessageTypes];   // since start; SendMany counts each recipient
+        Traffic out[kMessageTypes];
+        uint32_t topClientCount;  // valid entries in topClients
+        uint32_t reserved;
+        ClientTraffic topClients[kTopClients]; // most bytes both ways first
+    };
+
+    struct Segment
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t size; // sizeof(Segment) of the writer
+        uint32_t pid;
+        std::atomic<uint32_t> sequence;
+        uint32_t reserved;
+        Snapshot snapshot;
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                  "the seqlock lives in memory shared between processes");
+
+    inline std::string SegmentName(uint16_t port)
+    {
+        return "/neural_wings." + std::to_string(port);
+    }
+
+    /// Copy a consistent snapshot out of a mapped segment. Returns false
+    /// when the writer kept interfering; just try again later.
+    inline bool Read(const Segment &segment, Snapshot &out)
+    {
+        for (int attempt = 0; attempt < 64; ++attempt)
+        {
+            const uint32_t before = segment.sequence.load(std::memory_order_acquire);
+            if (before & 1u)
+                continue;
+            std::memcpy(&out, &segment.snapshot, sizeof(out));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (segment.sequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+        return false;
+    }
+}
+
+/// Server side: owns the segment and writes it under the seqlock.
+class LiveStatsPublisher
+{
+public:
+    LiveStatsPublisher() = default;
+    ~LiveStatsPublisher();
+
+    LiveStatsPublisher(const LiveStatsPublisher &) = delete;
+    LiveStatsPublisher &operator=(const LiveStatsPublisher &) = delete;
+
+    /// Create (or take over) the segment for `port`. False where POSIX
+    /// shared memory is unavailable or on error (logged).
+    bool Open(uint16_t port);
+    /// Unmap and unlink the segment.
+    void Close();
+    bool IsOpen() const { return m_segment != nullptr; }
+
+    /// Start rewriting the snapshot in place; finish with EndUpdate().
+    LiveStats::Snapshot &BeginUpdate()
+    {
+        const uint32_t seq = m_segment->sequence.load(std::memory_order_relaxed);
+        m_segment->sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return m_segment->snapshot;
+    }
+
+    void EndUpdate()
+    {
+        const uint32_t seq = m_segment->sequence.load(std::memory_order_relaxed);
+        m_segment->sequence.store(seq + 1, std::memory_order_release);
+    }
+
+private:
+    LiveStats::Segment *m_segment = nullptr;
+    std::string m_name;
+};
@@ -0,0 +1,612 @@
+// ────────────────────────────────────────────────────────────────────
+// nbnet transport: inline or on a dedicated I/O thread
+// ────────────────────────────────────────────────────────────────────
+
+extern "C"
+{
+#include <nbnet.h>
+#include "nbnet_server_ext.h"
+}
+
+#include "NetTransport.h"
+#include "Tracer.h"
+#include "UdpDriver.h"
+#include "Engine/Network/NetTypes.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr size_t kInboundRingBytes = 4u << 20;   // ~a second of heavy upstream traffic
+    constexpr size_t kOutboundRingBytes = 16u << 20; // a few ticks of full broadcasts
+
+    // I/O thread sleep when there was nothing to receive or send.
+    constexpr std::chrono::microseconds kIdleSleep{250};
+
+    // Where sockets cannot be waited on, a parked server polls nbnet
+    // this often instead.
+    constexpr std::chrono::milliseconds kParkedPollInterval{5};
+
+    // Longest single block of the parked I/O thread (re-checks state).
+    constexpr std::chrono::milliseconds kParkedIOTimeout{1000};
+
+#if defined(NW_ENABLE_WEBRTC_C)
+    // WebRTC data arrives on libdatachannel's threads and reaches nbnet
+    // only when it is polled, so no descriptor of ours signals it. Parked
+    // waits block on the UDP sockets at most kParkedPollInterval at a time.
+    constexpr bool kSocketsSeeAllTraffic = false;
+#else
+    constexpr bool kSocketsSeeAllTraffic = true;
+#endif
+
+#if defined(__linux__)
+    /// nbnet keeps its UDP socket private; find it among our descriptors
+    /// by the port it is bound to.
+    std::vector<int> FindUdpSocketsBoundTo(uint16_t port)
+    {
+        std::vector<int> fds;
+        const long maxFd = std::min(sysconf(_SC_OPEN_MAX), 4096L);
+        for (int fd = 0; fd < maxFd; ++fd)
+        {
+            int type = 0;
+            socklen_t typeLen = sizeof(type);
+            if (getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &typeLen) < 0 || type != SOCK_DGRAM)
+                continue;
+
+            sockaddr_storage addr{};
+            socklen_t addrLen = sizeof(addr);
+            if (getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &addrLen) < 0)
+                continue;
+            uint16_t boundPort = 0;
+            if (addr.ss_family == AF_INET)
+                boundPort = ntohs(reinterpret_cast<sockaddr_in *>(&addr)->sin_port);
+            else if (addr.ss_family == AF_INET6)
+                boundPort = ntohs(reinterpret_cast<sockaddr_in6 *>(&addr)->sin6_port);
+            if (boundPort == port)
+                fds.push_back(fd);
+        }
+        return fds;
+    }
+#endif
+
+    uint8_t MapChannel(uint8_t ourChannel)
+    {
+        // our convention: 0 = reliable, 1 = unreliable
+        return (ourChannel == 0) ? NBN_CHANNEL_RESERVED_RELIABLE : NBN_CHANNEL_RESERVED_UNRELIABLE;
+    }
+}
+
+NetTransport::NetTransport()
+    : m_inbound(kInboundRingBytes), m_outbound(kOutboundRingBytes)
+{
+}
+
+NetTransport::~NetTransport()
+{
+    Stop();
+}
+
+void NetTransport::Start(bool threaded, uint16_t port)
+{
+    m_threaded = threaded;
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_readPending = false;
+    m_hasStashed = false;
+    m_liveConnections.clear();
+#if defined(__linux__)
+    // The sharded driver's sockets belong to its receive threads; wait on
+    // its readiness eventfd instead.
+    if (UdpDriver::ReadyFd() >= 0)
+        m_socketFds = {UdpDriver::ReadyFd()};
+    else
+        m_socketFds = FindUdpSocketsBoundTo(port);
+    if (m_socketFds.empty())
+        std::cerr << "[NetTransport] UDP socket not found, idle waits will poll\n";
+    if (m_wakeFd < 0)
+        m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+    (void)port;
+#endif
+    if (m_threaded)
+        m_ioThread = std::thread(&NetTransport::IOThreadMain, this);
+}
+
+void NetTransport::Stop()
+{
+    if (m_ioThread.joinable())
+    {
+        m_stopRequested.store(true, std::memory_order_release);
+        WakeIO();
+        m_ioThread.join();
+    }
+    m_threaded = false;
+#if defined(__linux__)
+    if (m_wakeFd >= 0)
+    {
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+#endif
+    m_socketFds.clear();
+}
+
+// ── Simulation side ─────────────────────────────────────────────────
+
+bool NetTransport::NextEvent(NetEvent &out)
+{
+    if (!ReadEvent(out))
+        return false;
+    if (out.type == NetEvent::Message)
+        CountTraffic(m_trafficIn, out.data, out.len, 1);
+    return true;
+}
+
+bool NetTransport::ReadEvent(NetEvent &out)
+{
+    if (!m_threaded)
+    {
+        if (m_hasStashed)
+        {
+            out = m_stashed;
+            m_hasStashed = false;
+            return true;
+        }
+        return PollOne(out);
+    }
+
+    if (m_readPending)
+    {
+        m_inbound.EndRead();
+        m_readPending = false;
+    }
+
+    size_t recordLen = 0;
+    const uint8_t *record = m_inbound.BeginRead(recordLen);
+    if (!record)
+        return false;
+    m_readPending = true;
+
+    InRecord hdr;
+    std::memcpy(&hdr, record, sizeof(hdr));
+    out.type = hdr.type;
+    out.connHandle = hdr.connHandle;
+    out.received = std::chrono::steady_clock::time_point(
+        std::chrono::steady_clock::duration(hdr.receivedNs));
+    out.data = record + sizeof(hdr);
+    out.len = hdr.len;
+    return true;
+}
+
+uint8_t *NetTransport::ReserveOutbound(size_t len)
+{
+    // Backpressure: the I/O thread drains continuously, so a full ring
+    // only means it is momentarily behind.
+    uint8_t *dst = m_outbound.BeginWrite(len);
+    while (!dst)
+    {
+        if (!m_outboundFullWarned)
+        {
+            std::cerr << "[NetTransport] Outbound queue full, waiting for I/O thread\n";
+            m_outboundFullWarned = true;
+        }
+        std::this_thread::yield();
+        dst = m_outbound.BeginWrite(len);
+    }
+    return dst;
+}
+
+void NetTransport::Send(uint32_t connHandle, const uint8_t *data, size_t len, uint8_t channel)
+{
+    CountTraffic(m_trafficOut, data, len, 1);
+    if (!m_threaded)
+    {
+        DoSend(connHandle, data, len, channel);
+        return;
+    }
+
+    const OutRecord hdr{Op::Send, channel, connHandle, static_cast<uint32_t>(len)};
+    uint8_t *dst = ReserveOutbound(sizeof(hdr) + len);
+    std::memcpy(dst, &hdr, sizeof(hdr));
+    std::memcpy(dst + sizeof(hdr), data, len);
+    m_outbound.CommitWrite();
+}
+
+void NetTransport::SendMany(const uint32_t *connHandles, size_t count,
+                            const uint8_t *data, size_t len, uint8_t channel)
+{
+    if (count == 0)
+        return;
+    CountTraffic(m_trafficOut, data, len, count);
+    if (!m_threaded)
+    {
+        DoSendMany(connHandles, count, data, len, channel);
+        return;
+    }
+
+    const size_t handleBytes = count * sizeof(uint32_t);
+    const OutRecord hdr{Op::SendMany, channel, static_cast<uint32_t>(count),
+                        static_cast<uint32_t>(len)};
+    uint8_t *dst = ReserveOutbound(sizeof(hdr) + handleBytes + len);
+    std::memcpy(dst, &hdr, sizeof(hdr));
+    std::memcpy(dst + sizeof(hdr), connHandles, handleBytes);
+    std::memcpy(dst + sizeof(hdr) + handleBytes, data, len);
+    m_outbound.CommitWrite();
+}
+
+void NetTransport::Close(uint32_t connHandle)
+{
+    if (!m_threaded)
+    {
+        DoClose(connHandle);
+        return;
+    }
+
+    const OutRecord hdr{Op::Close, 0, connHandle, 0};
+    std::memcpy(ReserveOutbound(sizeof(hdr)), &hdr, sizeof(hdr));
+    m_outbound.CommitWrite();
+}
+
+void NetTransport::Flush()
+{
+    if (!m_threaded)
+    {
+        DoFlush();
+        return;
+    }
+
+    const OutRecord hdr{Op::Flush, 0, 0, 0};
+    std::memcpy(ReserveOutbound(sizeof(hdr)), &hdr, sizeof(hdr));
+    m_outbound.CommitWrite();
+
+    // A parked I/O thread is blocked on the sockets; it would otherwise
+    // only see this tick's output at its next timeout.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_ioBlocked.load(std::memory_order_relaxed))
+        WakeIO();
+}
+
+bool NetTransport::WaitForTraffic(std::chrono::steady_clock::duration timeout)
+{
+    if (m_threaded)
+    {
+        // The I/O thread notices m_parked, blocks on the sockets itself
+        // and signals m_waitCv once it has queued something.
+        m_parked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool woken;
+        {
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            woken = m_waitCv.wait_for(lock, timeout, [this]
+                                      { return !m_inbound.Empty(); });
+        }
+        m_parked.store(false, std::memory_order_relaxed);
+        return woken;
+    }
+
+    if (m_hasStashed)
+        return true;
+    if (!m_socketFds.empty() && kSocketsSeeAllTraffic)
+        return PollSockets(timeout, false);
+
+    // Traffic the sockets cannot signal: poll nbnet in small steps,
+    // between socket waits where there are sockets, keeping the first
+    // event for NextEvent().
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (auto now = std::chrono::steady_clock::now(); now < deadline;
+         now = std::chrono::steady_clock::now())
+    {
+        const auto step =
+            std::min<std::chrono::steady_clock::duration>(kParkedPollInterval, deadline - now);
+        if (!m_socketFds.empty() && PollSockets(step, false))
+            return true;
+        if (PollOne(m_stashed))
+        {
+            m_hasStashed = true;
+            return true;
+        }
+        if (m_socketFds.empty())
+            std::this_thread::sleep_for(step);
+    }
+    return false;
+}
+
+bool NetTransport::PollSockets(std::chrono::steady_clock::duration timeout, bool withWakeFd)
+{
+#if defined(__linux__)
+    pollfd fds[8];
+    nfds_t count = 0;
+    for (int fd : m_socketFds)
+    {
+        if (count < 7)
+            fds[count++] = pollfd{fd, POLLIN, 0};
+    }
+    const nfds_t socketCount = count;
+    if (withWakeFd && m_wakeFd >= 0)
+        fds[count++] = pollfd{m_wakeFd, POLLIN, 0};
+
+    const auto ns = std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count(), 0);
+    const timespec ts{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+    if (ppoll(fds, count, &ts, nullptr) <= 0)
+        return false;
+
+    if (withWakeFd && m_wakeFd >= 0 && (fds[socketCount].revents & POLLIN))
+    {
+        uint64_t drained;
+        (void)!read(m_wakeFd, &drained, sizeof(drained));
+    }
+    for (nfds_t i = 0; i < socketCount; ++i)
+    {
+        if (fds[i].revents & POLLIN)
+            return true;
+    }
+    return false;
+#else
+    (void)withWakeFd;
+    std::this_thread::sleep_for(timeout);
+    return false;
+#endif
+}
+
+// ── nbnet side ──────────────────────────────────────────────────────
+
+bool NetTransport::PollOne(NetEvent &out)
+{
+    for (;;)
+    {
+        const int ev = NBN_GameServer_Poll();
+        if (ev == NBN_NO_EVENT)
+            return false;
+        if (ev < 0)
+        {
+            std::cerr << "[GameServer] Poll error\n";
+            return false;
+        }
+
+        out.received = std::chrono::steady_clock::now();
+        out.data = nullptr;
+        out.len = 0;
+
+        switch (ev)
+        {
+        case NBN_NEW_CONNECTION:
+            // Accept unless the server is shedding load (authentication
+            // can be added later)
+            if (!m_acceptConnections.load(std::memory_order_relaxed))
+            {
+                NBN_GameServer_RejectIncomingConnectionWithCode(CONNECTION_REJECT_SERVER_BUSY);
+                m_rejectedConnections.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            out.type = NetEvent::Connected;
+            out.connHandle = NBN_GameServer_GetIncomingConnection();
+            NBN_GameServer_AcceptIncomingConnection();
+            m_liveConnections.insert(out.connHandle);
+            return true;
+
+        case NBN_CLIENT_DISCONNECTED:
+            out.type = NetEvent::Disconnected;
+            out.connHandle = NBN_GameServer_GetDisconnectedClient();
+            m_liveConnections.erase(out.connHandle);
+            return true;
+
+        case NBN_CLIENT_MESSAGE_RECEIVED:
+        {
+            NBN_MessageInfo info = NBN_GameServer_GetMessageInfo();
+            if (info.type != NBN_BYTE_ARRAY_MESSAGE_TYPE || !info.data)
+                continue;
+
+            const NBN_ByteArrayMessage *msg =
+                static_cast<const NBN_ByteArrayMessage *>(info.data);
+            out.type = NetEvent::Message;
+            out.connHandle = info.sender;
+            out.data = msg->bytes;
+            out.len = msg->length;
+            return true;
+        }
+
+        default:
+            continue;
+        }
+    }
+}
+
+void NetTransport::DoSend(uint32_t connHandle, const uint8_t *data, size_t len, uint8_t channel)
+{
+    if (m_liveConnections.count(connHandle) == 0)
+        return;
+    NBN_GameServer_SendByteArrayTo(connHandle, const_cast<uint8_t *>(data),
+                                   static_cast<unsigned int>(len), MapChannel(channel));
+}
+
+void NetTransport::DoSendMany(const uint32_t *connHandles, size_t count,
+                              const uint8_t *data, size_t len, uint8_t channel)
+{
+    // Unknown handles are skipped by the extension itself.
+    if (NW_GameServer_SendByteArrayToMany(connHandles, static_cast<unsigned int>(count),
+                                          data, static_cast<unsigned int>(len),
+                                          MapChannel(channel)) < 0)
+    {
+        std::cerr << "[GameServer] Broadcast to " << count << " clients failed\n";
+    }
+}
+
+void NetTransport::DoClose(uint32_t connHandle)
+{
+    if (m_liveConnections.erase(connHandle) == 0)
+        return;
+    if (NBN_GameServer_CloseClient(connHandle) < 0)
+    {
+        std::cerr << "[GameServer] Failed to close transport for connection "
+                  << connHandle << "\n";
+    }
+}
+
+void NetTransport::DoFlush()
+{
+    {
+        NW_TRACE_SCOPE("nbnet SendPackets");
+        if (NBN_GameServer_SendPackets() < 0)
+        {
+            std::cerr << "[GameServer] SendPackets failed\n";
+        }
+        UdpDriver::FlushSends();
+    }
+
+    if (m_trackBacklog.load(std::memory_order_relaxed))
+    {
+        uint32_t total = 0;
+        uint32_t worst = 0;
+        for (uint32_t conn : m_liveConnections)
+        {
+            const uint32_t queued =
+                NW_GameServer_GetOutgoingMessageCount(conn, NBN_CHANNEL_RESERVED_RELIABLE);
+            total += queued;
+            worst = std::max(worst, queued);
+        }
+        m_reliableBacklog.store(total, std::memory_order_relaxed);
+        m_reliableBacklogMax.store(worst, std::memory_order_relaxed);
+    }
+}
+
+// ── I/O thread ──────────────────────────────────────────────────────
+
+void NetTransport::IOThreadMain()
+{
+    Tracer::NameThread("I/O");
+    for (;;)
+    {
+        const bool stopping = m_stopRequested.load(std::memory_order_acquire);
+        bool busy = PumpOutbound();
+        if (stopping)
+            break; // everything queued before Stop() has been sent
+        busy |= PumpInbound();
+
+        if (busy)
+            continue;
+        if (m_parked.load(std::memory_order_relaxed))
+            WaitIdleIO();
+        else
+            std::this_thread::sleep_for(kIdleSleep);
+    }
+    DoFlush();
+}
+
+void NetTransport::WaitIdleIO()
+{
+    if (m_socketFds.empty() || m_wakeFd < 0)
+    {
+        std::this_thread::sleep_for(kParkedPollInterval);
+        return;
+    }
+
+    m_ioBlocked.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Re-check after publishing m_ioBlocked so a Flush() racing with it
+    // is either seen here or wakes the poll below.
+    if (m_outbound.Empty() && m_parked.load(std::memory_order_relaxed) &&
+        !m_stopRequested.load(std::memory_order_acquire))
+    {
+        // Back to PumpInbound in time to poll nbnet for WebRTC traffic.
+        PollSockets(kSocketsSeeAllTraffic ? kParkedIOTimeout : kParkedPollInterval, true);
+    }
+    m_ioBlocked.store(false, std::memory_order_relaxed);
+}
+
+void NetTransport::WakeIO()
+{
+#if defined(__linux__)
+    if (m_wakeFd >= 0)
+    {
+        const uint64_t one = 1;
+        (void)!write(m_wakeFd, &one, sizeof(one));
+    }
+#endif
+}
+
+bool NetTransport::PumpInbound()
+{
+    bool any = false;
+    NetEvent ev;
+    while (PollOne(ev))
+    {
+        any = true;
+        const InRecord hdr{ev.type, ev.connHandle,
+                           static_cast<int64_t>(ev.received.time_since_epoch().count()),
+                           static_cast<uint32_t>(ev.len)};
+
+        uint8_t *dst = m_inbound.BeginWrite(sizeof(hdr) + ev.len);
+        while (!dst)
+        {
+            // The simulation drains once per tick; wait rather than drop,
+            // since reliable messages cannot be lost here.
+            if (m_stopRequested.load(std::memory_order_acquire))
+                return any;
+            std::this_thread::sleep_for(kIdleSleep);
+            dst = m_inbound.BeginWrite(sizeof(hdr) + ev.len);
+        }
+        std::memcpy(dst, &hdr, sizeof(hdr));
+        if (ev.len > 0)
+            std::memcpy(dst + sizeof(hdr), ev.data, ev.len);
+        m_inbound.CommitWrite();
+    }
+
+    if (any)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_parked.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(m_waitMutex);
+            m_waitCv.notify_one();
+        }
+    }
+    return any;
+}
+
+bool NetTransport::PumpOutbound()
+{
+    bool any = false;
+    size_t recordLen = 0;
+    while (const uint8_t *record = m_outbound.BeginRead(recordLen))
+    {
+        any = true;
+        OutRecord hdr;
+        std::memcpy(&hdr, record, sizeof(hdr));
+        const uint8_t *payload = record + sizeof(hdr);
+
+        switch (hdr.op)
+        {
+        case Op::Send:
+            DoSend(hdr.connOrCount, payload, hdr.len, hdr.channel);
+            break;
+        case Op::SendMany:
+        {
+            // Records start 8-byte aligned, so the handles after the
+            // 12-byte header are suitably aligned for uint32_t.
+            const uint32_t *handles = reinterpret_cast<const uint32_t *>(payload);
+            DoSendMany(handles, hdr.connOrCount,
+                       payload + hdr.connOrCount * sizeof(uint32_t), hdr.len, hdr.channel);
+            break;
+        }
+        case Op::Close:
+            DoClose(hdr.connOrCount);
+            break;
+        case Op::Flush:
+            DoFlush();
+            break;
+        }
+        m_outbound.EndRead();
+    }
+    return any;
+}
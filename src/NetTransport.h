@@ -0,0 +1,208 @@
+#pragma once
+#include "SpscRing.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/// One inbound network event, as seen by the simulation.
+struct NetEvent
+{
+    enum Type : uint8_t
+    {
+        Connected,
+        Disconnected,
+        Message,
+    };
+
+    Type type = Message;
+    uint32_t connHandle = 0; // NBN_ConnectionHandle
+    std::chrono::steady_clock::time_point received{};
+    const uint8_t *data = nullptr; // Message payload, valid until the next NextEvent()
+    size_t len = 0;
+};
+
+/// Owns every nbnet call made after NBN_GameServer_StartEx.
+///
+/// Inline mode calls nbnet directly from the simulation thread, exactly
+/// like the classic single-threaded loop. Threaded mode moves polling and
+/// sending to a dedicated I/O thread: received events reach the simulation
+/// through one lock-free SPSC ring, outbound payloads go back through
+/// another, and the simulation never waits on a socket.
+///
+/// Channels use the GameServer convention: 0 = reliable, 1 = unreliable.
+class NetTransport
+{
+public:
+    NetTransport();
+    ~NetTransport();
+
+    NetTransport(const NetTransport &) = delete;
+    NetTransport &operator=(const NetTransport &) = delete;
+
+    /// Call after NBN_GameServer_StartEx on `port`. `threaded` spawns the
+    /// I/O thread.
+    void Start(bool threaded, uint16_t port);
+    /// Flush anything queued and join the I/O thread. Call before
+    /// NBN_GameServer_Stop.
+    void Stop();
+
+    bool IsThreaded() const { return m_threaded; }
+
+    /// While false, incoming connections are rejected with
+    /// CONNECTION_REJECT_SERVER_BUSY instead of being accepted.
+    void SetAcceptingConnections(bool accept)
+    {
+        m_acceptConnections.store(accept, std::memory_order_relaxed);
+    }
+    uint64_t RejectedConnections() const
+    {
+        return m_rejectedConnections.load(std::memory_order_relaxed);
+    }
+
+    /// Next received event, or false once nothing is pending for this tick.
+    /// New connections are already accepted (or rejected) when they are
+    /// reported; rejected ones are not reported at all.
+    bool NextEvent(NetEvent &out);
+
+    /// Packets and bytes of one message type (the payload's first byte).
+    struct MessageTraffic
+    {
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+    };
+    using TrafficTable = std::array<MessageTraffic, 256>;
+    /// Totals since construction, kept on the simulation side. A SendMany
+    /// counts once per recipient.
+    const TrafficTable &TrafficIn() const { return m_trafficIn; }
+    const TrafficTable &TrafficOut() const { return m_trafficOut; }
+
+    /// After every flush, add up the messages still queued on each
+    /// connection's reliable channel (walks every connection, so off
+    /// unless someone reads it).
+    void SetTrackReliableBacklog(bool track)
+    {
+        m_trackBacklog.store(track, std::memory_order_relaxed);
+    }
+    /// Reliable messages not yet acknowledged, over all connections and
+    /// for the worst one, as of the last flush.
+    uint32_t ReliableBacklog() const { return m_reliableBacklog.load(std::memory_order_relaxed); }
+    uint32_t ReliableBacklogMax() const { return m_reliableBacklogMax.load(std::memory_order_relaxed); }
+
+    void Send(uint32_t connHandle, const uint8_t *data, size_t len, uint8_t channel);
+    /// One payload to many connections (stored once by nbnet, refcounted).
+    void SendMany(const uint32_t *connHandles, size_t count,
+                  const uint8_t *data, size_t len, uint8_t channel);
+    void Close(uint32_t connHandle);
+    /// End of tick: hand everything queued so far to the sockets
+    /// (NBN_GameServer_SendPackets).
+    void Flush();
+
+    /// Idle servers and relay mode: block until a packet may be waiting
+    /// or `timeout` passes (sub-millisecond timeouts are honoured where
+    /// the sockets can be waited on). Returns true when woken by traffic.
+    ///
+    /// On Linux this blocks on nbnet's UDP socket (and, threaded, parks
+    /// the I/O thread on it too). Elsewhere nbnet is polled every few
+    /// milliseconds; with the WebRTC driver, whose traffic bypasses that
+    /// socket, socket waits are cut to the same few milliseconds and
+    /// nbnet is polled between them.
+    bool WaitForTraffic(std::chrono::steady_clock::duration timeout);
+
+private:
+    enum class Op : uint8_t
+    {
+        Send,
+        SendMany,
+        Close,
+        Flush,
+    };
+
+    /// Record header in the outbound ring, followed by the payload
+    /// (SendMany: `count` connection handles, then the bytes).
+    struct OutRecord
+    {
+        Op op;
+        uint8_t channel;
+        uint32_t connOrCount;
+        uint32_t len;
+    };
+
+    /// Record header in the inbound ring, followed by the message bytes.
+    struct InRecord
+    {
+        NetEvent::Type type;
+        uint32_t connHandle;
+        int64_t receivedNs; // steady_clock ticks
+        uint32_t len;
+    };
+
+    bool ReadEvent(NetEvent &out);
+    static void CountTraffic(TrafficTable &table, const uint8_t *data, size_t len, size_t copies)
+    {
+        if (len == 0)
+            return;
+        MessageTraffic &t = table[data[0]];
+        t.packets += copies;
+        t.bytes += copies * len;
+    }
+
+    // nbnet side (inline: simulation thread; threaded: I/O thread).
+    bool PollOne(NetEvent &out);
+    void DoSend(uint32_t connHandle, const uint8_t *data, size_t len, uint8_t channel);
+    void DoSendMany(const uint32_t *connHandles, size_t count,
+                    const uint8_t *data, size_t len, uint8_t channel);
+    void DoClose(uint32_t connHandle);
+    void DoFlush();
+
+    // Threaded mode.
+    void IOThreadMain();
+    bool PumpInbound();
+    bool PumpOutbound();
+    uint8_t *ReserveOutbound(size_t len);
+    /// I/O thread while the simulation is parked: block on the sockets.
+    void WaitIdleIO();
+    void WakeIO();
+
+    /// poll() the UDP sockets (plus the I/O wake fd if `withWakeFd`).
+    /// Returns true if a UDP socket is readable.
+    bool PollSockets(std::chrono::steady_clock::duration timeout, bool withWakeFd);
+
+    bool m_threaded = false;
+    std::thread m_ioThread;
+    std::atomic<bool> m_stopRequested{false};
+    SpscByteRing m_inbound;  // I/O thread → simulation
+    SpscByteRing m_outbound; // simulation → I/O thread
+    bool m_readPending = false;
+    std::atomic<bool> m_acceptConnections{true};
+    std::atomic<uint64_t> m_rejectedConnections{0};
+    bool m_outboundFullWarned = false;
+
+    /// Connections nbnet currently knows about; sends queued for a peer
+    /// that disconnected in the meantime are dropped. I/O side only.
+    std::unordered_set<uint32_t> m_liveConnections;
+
+    // Idle waiting.
+    std::vector<int> m_socketFds; // nbnet's UDP sockets or the sharded driver's eventfd (Linux)
+    int m_wakeFd = -1;            // eventfd that unblocks the parked I/O thread
+    std::atomic<bool> m_parked{false};    // simulation is in WaitForTraffic
+    std::atomic<bool> m_ioBlocked{false}; // I/O thread is in poll()
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCv; // inbound traffic for a parked simulation
+    NetEvent m_stashed;               // inline fallback: event seen while waiting
+    bool m_hasStashed = false;
+
+    // Counters.
+    TrafficTable m_trafficIn{};
+    TrafficTable m_trafficOut{};
+    std::atomic<bool> m_trackBacklog{false};
+    std::atomic<uint32_t> m_reliableBacklog{0};
+    std::atomic<uint32_t> m_reliableBacklogMax{0};
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include "Engine/Network/NetTypes.h"
+#include "Engine/Network/Protocol/Quantization.h"
+#include "ClientTable.h"
+#include "FrameArena.h"
+#include "InterestGrid.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/// Unreliable sends produced while a room ticks on a worker thread.
+///
+/// The transport has a single producer (the tick thread), so workers
+/// record their packets here and the tick thread submits them afterwards,
+/// room by room. Storage is kept between ticks.
+class RoomOutbox
+{
+public:
+    void Send(uint32_t connHandle, const uint8_t *data, size_t len)
+    {
+        SendMany(&connHandle, 1, data, len);
+    }
+
+    /// One payload for several connections (sent as one shared message).
+    void SendMany(const uint32_t *connHandles, size_t count,
+                  const uint8_t *data, size_t len)
+    {
+        if (count == 0)
+            return;
+        Record r;
+        r.handleOffset = static_cast<uint32_t>(m_handles.size());
+        r.handleCount = static_cast<uint32_t>(count);
+        r.dataOffset = m_bytes.size();
+        r.len = len;
+        m_handles.insert(m_handles.end(), connHandles, connHandles + count);
+        m_bytes.resize(m_bytes.size() + len);
+        std::memcpy(m_bytes.data() + r.dataOffset, data, len);
+        m_records.push_back(r);
+    }
+
+    /// fn(connHandles, count, data, len) for every recorded send, in order,
+    /// then empty the outbox.
+    template <typename Fn>
+    void Drain(Fn &&fn)
+    {
+        for (const Record &r : m_records)
+            fn(m_handles.data() + r.handleOffset, r.handleCount,
+               m_bytes.data() + r.dataOffset, r.len);
+        m_records.clear();
+        m_handles.clear();
+        m_bytes.clear();
+    }
+
+private:
+    struct Record
+    {
+        uint32_t handleOffset;
+        uint32_t handleCount;
+        size_t dataOffset;
+        size_t len;
+    };
+
+    std::vector<Record> m_records;
+    std::vector<uint32_t> m_handles;
+    std::vector<uint8_t> m_bytes;
+};
+
+/// One independent match: the clients in it only see each other's
+/// positions, player metadata and public chat.
+///
+/// Rooms prepare their position broadcasts in parallel, so everything
+/// that step writes lives here. The per-receiver encode jobs that follow
+/// only read it.
+struct Room
+{
+    RoomID id = DEFAULT_ROOM_ID;
+
+    /// Dense ClientTable indices of the members, rebuilt every tick and
+    /// sorted by clientID when the room prepares its broadcast. Only valid
+    /// within the tick; `memberHandles` (same order) outlive it.
+    std::vector<uint32_t> members;
+    std::vector<ClientHandle> memberHandles;
+
+    /// This tick's broadcast: reported entities sorted by clientID and
+    /// their owners, the members due a broadcast, and the connections
+    /// sharing the whole-room copy. `perClient` is set when receivers are
+    /// encoded one by one (AOI, budget or delta format).
+    std::vector<NetBroadcastEntry> entries;
+    std::vector<ClientHandle> entryOwners;
+    std::vector<uint32_t> receivers;
+    std::vector<uint32_t> fullRecipients;
+    bool perClient = false;
+
+    /// Spatial hash rebuilt every tick for area-of-interest filtering.
+    InterestGrid interestGrid;
+
+    /// Quantized room state per broadcast tick (sorted by clientID),
+    /// indexed by tick % kSnapshotHistory. Only filled in Delta format.
+    struct WorldSnapshot
+    {
+        uint32_t tick = 0;
+        std::vector<NetQuantization::QuantizedEntry> entries;
+    };
+    std::array<WorldSnapshot, kSnapshotHistory> snapshotRing{};
+
+    /// Transient memory of this room's broadcast, reset after it is sent.
+    FrameArena frameArena;
+    RoomOutbox outbox; // the whole-room copies
+};
+
+/// Scratch of one thread running per-receiver encode jobs (one per
+/// WorkerPool slot). Packets land in the thread's own outbox and are
+/// sent once every job has finished.
+struct EncodeWorkspace
+{
+    FrameArena frameArena;
+    RoomOutbox outbox;
+    std::vector<uint32_t> candidates;
+    std::vector<NetBroadcastEntry> visible;
+    std::vector<NetQuantization::QuantizedEntry> deltaBaseline;
+    std::vector<NetQuantization::QuantizedEntry> deltaCurrent;
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include "Engine/Network/Protocol/Messages.h"
+#include "TickScheduler.h"
+#include "TickWatchdog.h"
+#include <chrono>
+#include <cstdint>
+
+/// Wire format used for position broadcasts.
+enum class BroadcastFormat : uint8_t
+{
+    Raw,     // MsgPositionBroadcast, full floats (every client understands it)
+    Compact, // MsgPositionBroadcastCompact, quantized + bit-packed
+    Delta,   // MsgPositionBroadcastDelta against each client's SnapshotAck,
+             // falling back to Compact when no usable baseline exists
+};
+
+/// Tunables for the authoritative server.
+/// Defaults preserve the classic behaviour; main.cpp overrides them
+/// from the command line.
+struct ServerConfig
+{
+    /// Simulation ticks per second (poll, simulate, flush).
+    uint32_t tickRate = 30;
+    /// Default position broadcasts per second for each client (rounded to
+    /// every Nth tick, clients staggered across ticks). Clients may ask
+    /// for their own rate with SnapshotRate. 0 = every tick.
+    uint32_t sendRate = 0;
+    TickOverrunPolicy overrunPolicy = TickOverrunPolicy::CatchUp;
+    /// Furthest the tick watchdog may shed load when ticks keep using up
+    /// their budget. Normal = only measure and report (the default:
+    /// shedding changes what clients get, so operators opt in).
+    LoadLevel maxLoadLevel = LoadLevel::Normal;
+
+    /// While no client is in gameplay the loop stops ticking at tickRate
+    /// and waits for traffic instead, waking at least this often for
+    /// housekeeping (timeouts, nbnet keep-alives). 0 = always tick.
+    std::chrono::milliseconds idleWakeInterval{250};
+
+    /// Area-of-interest radius in world units. Each client only receives
+    /// entities within this distance of its own transform.
+    /// <= 0 disables interest management (every client receives everyone).
+    float interestRadius = 0.0f;
+
+    /// Per-client PositionBroadcast budget in bytes per broadcast. When the
+    /// visible entities do not fit, the highest-priority ones are sent and
+    /// the rest keep accumulating priority. 0 = unlimited.
+    uint32_t clientByteBudget = 0;
+
+    BroadcastFormat broadcastFormat = BroadcastFormat::Raw;
+
+    /// Compact format: positions are fixed-point over [-worldBound, worldBound]
+    /// with at most `positionPrecision` world units of rounding error.
+    float worldBound = 8192.0f;
+    float positionPrecision = 0.01f;
+
+    /// Largest compact/delta broadcast payload in bytes. Bigger ticks are
+    /// split into independently decodable chunks (chunkIndex/chunkCount)
+    /// so one lost datagram only loses a slice of the world instead of the
+    /// whole tick. 0 = never split. Raw broadcasts and relay packets are
+    /// never split: they carry no chunk index, and clients would drop
+    /// every chunk after the first as already applied.
+    uint32_t maxBroadcastPayload = 1024;
+
+    /// Coalesce each client's reliable messages for a tick into one
+    /// MessageBundle packet (clients must understand MessageBundle).
+    bool bundleReliable = false;
+
+    /// Run nbnet polling and socket sends on a dedicated I/O thread that
+    /// exchanges packets with the tick through lock-free queues.
+    bool ioThread = false;
+
+    /// Receive on this many SO_REUSEPORT sockets, each drained by its own
+    /// thread, instead of nbnet's single-socket UDP driver (Linux only).
+    /// 0 = nbnet's stock driver.
+    uint32_t udpReceiveShards = 0;
+    /// Receive and send through recvmmsg / sendmmsg batches (Linux only,
+    /// uses the sharded driver with at least one shard).
+    bool udpBatch = false;
+
+    /// Publish live counters to the shared-memory segment
+    /// "/neural_wings.<port>" every tick, for nw-top (POSIX only).
+    bool liveStats = false;
+
+    /// Record a Chrome trace of this many seconds right after start and
+    /// dump it (0 = off; SIGUSR1 toggles recording at any time on POSIX).
+    uint32_t traceSeconds = 0;
+
+    /// Most rooms alive at once, the default room included. Joining a new
+    /// room past this limit is refused.
+    uint32_t maxRooms = 64;
+
+    /// Relay mode for small competitive rooms: between ticks the server
+    /// waits on the sockets and forwards each accepted PositionUpdate to
+    /// the room's peers within this micro-batching window, instead of
+    /// holding it for the next tick. 0 = off.
+    std::chrono::microseconds relayWindow{0};
+    /// Largest room (members) that relays; bigger rooms wait for the tick.
+    uint32_t relayMaxRoomSize = 8;
+
+    /// Worker threads that encode position broadcasts (rooms and
+    /// per-receiver packets) in parallel, in addition to the tick thread.
+    /// 0 = everything is encoded on the tick thread.
+    uint32_t workerThreads = 0;
+};
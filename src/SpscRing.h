@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+/// Lock-free single-producer / single-consumer ring of variable-length
+/// byte records.
+///
+/// Records are stored contiguously (a record that would straddle the end
+/// of the buffer is preceded by a wrap marker), so readers get a plain
+/// pointer + length with no copying. Exactly one thread may call the
+/// Begin/CommitWrite pair and exactly one other thread BeginRead/EndRead.
+class SpscByteRing
+{
+public:
+    /// `capacity` is rounded up to a power of two.
+    explicit SpscByteRing(size_t capacity)
+    {
+        m_size = 64;
+        while (m_size < capacity)
+            m_size <<= 1;
+        m_buf = std::make_unique<uint8_t[]>(m_size);
+    }
+
+    SpscByteRing(const SpscByteRing &) = delete;
+    SpscByteRing &operator=(const SpscByteRing &) = delete;
+
+    size_t Capacity() const { return m_size; }
+
+    // ── Producer ──────────────────────────────────────────────────
+
+    /// Reserve `len` contiguous bytes for the next record. Returns nullptr
+    /// (and reserves nothing) when the ring is currently too full.
+    uint8_t *BeginWrite(size_t len)
+    {
+        const size_t need = RecordSize(len);
+        if (need > m_size)
+            return nullptr;
+
+        const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t index = static_cast<size_t>(tail & (m_size - 1));
+        const size_t untilEnd = m_size - index;
+        const size_t pad = (need > untilEnd) ? untilEnd : 0;
+
+        if (m_size - (tail - m_cachedHead) < pad + need)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (m_size - (tail - m_cachedHead) < pad + need)
+                return nullptr;
+        }
+
+        if (pad > 0)
+            StoreLength(index, kWrapMarker);
+        m_writeStart = tail + pad;
+        m_writeLen = static_cast<uint32_t>(len);
+        return m_buf.get() + static_cast<size_t>(m_writeStart & (m_size - 1)) + kLengthBytes;
+    }
+
+    /// Publish the record reserved by the last BeginWrite().
+    void CommitWrite()
+    {
+        StoreLength(static_cast<size_t>(m_writeStart & (m_size - 1)), m_writeLen);
+        m_tail.store(m_writeStart + RecordSize(m_writeLen), std::memory_order_release);
+    }
+
+    /// Publish the last reservation cut down to its first `len` bytes
+    /// (reserve the largest possible record, fill, keep what was used).
+    void CommitWrite(size_t len)
+    {
+        assert(len <= m_writeLen);
+        m_writeLen = static_cast<uint32_t>(len);
+        CommitWrite();
+    }
+
+    /// Convenience: copy one record in. Returns false when full.
+    bool TryWrite(const void *data, size_t len)
+    {
+        uint8_t *dst = BeginWrite(len);
+        if (!dst)
+            return false;
+        std::memcpy(dst, data, len);
+        CommitWrite();
+        return true;
+    }
+
+    // ── Consumer ──────────────────────────────────────────────────
+
+    /// Oldest unread record, or nullptr if the ring is empty. The bytes
+    /// stay valid until EndRead().
+    const uint8_t *BeginRead(size_t &len)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (head == m_cachedTail)
+            {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if (head == m_cachedTail)
+                    return nullptr;
+            }
+
+            const size_t index = static_cast<size_t>(head & (m_size - 1));
+            const uint32_t stored = LoadLength(index);
+            if (stored == kWrapMarker)
+            {
+                head += m_size - index;
+                m_head.store(head, std::memory_order_release);
+                continue;
+            }
+
+            m_readLen = stored;
+            len = stored;
+            return m_buf.get() + index + kLengthBytes;
+        }
+    }
+
+    /// Release the record returned by the last BeginRead().
+    void EndRead()
+    {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        m_head.store(head + RecordSize(m_readLen), std::memory_order_release);
+    }
+
+    bool Empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t kLengthBytes = 8; // keeps payloads 8-byte aligned
+    static constexpr uint32_t kWrapMarker = UINT32_MAX;
+
+    static size_t RecordSize(size_t len)
+    {
+        return (kLengthBytes + len + 7) & ~static_cast<size_t>(7);
+    }
+
+    void StoreLength(size_t index, uint32_t len)
+    {
+        std::memcpy(m_buf.get() + index, &len, sizeof(len));
+    }
+
+    uint32_t LoadLength(size_t index) const
+    {
+        uint32_t len;
+        std::memcpy(&len, m_buf.get() + index, sizeof(len));
+        return len;
+    }
+
+    std::unique_ptr<uint8_t[]> m_buf;
+    size_t m_size = 0;
+
+    // Producer side.
+    alignas(64) std::atomic<uint64_t> m_tail{0};
+    uint64_t m_cachedHead = 0;
+    uint64_t m_writeStart = 0;
+    uint32_t m_writeLen = 0;
+
+    // Consumer side.
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    uint64_t m_cachedTail = 0;
+    uint32_t m_readLen = 0;
+};
@@ -2,52 +2,85 @@
 // GameServer state sync and transport helpers
 // ────────────────────────────────────────────────────────────────────
 
-extern "C"
-{
-#include <nbnet.h>
-}
-
 #include "GameServer.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cmath>
+#include <string_view>
 #include <utility>
 
-static uint8_t MapChannel(uint8_t ourChannel)
+namespace
 {
-    // our convention: 0 = reliable, 1 = unreliable
-    return (ourChannel == 0) ? NBN_CHANNEL_RESERVED_RELIABLE : NBN_CHANNEL_RESERVED_UNRELIABLE;
+    // Broadcast priority growth per tick: an entity at kPriorityNearDistance
+    // gains half the priority of one right next to the receiver, and each
+    // kPriorityRelSpeedScale of relative speed adds one more unit.
+    constexpr float kPriorityNearDistance = 250.0f;
+    constexpr float kPriorityRelSpeedScale = 50.0f;
+
+    // Reliable bundles are closed before they outgrow one datagram.
+    constexpr size_t kMaxBundleBytes = 1024;
+
+    // Slowest send rate, in ticks between broadcasts. Kept well inside the
+    // snapshot history so delta baselines survive an ack round trip.
+    constexpr uint32_t kMaxSendInterval = kSnapshotHistory / 4;
+
+    // Load shedding: entities beyond this share of the AOI radius (or this
+    // distance without AOI) go out every other broadcast, and the AOI
+    // radius itself shrinks by kShrunkInterestScale.
+    constexpr float kFarEntityFraction = 0.5f;
+    constexpr float kFarEntityDistance = 4.0f * kPriorityNearDistance;
+    constexpr float kShrunkInterestScale = 0.75f;
 }
 
 void GameServer::SendWelcome(ClientID clientID)
 {
-    auto pkt = PacketSerializer::WriteServerWelcome(clientID);
-    SendTo(clientID, pkt.data(), pkt.size(), 0); // reliable
+    NW_TRACE_FUNCTION();
+    MsgServerWelcome msg;
+    msg.assignedClientID = clientID;
+    SendMessageTo(clientID, msg, 0); // reliable
 }
 
-void GameServer::SendObjectDespawn(ClientID toClientID, ClientID ownerClientID, NetObjectID objectID)
+void GameServer::SendPlayerMetaSnapshot(ClientID clientID)
 {
-    if (objectID == INVALID_NET_OBJECT_ID)
+    if (m_watchdog.AtLeast(LoadLevel::DeferNonCritical))
+    {
+        if (std::find(m_deferredMetaSnapshots.begin(), m_deferredMetaSnapshots.end(),
+                      clientID) == m_deferredMetaSnapshots.end())
+        {
+            m_deferredMetaSnapshots.push_back(clientID);
+            ++m_windowDeferred;
+        }
         return;
-    auto pkt = PacketSerializer::WriteObjectDespawn(ownerClientID, objectID);
-    SendTo(toClientID, pkt.data(), pkt.size(), 0); // reliable
+    }
+    SendPlayerMetaSnapshotNow(clientID);
 }
 
-void GameServer::SendPlayerMetaSnapshot(ClientID clientID)
+void GameServer::SendPlayerMetaSnapshotNow(ClientID clientID)
 {
-    std::vector<PacketSerializer::PlayerMetaEntryData> entries;
-    entries.reserve(m_clients.size());
+    NW_TRACE_FUNCTION();
+    // Nicknames are viewed in place; welcomed clients always have one.
+    struct MetaEntry
+    {
+        ClientID clientID;
+        std::string_view nickname;
+    };
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos)
+        return;
+    const RoomID room = m_clients.roomIDs[index];
+
+    std::pmr::vector<MetaEntry> entries(&m_frameArena);
+    entries.reserve(m_clients.Size());
 
-    for (const auto &[id, cs] : m_clients)
+    for (uint32_t i = 0; i < m_clients.Size(); ++i)
     {
-        (void)id;
-        if (!cs.welcomed)
+        if (!m_clients.IsWelcomed(i) || m_clients.roomIDs[i] != room)
             continue;
-
-        PacketSerializer::PlayerMetaEntryData entry;
-        entry.clientID = cs.id;
-        entry.nickname = GetClientDisplayName(cs.id);
-        entries.push_back(std::move(entry));
+        entries.push_back(MetaEntry{m_clients.ids[i], m_clients.cold[i].nickname});
     }
 
-    auto pkt = PacketSerializer::WritePlayerMetaSnapshot(entries);
+    FrameBytes pkt(&m_frameArena);
+    PacketSerializer::AppendPlayerMetaSnapshot(pkt, entries);
     SendTo(clientID, pkt.data(), pkt.size(), 0); // reliable
 }
 
@@ -55,68 +88,153 @@ void GameServer::BroadcastPlayerMetaUpsert(ClientID subjectClientID,
                                            const std::string &nickname,
                                            bool includeSubject)
 {
-    auto pkt = PacketSerializer::WritePlayerMetaUpsert(subjectClientID, nickname);
-    for (const auto &[id, cs] : m_clients)
+    const uint32_t index = m_clients.Find(subjectClientID);
+    if (index == ClientTable::npos)
+        return;
+
+    uint8_t pkt[PacketSerializer::kMaxPacketSize<MsgPlayerMetaUpsert>];
+    const size_t len =
+        PacketSerializer::WritePlayerMetaUpsertTo(pkt, sizeof(pkt), subjectClientID, nickname);
+    BroadcastTo(m_clients.roomIDs[index], pkt, len, 0, // reliable
+                includeSubject ? INVALID_CLIENT_ID : subjectClientID);
+}
+
+void GameServer::BroadcastPlayerMetaRemove(ClientID removedClientID)
+{
+    const uint32_t index = m_clients.Find(removedClientID);
+    if (index == ClientTable::npos)
+        return;
+
+    MsgPlayerMetaRemove msg;
+    msg.clientID = removedClientID;
+    BroadcastMessage(m_clients.roomIDs[index], msg, 0, removedClientID); // reliable
+}
+
+void GameServer::SendTo(ClientID clientID,
+                        const uint8_t *data, size_t len, uint8_t channel)
+{
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos)
+        return;
+
+    if (channel == 0 && m_config.bundleReliable)
     {
-        (void)id;
-        if (!cs.welcomed)
-            continue;
-        if (!includeSubject && cs.id == subjectClientID)
-            continue;
-        SendTo(cs.id, pkt.data(), pkt.size(), 0); // reliable
+        QueueReliable(index, data, len);
+        return;
     }
+
+    m_bandwidth.Record(BandwidthStats::Out, m_clients.connHandles[index], data, len);
+    m_transport.Send(m_clients.connHandles[index], data, len, channel);
 }
 
-void GameServer::BroadcastPlayerMetaRemove(ClientID removedClientID)
+void GameServer::SendToMany(const uint32_t *connHandles, size_t count,
+                            const uint8_t *data, size_t len, uint8_t channel)
 {
-    auto pkt = PacketSerializer::WritePlayerMetaRemove(removedClientID);
-    for (const auto &[id, cs] : m_clients)
+    m_bandwidth.RecordMany(BandwidthStats::Out, connHandles, count, data, len);
+    m_transport.SendMany(connHandles, count, data, len, channel);
+}
+
+void GameServer::BroadcastTo(RoomID room, const uint8_t *data, size_t len, uint8_t channel,
+                             ClientID exclude)
+{
+    auto isRecipient = [&](uint32_t i)
+    {
+        return m_clients.IsWelcomed(i) && m_clients.ids[i] != exclude &&
+               (room == kAllRooms || m_clients.roomIDs[i] == room);
+    };
+
+    if (channel == 0 && m_config.bundleReliable)
     {
-        (void)id;
-        if (!cs.welcomed || cs.id == removedClientID)
+        // Bundles are per client, so the payload joins each recipient's
+        // bundle instead of going out as a shared nbnet message.
+        for (uint32_t i = 0; i < m_clients.Size(); ++i)
+        {
+            if (isRecipient(i))
+                QueueReliable(i, data, len);
+        }
+        return;
+    }
+
+    m_broadcastHandles.clear();
+    for (uint32_t i = 0; i < m_clients.Size(); ++i)
+    {
+        if (!isRecipient(i))
             continue;
-        SendTo(cs.id, pkt.data(), pkt.size(), 0); // reliable
+        m_broadcastHandles.push_back(m_clients.connHandles[i]);
     }
+    SendToMany(m_broadcastHandles.data(), m_broadcastHandles.size(), data, len, channel);
 }
 
-void GameServer::SendTo(ClientID clientID,
-                        const uint8_t *data, size_t len, uint8_t channel)
+void GameServer::QueueReliable(uint32_t index, const uint8_t *data, size_t len)
 {
-    auto it = m_clients.find(clientID);
-    if (it == m_clients.end())
+    const uint32_t connHandle = m_clients.connHandles[index];
+    std::vector<uint8_t> &bundle = m_clients.cold[index].reliableBundle;
+    m_bandwidth.Record(BandwidthStats::Out, connHandle, data, len);
+    auto sendNow = [this, connHandle](const uint8_t *bytes, size_t size)
+    { m_transport.Send(connHandle, bytes, size, 0); };
+
+    // Close the open bundle first if this message would push it past one
+    // datagram; oversized messages then go out alone, keeping order.
+    const size_t added = PacketSerializer::BundledSize(len) +
+                         (bundle.empty() ? sizeof(MsgMessageBundle) : 0);
+    if (!bundle.empty() && bundle.size() + added > kMaxBundleBytes)
+    {
+        sendNow(bundle.data(), bundle.size());
+        bundle.clear();
+    }
+    if (sizeof(MsgMessageBundle) + PacketSerializer::BundledSize(len) > kMaxBundleBytes ||
+        !PacketSerializer::AppendToBundle(bundle, data, len))
+    {
+        sendNow(data, len);
+    }
+}
+
+void GameServer::FlushReliableBundles()
+{
+    NW_TRACE_FUNCTION();
+    if (!m_config.bundleReliable)
         return;
 
-    NBN_GameServer_SendByteArrayTo(
-        it->second.connHandle,
-        const_cast<uint8_t *>(data),
-        static_cast<unsigned int>(len),
-        MapChannel(channel));
+    for (uint32_t i = 0; i < m_clients.Size(); ++i)
+    {
+        std::vector<uint8_t> &bundle = m_clients.cold[i].reliableBundle;
+        if (bundle.empty())
+            continue;
+
+        const auto hdr = PacketSerializer::Read<MsgMessageBundle>(bundle.data(), bundle.size());
+        const uint8_t *bytes = bundle.data();
+        size_t size = bundle.size();
+        if (hdr.messageCount == 1)
+        {
+            // A lone message goes out unwrapped.
+            const size_t prefix = sizeof(MsgMessageBundle) + sizeof(uint16_t);
+            bytes += prefix;
+            size -= prefix;
+        }
+
+        m_transport.Send(m_clients.connHandles[i], bytes, size, 0); // reliable
+        bundle.clear();
+    }
 }
 
 void GameServer::RemoveClient(ClientID clientID, const char *reason, bool closeTransport)
 {
-    auto it = m_clients.find(clientID);
-    if (it == m_clients.end())
+    NW_TRACE_FUNCTION();
+    const uint32_t index = m_clients.Find(clientID);
+    if (index == ClientTable::npos)
         return;
 
-    const bool wasWelcomed = it->second.welcomed;
-    const ClientID removedOwnerID = it->second.id;
-    const NetObjectID removedObjectID = it->second.objectID;
-    const bool shouldNotify = it->second.welcomed && removedObjectID != INVALID_NET_OBJECT_ID;
+    const bool wasWelcomed = m_clients.IsWelcomed(index);
+    const ClientID removedOwnerID = m_clients.ids[index];
+    const NetObjectID removedObjectID = m_clients.objectIDs[index];
+    const bool shouldNotify = wasWelcomed && removedObjectID != INVALID_NET_OBJECT_ID;
 
     if (shouldNotify)
     {
-        std::vector<ClientID> notifyTargets;
-        notifyTargets.reserve(m_clients.size());
-        for (const auto &[id, cs] : m_clients)
-        {
-            (void)id;
-            if (!cs.welcomed || cs.id == removedOwnerID)
-                continue;
-            notifyTargets.push_back(cs.id);
-        }
-        for (ClientID targetID : notifyTargets)
-            SendObjectDespawn(targetID, removedOwnerID, removedObjectID);
+        MsgObjectDespawn despawn;
+        despawn.ownerClientID = removedOwnerID;
+        despawn.objectID = removedObjectID;
+        BroadcastMessage(m_clients.roomIDs[index], despawn, 0, removedOwnerID); // reliable
     }
 
     if (wasWelcomed)
@@ -124,22 +242,18 @@ void GameServer::RemoveClient(ClientID clientID, const char *reason, bool closeT
         BroadcastPlayerMetaRemove(removedOwnerID);
     }
 
-    uint32_t connHandle = it->second.connHandle;
-    if (!it->second.nickname.empty())
-        m_nicknameIndex.erase(NormalizeNickname(it->second.nickname));
+    uint32_t connHandle = m_clients.connHandles[index];
+    if (!m_clients.cold[index].nickname.empty())
+        m_nicknameIndex.erase(NormalizeNickname(m_clients.cold[index].nickname));
 
     if (closeTransport)
-    {
-        if (NBN_GameServer_CloseClient(connHandle) < 0)
-        {
-            std::cerr << "[GameServer] Failed to close transport for client "
-                      << clientID << "\n";
-        }
-    }
+        m_transport.Close(connHandle);
+
     // Keep UUID mapping alive so returning players are recognised.
     // Only remove connection/state tracking.
-    m_clients.erase(it);
+    m_clients.Remove(index);
     m_connIndex.erase(connHandle);
+    m_bandwidth.RemoveClient(connHandle);
 
     std::cout << "[GameServer] Client " << clientID << " " << reason << "\n";
 }
@@ -150,54 +264,627 @@ void GameServer::RemoveTimedOutClients()
         return;
 
     const auto now = std::chrono::steady_clock::now();
-    std::vector<ClientID> timedOutIDs;
-    timedOutIDs.reserve(m_clients.size());
+    std::pmr::vector<ClientID> timedOutIDs(&m_frameArena);
 
-    for (const auto &[id, cs] : m_clients)
+    for (uint32_t i = 0; i < m_clients.Size(); ++i)
     {
-        (void)id;
-        if ((now - cs.lastSeen) > m_clientTimeout)
-            timedOutIDs.push_back(cs.id);
+        if ((now - m_clients.lastSeen[i]) > m_clientTimeout)
+            timedOutIDs.push_back(m_clients.ids[i]);
     }
 
     for (ClientID id : timedOutIDs)
         RemoveClient(id, "timed out", true);
 }
 
+void GameServer::EncodePositions(const NetBroadcastEntry *entries, size_t count,
+                                 FrameChunks &out)
+{
+    const size_t maxPayload = BroadcastChunkPayload();
+    if (m_config.broadcastFormat == BroadcastFormat::Raw)
+    {
+        PacketSerializer::AppendPositionBroadcastChunks(out, entries, count,
+                                                        m_serverTick, maxPayload);
+        return;
+    }
+
+    std::pmr::vector<NetQuantization::QuantizedEntry> quantized(out.get_allocator().resource());
+    quantized.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        quantized.push_back(NetQuantization::QuantizeEntry(entries[i], m_quant));
+    PacketSerializer::AppendPositionBroadcastCompactChunks(
+        out, quantized.data(), quantized.size(), m_serverTick, m_quant, maxPayload);
+}
+
+size_t GameServer::MaxEntriesForBudget(uint32_t budgetBytes) const
+{
+    // Delta packets are budgeted at full compact cost: a baseline may be
+    // missing and unchanged entities are nearly free anyway.
+    size_t overhead = sizeof(MsgPositionBroadcast);
+    size_t entryBits = sizeof(NetBroadcastEntry) * 8;
+    if (m_config.broadcastFormat == BroadcastFormat::Compact)
+        overhead = sizeof(MsgPositionBroadcastCompact);
+    else if (m_config.broadcastFormat == BroadcastFormat::Delta)
+        overhead = sizeof(MsgPositionBroadcastDelta);
+    if (m_config.broadcastFormat != BroadcastFormat::Raw)
+        entryBits = NetQuantization::EntryBits(m_quant);
+    return EntriesWithinBudget(budgetBytes, overhead, entryBits, BroadcastChunkPayload());
+}
+
+size_t GameServer::BroadcastChunkPayload() const
+{
+    // A raw PositionBroadcast has no chunk index, and clients drop any
+    // packet whose serverTick is not newer than the last one, so a split
+    // raw tick would lose every chunk after the first.
+    if (m_config.broadcastFormat == BroadcastFormat::Raw)
+        return 0;
+    return m_config.maxBroadcastPayload;
+}
+
+size_t GameServer::EntriesWithinBudget(uint32_t budgetBytes, size_t overhead,
+                                       size_t entryBits, size_t maxPayload) const
+{
+    const size_t budget = budgetBytes;
+    if (budget <= overhead)
+        return 0;
+    const size_t single = (budget - overhead) * 8 / entryBits;
+
+    // Every chunk of maxPayload repeats the header, so count whole
+    // chunks first, then what fits in a partial one.
+    if (maxPayload <= overhead)
+        return single;
+    const size_t perChunk = std::max<size_t>((maxPayload - overhead) * 8 / entryBits, 1);
+    if (single <= perChunk)
+        return single;
+    const size_t chunkBytes = overhead + (perChunk * entryBits + 7) / 8;
+    const size_t fullChunks = budget / chunkBytes;
+    const size_t rest = budget - fullChunks * chunkBytes;
+    const size_t partial = rest > overhead
+                               ? std::min((rest - overhead) * 8 / entryBits, perChunk - 1)
+                               : 0;
+    return fullChunks * perChunk + partial;
+}
+
+void GameServer::EncodeDeltaFor(const Room &room, uint32_t receiverIndex,
+                                const uint32_t *indices, size_t count, EncodeWorkspace &ws,
+                                FrameChunks &out)
+{
+    ClientColdState &receiver = m_clients.cold[receiverIndex];
+    const uint32_t tick = m_serverTick;
+    const Room::WorldSnapshot &world = room.snapshotRing[tick % kSnapshotHistory];
+    auto &current = ws.deltaCurrent;
+    auto &baseline = ws.deltaBaseline;
+
+    current.clear();
+    for (size_t i = 0; i < count; ++i)
+        current.push_back(world.entries[indices[i]]);
+
+    // Remember what this client is being sent, so a later ack of `tick`
+    // can serve as its baseline.
+    auto &sent = receiver.sentSnapshots[tick % kSnapshotHistory];
+    sent.tick = tick;
+    sent.ids.clear();
+    for (const auto &q : current)
+        sent.ids.push_back(q.clientID);
+
+    // Rebuild the acked baseline from the world ring; fall back to a full
+    // compact snapshot if it has already been overwritten.
+    const uint32_t baseTick = receiver.ackedTick;
+    const bool baselineUsable =
+        baseTick != 0 && tick - baseTick < kSnapshotHistory &&
+        receiver.sentSnapshots[baseTick % kSnapshotHistory].tick == baseTick &&
+        room.snapshotRing[baseTick % kSnapshotHistory].tick == baseTick;
+    const size_t maxPayload = BroadcastChunkPayload();
+    if (!baselineUsable)
+    {
+        PacketSerializer::AppendPositionBroadcastCompactChunks(
+            out, current.data(), current.size(), tick, m_quant, maxPayload);
+        return;
+    }
+
+    const auto &baseIDs = receiver.sentSnapshots[baseTick % kSnapshotHistory].ids;
+    const auto &baseWorld = room.snapshotRing[baseTick % kSnapshotHistory].entries;
+    baseline.clear();
+    for (ClientID id : baseIDs)
+    {
+        auto it = std::lower_bound(baseWorld.begin(), baseWorld.end(), id,
+                                   [](const NetQuantization::QuantizedEntry &q, ClientID cid)
+                                   { return q.clientID < cid; });
+        if (it != baseWorld.end() && it->clientID == id)
+            baseline.push_back(*it);
+    }
+
+    PacketSerializer::AppendPositionBroadcastDeltaChunks(
+        out, baseline.data(), baseline.size(), baseTick,
+        current.data(), current.size(), tick, m_quant, maxPayload);
+}
+
+void GameServer::SelectByPriority(uint32_t receiverIndex, const Room &room,
+                                  std::vector<uint32_t> &candidates, size_t maxEntries)
+{
+    const NetBroadcastEntry *entries = room.entries.data();
+    const ClientHandle *owners = room.entryOwners.data();
+    const ClientID receiverID = m_clients.ids[receiverIndex];
+    const NetTransformState &rt = m_clients.transforms[receiverIndex];
+    const bool hasTransform = m_clients.HasTransformAt(receiverIndex);
+    ClientColdState &cold = m_clients.cold[receiverIndex];
+
+    // Accumulate: nearer and faster-closing entities gain priority faster,
+    // and everything not sent keeps growing so it eventually gets through.
+    for (uint32_t index : candidates)
+    {
+        const NetBroadcastEntry &e = entries[index];
+        if (e.clientID == receiverID)
+            continue; // own entity is always sent, see below
+
+        const NetTransformState &t = e.transform;
+        float distanceFactor = 1.0f;
+        if (hasTransform)
+        {
+            const float dx = t.posX - rt.posX;
+            const float dy = t.posY - rt.posY;
+            const float dz = t.posZ - rt.posZ;
+            const float dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+            distanceFactor = kPriorityNearDistance / (kPriorityNearDistance + dist);
+        }
+
+        const float vx = t.linVelX - rt.linVelX;
+        const float vy = t.linVelY - rt.linVelY;
+        const float vz = t.linVelZ - rt.linVelZ;
+        const float relSpeed = std::sqrt(vx * vx + vy * vy + vz * vz);
+
+        cold.PriorityOf(owners[index]) +=
+            distanceFactor * (1.0f + relSpeed / kPriorityRelSpeedScale);
+    }
+
+    auto priorityOf = [&](uint32_t index)
+    {
+        if (entries[index].clientID == receiverID)
+            return HUGE_VALF;
+        return cold.PeekPriority(owners[index]);
+    };
+
+    std::nth_element(candidates.begin(), candidates.begin() + (maxEntries - 1), candidates.end(),
+                     [&](uint32_t a, uint32_t b)
+                     { return priorityOf(a) > priorityOf(b); });
+    candidates.resize(maxEntries);
+
+    for (uint32_t index : candidates)
+    {
+        if (entries[index].clientID != receiverID)
+            cold.PriorityOf(owners[index]) = 0.0f;
+    }
+}
+
+uint8_t GameServer::SendIntervalFor(uint32_t snapshotsPerSecond) const
+{
+    if (snapshotsPerSecond == 0)
+        snapshotsPerSecond = m_config.sendRate;
+    if (snapshotsPerSecond == 0 || snapshotsPerSecond >= m_config.tickRate)
+        return 1;
+    const uint32_t interval =
+        (m_config.tickRate + snapshotsPerSecond / 2) / snapshotsPerSecond;
+    return static_cast<uint8_t>(std::clamp<uint32_t>(interval, 1, kMaxSendInterval));
+}
+
 void GameServer::BroadcastPositions()
 {
-    // Collect entries from all welcomed clients that have reported.
-    std::vector<NetBroadcastEntry> entries;
-    entries.reserve(m_clients.size());
+    // Everything waiting to be relayed goes out with this broadcast.
+    m_relayPending.clear();
+    m_relaySeq = 0;
+
+    // Rebuild room membership from the clients' room column.
+    for (auto &entry : m_rooms)
+        entry.second->members.clear();
+    for (uint32_t i = 0; i < m_clients.Size(); ++i)
+    {
+        Room *room = EnsureRoom(m_clients.roomIDs[i]);
+        if (!room)
+        {
+            // Only possible if maxRooms shrank; fall back to the lobby.
+            m_clients.roomIDs[i] = DEFAULT_ROOM_ID;
+            room = EnsureRoom(DEFAULT_ROOM_ID);
+        }
+        room->members.push_back(i);
+    }
+
+    m_tickRooms.clear();
+    for (auto it = m_rooms.begin(); it != m_rooms.end();)
+    {
+        Room &room = *it->second;
+        if (room.members.empty() && room.id != DEFAULT_ROOM_ID)
+        {
+            it = m_rooms.erase(it);
+            continue;
+        }
+        if (!room.members.empty())
+            m_tickRooms.push_back(&room);
+        ++it;
+    }
+
+    // 1. Rooms snapshot themselves side by side; each writes only its own
+    //    Room.
+    const BroadcastPlan plan = MakeBroadcastPlan();
+    m_workers.ParallelFor(m_tickRooms.size(), [this, &plan](size_t r, uint32_t)
+                          { PrepareRoomBroadcast(*m_tickRooms[r], plan); });
+
+    // 2. Personalized packets, one job per receiver across all rooms, so a
+    //    single crowded room still spreads over every thread. Jobs read
+    //    the room snapshots and write only their receiver's cold state
+    //    and their thread's workspace.
+    m_encodeJobs.clear();
+    for (Room *room : m_tickRooms)
+    {
+        if (!room->perClient)
+            continue;
+        for (uint32_t i : room->receivers)
+            m_encodeJobs.push_back(EncodeJob{room, i, false});
+    }
+    m_workers.ParallelFor(m_encodeJobs.size(), [this, &plan](size_t j, uint32_t slot)
+                          { EncodeForReceiver(m_encodeJobs[j], plan, *m_workspaces[slot]); });
+
+    // 3. One shared copy per room for everyone who sees all of it.
+    for (const EncodeJob &job : m_encodeJobs)
+    {
+        if (job.full)
+            job.room->fullRecipients.push_back(m_clients.connHandles[job.receiver]);
+    }
+    m_workers.ParallelFor(m_tickRooms.size(), [this](size_t r, uint32_t)
+                          { EncodeRoomFull(*m_tickRooms[r]); });
+
+    // The transport has a single producer: submit everything from here.
+    auto submit = [this](const uint32_t *handles, size_t count,
+                         const uint8_t *data, size_t len)
+    {
+        if (count == 1)
+        {
+            m_bandwidth.Record(BandwidthStats::Out, handles[0], data, len);
+            m_transport.Send(handles[0], data, len, 1); // unreliable
+        }
+        else
+            SendToMany(handles, count, data, len, 1);
+    };
+    for (Room *room : m_tickRooms)
+    {
+        room->outbox.Drain(submit);
+        room->frameArena.Reset();
+    }
+    for (auto &ws : m_workspaces)
+    {
+        ws->outbox.Drain(submit);
+        ws->frameArena.Reset();
+    }
+}
+
+GameServer::BroadcastPlan GameServer::MakeBroadcastPlan() const
+{
+    BroadcastPlan plan;
+    plan.delta = m_config.broadcastFormat == BroadcastFormat::Delta;
 
-    for (const auto &[id, cs] : m_clients)
+    plan.radius = m_config.interestRadius;
+    if (plan.radius > 0.0f && m_watchdog.AtLeast(LoadLevel::ShrinkInterest))
+        plan.radius *= kShrunkInterestScale;
+    if (plan.radius < 0.0f)
+        plan.radius = 0.0f;
+    plan.thinFar = m_watchdog.AtLeast(LoadLevel::ThinFarEntities);
+    plan.farDistance = plan.radius > 0.0f ? plan.radius * kFarEntityFraction : kFarEntityDistance;
+
+    // Per-client byte budget expressed as a number of entries (at least one,
+    // so a client always hears about itself).
+    if (m_config.clientByteBudget > 0)
+        plan.maxEntries = std::max<size_t>(MaxEntriesForBudget(m_config.clientByteBudget), 1);
+    return plan;
+}
+
+void GameServer::PrepareRoomBroadcast(Room &room, const BroadcastPlan &plan)
+{
+    NW_TRACE_FUNCTION();
+    room.receivers.clear();
+    room.entries.clear();
+    room.entryOwners.clear();
+    room.fullRecipients.clear();
+    room.perClient = false;
+
+    // Canonical clientID order, shared with the client's delta baselines:
+    // entries collected in member order come out sorted.
+    std::sort(room.members.begin(), room.members.end(), [this](uint32_t a, uint32_t b)
+              { return m_clients.ids[a] < m_clients.ids[b]; });
+    room.memberHandles.clear();
+    for (uint32_t i : room.members)
+        room.memberHandles.push_back(m_clients.HandleOf(i));
+
+    // Members due a broadcast this tick. Clients on every Nth tick are
+    // staggered by ClientID, so each tick serves an even share of them.
+    for (uint32_t i : room.members)
+    {
+        const uint32_t interval = m_clients.sendIntervals[i];
+        if (m_clients.IsWelcomed(i) && (m_serverTick + m_clients.ids[i]) % interval == 0)
+            room.receivers.push_back(i);
+    }
+    if (room.receivers.empty())
+        return;
+
+    // Collect entries from all welcomed members that have reported.
+    constexpr uint8_t kBroadcastable = ClientTable::Welcomed | ClientTable::HasTransform;
+    for (uint32_t i : room.members)
     {
-        (void)id;
-        if (!cs.welcomed || !cs.hasTransform)
+        if ((m_clients.flags[i] & kBroadcastable) != kBroadcastable)
             continue;
 
         NetBroadcastEntry e;
-        e.clientID = cs.id;
-        e.objectID = cs.objectID;
-        e.transform = cs.lastTransform;
-        entries.push_back(e);
+        e.clientID = m_clients.ids[i];
+        e.objectID = m_clients.objectIDs[i];
+        e.transform = m_clients.transforms[i];
+        room.entries.push_back(e);
+        room.entryOwners.push_back(m_clients.HandleOf(i));
     }
 
-    if (entries.empty())
+    if (room.entries.empty())
+    {
+        room.receivers.clear();
         return;
+    }
 
-    auto pkt = PacketSerializer::WritePositionBroadcast(entries, m_serverTick);
+    if (plan.delta)
+    {
+        Room::WorldSnapshot &world = room.snapshotRing[m_serverTick % kSnapshotHistory];
+        world.tick = m_serverTick;
+        world.entries.clear();
+        for (const auto &e : room.entries)
+            world.entries.push_back(NetQuantization::QuantizeEntry(e, m_quant));
+    }
 
-    for (auto &[id, cs] : m_clients)
+    // Clients sharing the whole-room copy are left unthinned: splitting
+    // them into per-client encodes would cost more than it sheds.
+    if (!plan.delta && plan.radius <= 0.0f &&
+        (plan.maxEntries == 0 || room.entries.size() <= plan.maxEntries))
     {
-        (void)id;
-        if (!cs.welcomed)
+        for (uint32_t i : room.receivers)
+            room.fullRecipients.push_back(m_clients.connHandles[i]);
+        return;
+    }
+
+    // Interest management: each client only hears about entities inside
+    // its own area of interest (always including itself).
+    if (plan.radius > 0.0f)
+        room.interestGrid.Build(room.entries.data(), room.entries.size(), plan.radius);
+    room.perClient = true;
+}
+
+void GameServer::EncodeForReceiver(EncodeJob &job, const BroadcastPlan &plan,
+                                   EncodeWorkspace &ws)
+{
+    NW_TRACE_FUNCTION();
+    const Room &room = *job.room;
+    const uint32_t i = job.receiver;
+    const auto &entries = room.entries;
+    auto &candidates = ws.candidates;
+
+    candidates.clear();
+    if (plan.radius > 0.0f && m_clients.HasTransformAt(i))
+    {
+        const NetTransformState &t = m_clients.transforms[i];
+        room.interestGrid.QueryRadius(t.posX, t.posY, t.posZ, plan.radius,
+                                      [&](uint32_t index)
+                                      { candidates.push_back(index); });
+    }
+    else
+    {
+        for (uint32_t e = 0; e < static_cast<uint32_t>(entries.size()); ++e)
+            candidates.push_back(e);
+    }
+
+    if (plan.thinFar && m_clients.HasTransformAt(i))
+    {
+        // Alternate far entities between this client's broadcasts,
+        // half of them on each.
+        const NetTransformState &rt = m_clients.transforms[i];
+        const ClientID receiverID = m_clients.ids[i];
+        const uint32_t sendIndex = m_serverTick / m_clients.sendIntervals[i];
+        const float farSq = plan.farDistance * plan.farDistance;
+        candidates.erase(
+            std::remove_if(candidates.begin(), candidates.end(),
+                           [&](uint32_t index)
+                           {
+                               const NetBroadcastEntry &e = entries[index];
+                               if (e.clientID == receiverID || ((sendIndex + e.clientID) & 1) == 0)
+                                   return false;
+                               const float dx = e.transform.posX - rt.posX;
+                               const float dy = e.transform.posY - rt.posY;
+                               const float dz = e.transform.posZ - rt.posZ;
+                               return dx * dx + dy * dy + dz * dz > farSq;
+                           }),
+            candidates.end());
+    }
+
+    if (plan.maxEntries > 0 && candidates.size() > plan.maxEntries)
+        SelectByPriority(i, room, candidates, plan.maxEntries);
+
+    if (candidates.empty())
+        return;
+
+    FrameChunks chunks(&ws.frameArena);
+    if (plan.delta)
+    {
+        // Indices follow clientID order since `entries` is sorted.
+        std::sort(candidates.begin(), candidates.end());
+        EncodeDeltaFor(room, i, candidates.data(), candidates.size(), ws, chunks);
+    }
+    else if (candidates.size() == entries.size())
+    {
+        job.full = true;
+        return;
+    }
+    else
+    {
+        ws.visible.clear();
+        for (uint32_t index : candidates)
+            ws.visible.push_back(entries[index]);
+        EncodePositions(ws.visible.data(), ws.visible.size(), chunks);
+    }
+
+    const uint32_t connHandle = m_clients.connHandles[i];
+    for (auto &pkt : chunks)
+        ws.outbox.Send(connHandle, pkt.data(), pkt.size()); // unreliable for position broadcast
+}
+
+void GameServer::EncodeRoomFull(Room &room)
+{
+    NW_TRACE_FUNCTION();
+    if (room.fullRecipients.empty())
+        return;
+    FrameChunks chunks(&room.frameArena);
+    EncodePositions(room.entries.data(), room.entries.size(), chunks);
+    for (auto &pkt : chunks)
+        room.outbox.SendMany(room.fullRecipients.data(), room.fullRecipients.size(),
+                             pkt.data(), pkt.size()); // unreliable
+}
+
+void GameServer::FlushRelay()
+{
+    NW_TRACE_FUNCTION();
+    std::sort(m_relayPending.begin(), m_relayPending.end());
+    m_relayPending.erase(std::unique(m_relayPending.begin(), m_relayPending.end()),
+                         m_relayPending.end());
+
+    constexpr uint8_t kBroadcastable = ClientTable::Welcomed | ClientTable::HasTransform;
+    std::pmr::vector<uint32_t> subjects(&m_frameArena);
+    for (ClientHandle h : m_relayPending)
+    {
+        const uint32_t index = m_clients.Resolve(h);
+        if (index != ClientTable::npos &&
+            (m_clients.flags[index] & kBroadcastable) == kBroadcastable)
+            subjects.push_back(index);
+    }
+    m_relayPending.clear();
+
+    // Group by room, clientID order inside each room.
+    std::sort(subjects.begin(), subjects.end(), [this](uint32_t a, uint32_t b)
+              {
+                  if (m_clients.roomIDs[a] != m_clients.roomIDs[b])
+                      return m_clients.roomIDs[a] < m_clients.roomIDs[b];
+                  return m_clients.ids[a] < m_clients.ids[b];
+              });
+
+    // Relays are numbered from 1 after each tick broadcast, so clients
+    // order them between that broadcast and the next.
+    ++m_relaySeq;
+    const uint32_t tick = m_serverTick;
+    const uint16_t seq = m_relaySeq;
+
+    // The per-client byte budget applies to every relay packet as it does
+    // to a tick broadcast; over budget, the nearest entities go first.
+    // Relays are never split (0 below): a packet has no chunk index, so
+    // clients would drop a second one with the same (tick, seq).
+    const float radius = m_config.interestRadius;
+    size_t maxEntries = 0;
+    if (m_config.clientByteBudget > 0)
+        maxEntries = std::max<size_t>(
+            EntriesWithinBudget(m_config.clientByteBudget, sizeof(MsgPositionRelay),
+                                sizeof(NetBroadcastEntry) * 8, 0),
+            1);
+
+    std::pmr::vector<NetBroadcastEntry> entries(&m_frameArena);
+    std::pmr::vector<NetBroadcastEntry> visible(&m_frameArena);
+    FrameChunks chunks(&m_frameArena);
+    for (size_t begin = 0; begin < subjects.size();)
+    {
+        const RoomID roomID = m_clients.roomIDs[subjects[begin]];
+        size_t end = begin;
+        while (end < subjects.size() && m_clients.roomIDs[subjects[end]] == roomID)
+            ++end;
+
+        // Peers come from the membership of the last tick; anyone who
+        // joined since hears about these updates with the next tick.
+        auto it = m_rooms.find(roomID);
+        if (it == m_rooms.end() || it->second->members.size() > m_config.relayMaxRoomSize)
+        {
+            begin = end;
             continue;
+        }
+        entries.clear();
+        for (size_t k = begin; k < end; ++k)
+        {
+            const uint32_t i = subjects[k];
+            NetBroadcastEntry e;
+            e.clientID = m_clients.ids[i];
+            e.objectID = m_clients.objectIDs[i];
+            e.transform = m_clients.transforms[i];
+            entries.push_back(e);
+        }
+        begin = end;
 
-        NBN_GameServer_SendByteArrayTo(
-            cs.connHandle,
-            pkt.data(),
-            static_cast<unsigned int>(pkt.size()),
-            NBN_CHANNEL_RESERVED_UNRELIABLE); // unreliable for position broadcast
+        // Without AOI everyone in the room hears every relay, as with the
+        // tick broadcast. Clients on a reduced broadcast rate
+        // (SnapshotRate) asked for less traffic and catch up at their
+        // next broadcast instead.
+        m_broadcastHandles.clear();
+        for (ClientHandle h : it->second->memberHandles)
+        {
+            const uint32_t i = m_clients.Resolve(h);
+            if (i == ClientTable::npos || m_clients.roomIDs[i] != roomID ||
+                !m_clients.IsWelcomed(i) || m_clients.sendIntervals[i] > 1)
+                continue;
+            const bool hasTransform = m_clients.HasTransformAt(i);
+            const bool filter = radius > 0.0f && hasTransform;
+            if (!filter && (maxEntries == 0 || entries.size() <= maxEntries))
+            {
+                m_broadcastHandles.push_back(m_clients.connHandles[i]);
+                continue;
+            }
+
+            const NetTransformState &rt = m_clients.transforms[i];
+            auto distSq = [&rt](const NetBroadcastEntry &e)
+            {
+                const float dx = e.transform.posX - rt.posX;
+                const float dy = e.transform.posY - rt.posY;
+                const float dz = e.transform.posZ - rt.posZ;
+                return dx * dx + dy * dy + dz * dz;
+            };
+            visible.clear();
+            for (const NetBroadcastEntry &e : entries)
+            {
+                if (!filter || distSq(e) <= radius * radius)
+                    visible.push_back(e);
+            }
+            if (maxEntries > 0 && visible.size() > maxEntries)
+            {
+                if (hasTransform)
+                {
+                    std::nth_element(visible.begin(), visible.begin() + (maxEntries - 1),
+                                     visible.end(),
+                                     [&](const NetBroadcastEntry &a, const NetBroadcastEntry &b)
+                                     { return distSq(a) < distSq(b); });
+                    visible.resize(maxEntries);
+                    std::sort(visible.begin(), visible.end(),
+                              [](const NetBroadcastEntry &a, const NetBroadcastEntry &b)
+                              { return a.clientID < b.clientID; });
+                }
+                else
+                {
+                    visible.resize(maxEntries);
+                }
+            }
+            if (visible.empty())
+                continue;
+            chunks.clear();
+            PacketSerializer::AppendPositionRelayChunks(chunks, visible.data(), visible.size(),
+                                                        tick, seq, 0);
+            for (auto &pkt : chunks)
+            {
+                m_bandwidth.Record(BandwidthStats::Out, m_clients.connHandles[i], pkt.data(), pkt.size());
+                m_transport.Send(m_clients.connHandles[i], pkt.data(), pkt.size(), 1); // unreliable
+            }
+        }
+
+        if (m_broadcastHandles.empty())
+            continue;
+        chunks.clear();
+        PacketSerializer::AppendPositionRelayChunks(chunks, entries.data(), entries.size(),
+                                                    tick, seq, 0);
+        for (auto &pkt : chunks)
+            SendToMany(m_broadcastHandles.data(), m_broadcastHandles.size(),
+                       pkt.data(), pkt.size(), 1); // unreliable
     }
+
+    m_transport.Flush();
 }
@@ -0,0 +1,132 @@
+// ────────────────────────────────────────────────────────────────────
+// Per-phase tick profiler
+// ────────────────────────────────────────────────────────────────────
+
+#include "TickProfiler.h"
+#include "Engine/Network/Protocol/MessageTypes.h"
+
+#include <cstdio>
+#include <iostream>
+
+namespace
+{
+    /// Client → server messages, the ones DispatchPacket handles.
+    const char *MessageName(uint8_t type)
+    {
+        switch (static_cast<NetMessageType>(type))
+        {
+        case NetMessageType::ClientHello:
+            return "ClientHello";
+        case NetMessageType::ClientDisconnect:
+            return "ClientDisconnect";
+        case NetMessageType::Heartbeat:
+            return "Heartbeat";
+        case NetMessageType::PositionUpdate:
+            return "PositionUpdate";
+        case NetMessageType::ObjectRelease:
+            return "ObjectRelease";
+        case NetMessageType::SnapshotAck:
+            return "SnapshotAck";
+        case NetMessageType::SnapshotRate:
+            return "SnapshotRate";
+        case NetMessageType::RoomJoin:
+            return "RoomJoin";
+        case NetMessageType::RoomLeave:
+            return "RoomLeave";
+        case NetMessageType::ChatRequest:
+            return "ChatRequest";
+        case NetMessageType::NicknameUpdateRequest:
+            return "NicknameUpdateRequest";
+        default:
+            return nullptr;
+        }
+    }
+
+    void LogRow(const char *name, const LatencyHistogram &h)
+    {
+        // Microseconds with one decimal; handlers often take well under one.
+        char line[160];
+        std::snprintf(line, sizeof(line), "[GameServer]   %-22s %9llu  %8.1f %8.1f %8.1f %8.1f\n", name,
+                      static_cast<unsigned long long>(h.Count()), h.Percentile(0.50) / 1000.0,
+                      h.Percentile(0.99) / 1000.0, h.Percentile(0.999) / 1000.0, h.Max() / 1000.0);
+        std::cout << line;
+    }
+}
+
+void TickProfiler::Report()
+{
+    Log("last window", m_window);
+    FoldWindow();
+}
+
+void TickProfiler::ReportTotals()
+{
+    FoldWindow();
+    Log("whole run", m_total);
+}
+
+void TickProfiler::FoldWindow()
+{
+    for (uint32_t p = 0; p < kTickPhaseCount; ++p)
+    {
+        m_total.phases[p].Merge(m_window.phases[p]);
+        m_window.phases[p].Reset();
+    }
+    for (size_t t = 0; t < m_window.handlers.size(); ++t)
+    {
+        if (!m_window.handlers[t])
+            continue;
+        if (!m_total.handlers[t])
+            m_total.handlers[t] = std::make_unique<LatencyHistogram>();
+        m_total.handlers[t]->Merge(*m_window.handlers[t]);
+        m_window.handlers[t]->Reset();
+    }
+}
+
+void TickProfiler::Log(const char *title, const Histograms &h)
+{
+    const LatencyHistogram &ticks = h.phases[static_cast<size_t>(TickPhase::Tick)];
+    if (ticks.Count() == 0)
+        return;
+
+    std::cout << "[GameServer] Tick profile, " << title << " (us):\n";
+    char header[160];
+    std::snprintf(header, sizeof(header), "[GameServer]   %-22s %9s  %8s %8s %8s %8s\n", "", "samples",
+                  "p50", "p99", "p99.9", "max");
+    std::cout << header;
+    for (uint32_t p = 0; p < kTickPhaseCount; ++p)
+        LogRow(PhaseName(static_cast<TickPhase>(p)), h.phases[p]);
+
+    for (size_t t = 0; t < h.handlers.size(); ++t)
+    {
+        if (!h.handlers[t] || h.handlers[t]->Count() == 0)
+            continue;
+        char name[32];
+        const char *known = MessageName(static_cast<uint8_t>(t));
+        if (known)
+            std::snprintf(name, sizeof(name), "on %s", known);
+        else
+            std::snprintf(name, sizeof(name), "on type 0x%02zx", t);
+        LogRow(name, *h.handlers[t]);
+    }
+}
+
+const char *TickProfiler::PhaseName(TickPhase phase)
+{
+    switch (phase)
+    {
+    case TickPhase::Deferred:
+        return "deferred work";
+    case TickPhase::Poll:
+        return "poll + handlers";
+    case TickPhase::Timeouts:
+        return "timeouts";
+    case TickPhase::Broadcast:
+        return "broadcast";
+    case TickPhase::Flush:
+        return "flush";
+    case TickPhase::Tick:
+        return "tick";
+    }
+    return "?";
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "LatencyHistogram.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+/// Phases of GameServer::Tick(), timed separately.
+enum class TickPhase : uint8_t
+{
+    Deferred,  // work put off by load shedding
+    Poll,      // network events and message handlers
+    Timeouts,  // timed-out client removal
+    Broadcast, // position broadcasts
+    Flush,     // reliable bundles and the transport flush
+    Tick,      // the whole tick
+};
+
+constexpr uint32_t kTickPhaseCount = static_cast<uint32_t>(TickPhase::Tick) + 1;
+
+/// Always-on tick instrumentation: one latency histogram per tick phase
+/// and per received message type.
+///
+/// Samples go into the current window; Report() logs the window's
+/// percentiles, folds it into the totals for the run and starts a new
+/// one. Handler histograms are created the first time a message type
+/// arrives, everything else is allocated up front.
+class TickProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void RecordPhase(TickPhase phase, Clock::duration elapsed)
+    {
+        m_window.phases[static_cast<size_t>(phase)].Record(Nanoseconds(elapsed));
+    }
+
+    void RecordHandler(uint8_t messageType, Clock::duration elapsed)
+    {
+        std::unique_ptr<LatencyHistogram> &h = m_window.handlers[messageType];
+        if (!h)
+            h = std::make_unique<LatencyHistogram>();
+        h->Record(Nanoseconds(elapsed));
+    }
+
+    /// Log this window's p50/p99/p999/max and start a new window.
+    void Report();
+    /// Log the whole run (pending window included), e.g. on shutdown.
+    void ReportTotals();
+
+    static const char *PhaseName(TickPhase phase);
+
+private:
+    struct Histograms
+    {
+        std::array<LatencyHistogram, kTickPhaseCount> phases;
+        std::array<std::unique_ptr<LatencyHistogram>, 256> handlers;
+    };
+
+    static uint64_t Nanoseconds(Clock::duration d)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    void FoldWindow();
+    static void Log(const char *title, const Histograms &h);
+
+    Histograms m_window;
+    Histograms m_total;
+};
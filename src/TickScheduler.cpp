@@ -0,0 +1,143 @@
+// ────────────────────────────────────────────────────────────────────
+// Fixed-timestep tick scheduler
+// ────────────────────────────────────────────────────────────────────
+
+#include "TickScheduler.h"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#elif defined(__linux__)
+#include <cerrno>
+#include <sys/prctl.h>
+#include <time.h>
+#endif
+
+namespace
+{
+    // The last stretch before a deadline is spun instead of slept, to
+    // absorb the OS wake-up latency. The window adapts to the oversleep
+    // actually observed, within these bounds.
+#if defined(_WIN32)
+    constexpr std::chrono::microseconds kMinSpinWindow{1000};
+#else
+    constexpr std::chrono::microseconds kMinSpinWindow{100};
+#endif
+    constexpr std::chrono::microseconds kMaxSpinWindow{2000};
+
+    // CatchUp runs at most this many late ticks back to back before
+    // giving up on the missed ones and re-syncing to the phase.
+    constexpr uint32_t kMaxCatchUpTicks = 3;
+
+    void SleepUntilCoarse(std::chrono::steady_clock::time_point wake)
+    {
+#if defined(_WIN32)
+        // Waitable timers take relative due times in 100 ns units.
+        static thread_local HANDLE s_timer = CreateWaitableTimerExW(
+            nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        const auto remaining = wake - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero())
+            return;
+        if (!s_timer)
+        {
+            std::this_thread::sleep_for(remaining);
+            return;
+        }
+        LARGE_INTEGER due;
+        due.QuadPart = -static_cast<LONGLONG>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+        if (SetWaitableTimer(s_timer, &due, 0, nullptr, nullptr, FALSE))
+            WaitForSingleObject(s_timer, INFINITE);
+#elif defined(__linux__)
+        // libstdc++/libc++ steady_clock is CLOCK_MONOTONIC.
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            wake.time_since_epoch())
+                            .count();
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+        {
+        }
+#else
+        std::this_thread::sleep_until(wake);
+#endif
+    }
+}
+
+TickScheduler::TickScheduler(uint32_t tickRate, TickOverrunPolicy policy)
+    : m_interval(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::nanoseconds(1000000000 / std::max<uint32_t>(tickRate, 1)))),
+      m_policy(policy)
+{
+}
+
+void TickScheduler::Start()
+{
+#if defined(__linux__)
+    // Default timer slack (50 us) would be added to every wake-up.
+    prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+#endif
+    m_spinWindow = kMinSpinWindow;
+    m_stats = Stats{};
+    Resync();
+}
+
+void TickScheduler::Resync()
+{
+    m_deadline = Clock::now();
+    m_catchUpRun = 0;
+}
+
+void TickScheduler::WaitNextTick()
+{
+    m_deadline += m_interval;
+    ++m_stats.ticks;
+
+    const Clock::time_point now = Clock::now();
+    if (now >= m_deadline)
+    {
+        ++m_stats.overruns;
+        if (m_policy == TickOverrunPolicy::CatchUp && ++m_catchUpRun <= kMaxCatchUpTicks)
+            return; // due already: run it right away
+
+        // Drop every deadline already in the past, staying on the phase.
+        const auto behind = (now - m_deadline) / m_interval + 1;
+        m_deadline += behind * m_interval;
+        m_stats.skippedTicks += static_cast<uint64_t>(behind);
+    }
+    m_catchUpRun = 0;
+
+    const Clock::time_point wakeTarget = m_deadline - m_spinWindow;
+    Clock::time_point woke = Clock::now();
+    if (woke < wakeTarget)
+    {
+        SleepUntilCoarse(wakeTarget);
+        woke = Clock::now();
+
+        // Widen at once after an oversleep, shrink back slowly.
+        const Clock::duration overshoot = woke - wakeTarget;
+        m_spinWindow = std::clamp<Clock::duration>(
+            std::max<Clock::duration>(m_spinWindow - m_spinWindow / 16,
+                                      overshoot + kMinSpinWindow),
+            kMinSpinWindow, kMaxSpinWindow);
+    }
+    while (woke < m_deadline)
+    {
+        std::this_thread::yield();
+        woke = Clock::now();
+    }
+
+    const Clock::duration lateness = woke - m_deadline;
+    ++m_stats.wakeUps;
+    m_stats.totalLateness += lateness;
+    m_stats.maxLateness = std::max(m_stats.maxLateness, lateness);
+}
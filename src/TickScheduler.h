@@ -0,0 +1,59 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/// What to do when a tick runs past the next tick's deadline.
+enum class TickOverrunPolicy : uint8_t
+{
+    CatchUp, // run the missed ticks back to back (bounded), keeping the phase
+    Skip,    // drop the missed ticks and wait for the next future deadline
+};
+
+/// Fixed-timestep scheduler built on absolute deadlines.
+///
+/// Deadline n is start + n * interval, so sleep inaccuracy never
+/// accumulates into drift. Waiting sleeps until shortly before the
+/// deadline (clock_nanosleep with TIMER_ABSTIME and minimal timer slack
+/// on Linux, a high-resolution waitable timer on Windows) and spins the
+/// rest, keeping wake-up lateness in the tens of microseconds. The spin
+/// window follows the oversleep the OS actually delivers.
+class TickScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Timing of the ticks since the last ResetWindow().
+    struct Stats
+    {
+        uint64_t ticks = 0;
+        uint64_t overruns = 0;     // ticks that started after the next deadline
+        uint64_t skippedTicks = 0; // deadlines dropped (Skip, or catch-up limit)
+        uint64_t wakeUps = 0;      // ticks that slept; lateness is sampled on these
+        Clock::duration totalLateness{};
+        Clock::duration maxLateness{};
+    };
+
+    TickScheduler(uint32_t tickRate, TickOverrunPolicy policy);
+
+    /// Make now the phase origin; the first deadline is one interval away.
+    void Start();
+    /// Like Start() but keeps the stats window (after an idle period).
+    void Resync();
+
+    /// Block until the next tick is due.
+    void WaitNextTick();
+
+    Clock::duration Interval() const { return m_interval; }
+    /// When the tick after the current one is due.
+    Clock::time_point NextDeadline() const { return m_deadline + m_interval; }
+    const Stats &WindowStats() const { return m_stats; }
+    void ResetWindow() { m_stats = Stats{}; }
+
+private:
+    Clock::duration m_interval;
+    TickOverrunPolicy m_policy;
+    Clock::time_point m_deadline{};
+    uint32_t m_catchUpRun = 0;        // consecutive ticks started late
+    Clock::duration m_spinWindow{}; // spun before each deadline, adaptive
+    Stats m_stats;
+};
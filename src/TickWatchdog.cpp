@@ -0,0 +1,97 @@
+// ────────────────────────────────────────────────────────────────────
+// Tick budget watchdog
+// ────────────────────────────────────────────────────────────────────
+
+#include "TickWatchdog.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Load is judged over windows of a quarter second.
+    constexpr uint32_t kWindowsPerSecond = 4;
+
+    // A window is overloaded above this share of the budget and
+    // comfortable below the lower one; in between the level holds.
+    constexpr float kOverloadedLoad = 0.9f;
+    constexpr float kComfortableLoad = 0.6f;
+
+    // Escalate after half a second of overload, recover one step after
+    // two seconds of headroom.
+    constexpr uint32_t kEscalateWindows = 2;
+    constexpr uint32_t kRecoverWindows = 8;
+}
+
+TickWatchdog::TickWatchdog(uint32_t tickRate, LoadLevel maxLevel)
+    : m_budget(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::nanoseconds(1000000000 / std::max<uint32_t>(tickRate, 1)))),
+      m_maxLevel(maxLevel),
+      m_windowTicks(std::max<uint32_t>(tickRate / kWindowsPerSecond, 1))
+{
+}
+
+bool TickWatchdog::RecordTick(Clock::duration work)
+{
+    ++m_stats.ticks;
+    ++m_stats.ticksAtLevel[static_cast<size_t>(m_level)];
+    m_stats.totalWork += work;
+    m_stats.maxWork = std::max(m_stats.maxWork, work);
+    if (work > m_budget)
+        ++m_stats.overBudgetTicks;
+
+    m_workInWindow += work;
+    if (++m_ticksInWindow < m_windowTicks)
+        return false;
+
+    m_lastLoad = static_cast<float>(m_workInWindow.count()) /
+                 static_cast<float>(m_budget.count() * m_ticksInWindow);
+    m_ticksInWindow = 0;
+    m_workInWindow = Clock::duration::zero();
+
+    if (m_lastLoad > kOverloadedLoad)
+    {
+        m_coolWindows = 0;
+        if (++m_hotWindows >= kEscalateWindows && m_level < m_maxLevel)
+        {
+            m_hotWindows = 0;
+            m_level = static_cast<LoadLevel>(static_cast<uint8_t>(m_level) + 1);
+            ++m_stats.escalations;
+            return true;
+        }
+    }
+    else if (m_lastLoad < kComfortableLoad)
+    {
+        m_hotWindows = 0;
+        if (++m_coolWindows >= kRecoverWindows && m_level > LoadLevel::Normal)
+        {
+            m_coolWindows = 0;
+            m_level = static_cast<LoadLevel>(static_cast<uint8_t>(m_level) - 1);
+            ++m_stats.recoveries;
+            return true;
+        }
+    }
+    else
+    {
+        m_hotWindows = 0;
+        m_coolWindows = 0;
+    }
+    return false;
+}
+
+const char *TickWatchdog::LevelName(LoadLevel level)
+{
+    switch (level)
+    {
+    case LoadLevel::Normal:
+        return "normal";
+    case LoadLevel::ThinFarEntities:
+        return "thin far entities";
+    case LoadLevel::ShrinkInterest:
+        return "shrink interest";
+    case LoadLevel::DeferNonCritical:
+        return "defer non-critical";
+    case LoadLevel::RejectConnections:
+        return "reject connections";
+    }
+    return "?";
+}
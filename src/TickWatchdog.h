@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+/// Load-shedding steps. Each level keeps the measures of the ones below.
+enum class LoadLevel : uint8_t
+{
+    Normal,
+    ThinFarEntities,   // far entities go out every other broadcast
+    ShrinkInterest,    // area-of-interest radius scaled down
+    DeferNonCritical,  // metadata snapshots and chat wait for the next tick
+    RejectConnections, // new connections are refused
+};
+
+constexpr uint32_t kLoadLevelCount = static_cast<uint32_t>(LoadLevel::RejectConnections) + 1;
+
+/// Tracks how much of the tick budget the simulation uses and picks a
+/// load level from it.
+///
+/// Tick work is averaged over short windows. Several overloaded windows
+/// in a row raise the level one step; a longer run of comfortable windows
+/// lowers it one step, so the server recovers on its own without
+/// flapping between levels.
+class TickWatchdog
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Counters since the last ResetWindow().
+    struct Stats
+    {
+        uint64_t ticks = 0;
+        uint64_t overBudgetTicks = 0; // work alone exceeded the tick interval
+        Clock::duration totalWork{};
+        Clock::duration maxWork{};
+        uint32_t escalations = 0;
+        uint32_t recoveries = 0;
+        std::array<uint64_t, kLoadLevelCount> ticksAtLevel{};
+    };
+
+    /// `maxLevel` caps how far shedding may go (Normal = measure only).
+    TickWatchdog(uint32_t tickRate, LoadLevel maxLevel);
+
+    /// Record one tick's work. Returns true when the level changed.
+    bool RecordTick(Clock::duration work);
+
+    LoadLevel Level() const { return m_level; }
+    bool AtLeast(LoadLevel level) const { return m_level >= level; }
+    /// Work / budget over the last completed window (1.0 = fully used).
+    float LastLoad() const { return m_lastLoad; }
+    Clock::duration Budget() const { return m_budget; }
+
+    const Stats &WindowStats() const { return m_stats; }
+    void ResetWindow() { m_stats = Stats{}; }
+
+    static const char *LevelName(LoadLevel level);
+
+private:
+    Clock::duration m_budget;
+    LoadLevel m_maxLevel;
+    LoadLevel m_level = LoadLevel::Normal;
+    uint32_t m_windowTicks;
+    uint32_t m_ticksInWindow = 0;
+    Clock::duration m_workInWindow{};
+    uint32_t m_hotWindows = 0;  // consecutive overloaded windows
+    uint32_t m_coolWindows = 0; // consecutive comfortable windows
+    float m_lastLoad = 0.0f;
+    Stats m_stats;
+};
@@ -0,0 +1,243 @@
+// ────────────────────────────────────────────────────────────────────
+// Scoped-event tracer with Chrome trace JSON export
+// ────────────────────────────────────────────────────────────────────
+
+#include "Tracer.h"
+
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Tracer
+{
+    std::atomic<bool> g_recording{false};
+}
+
+namespace
+{
+    using Tracer::Clock;
+
+    // Per recording thread: ~6 MB, some 20 s of a 200-client tick thread.
+    constexpr uint64_t kEventsPerThread = uint64_t{1} << 18;
+
+    struct Event
+    {
+        const char *name;
+        int64_t beginNs; // steady_clock
+        int64_t endNs;
+    };
+
+    /// One thread's ring. Only its owner writes, and only while recording;
+    /// a dump reads it once recording has stopped and `writing` is clear.
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> events{new Event[kEventsPerThread]};
+        std::atomic<uint64_t> head{0};
+        std::atomic<bool> writing{false};
+        std::atomic<const char *> name{nullptr};
+        uint32_t tid = 0;
+    };
+
+    /// Events copied out of one buffer for the writer thread.
+    struct ThreadTrace
+    {
+        uint32_t tid;
+        const char *name;
+        std::vector<Event> events;
+    };
+
+    // Buffers live as long as the process: a thread may exit while a
+    // dump still reads its events.
+    std::mutex g_registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+    thread_local ThreadBuffer *t_buffer = nullptr;
+    thread_local const char *t_threadName = nullptr;
+
+    std::atomic<bool> g_toggleRequested{false};
+    std::atomic<int64_t> g_startNs{0};
+    // Main loop only.
+    Clock::time_point g_stopAt = Clock::time_point::max();
+    std::thread g_writer;
+    uint32_t g_dumps = 0;
+    // Set while the writer thread still copies the buffers; recording
+    // must not restart until it is done.
+    std::atomic<bool> g_collecting{false};
+
+    int64_t Nanoseconds(Clock::time_point t)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    ThreadBuffer &LocalBuffer()
+    {
+        if (!t_buffer)
+        {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->name.store(t_threadName, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            buffer->tid = static_cast<uint32_t>(g_buffers.size()) + 1;
+            t_buffer = buffer.get();
+            g_buffers.push_back(std::move(buffer));
+        }
+        return *t_buffer;
+    }
+
+    /// Copy every event recorded since `startNs`. Recording must already
+    /// be stopped: each buffer is read once its owner has finished the
+    /// event it was writing, after which nothing writes it again.
+    std::vector<ThreadTrace> CollectSince(const std::vector<ThreadBuffer *> &buffers,
+                                          int64_t startNs)
+    {
+        std::vector<ThreadTrace> traces;
+        for (ThreadBuffer *buffer : buffers)
+        {
+            while (buffer->writing.load(std::memory_order_seq_cst))
+                std::this_thread::yield();
+
+            const uint64_t end = buffer->head.load(std::memory_order_acquire);
+            const uint64_t begin = end > kEventsPerThread ? end - kEventsPerThread : 0;
+            ThreadTrace trace{buffer->tid, buffer->name.load(std::memory_order_relaxed), {}};
+            for (uint64_t i = begin; i < end; ++i)
+            {
+                const Event &e = buffer->events[i & (kEventsPerThread - 1)];
+                if (e.beginNs >= startNs)
+                    trace.events.push_back(e);
+            }
+            if (!trace.events.empty())
+                traces.push_back(std::move(trace));
+        }
+        return traces;
+    }
+
+    void WriteJson(const std::string &path, const std::vector<ThreadTrace> &traces, int64_t startNs)
+    {
+        std::FILE *f = std::fopen(path.c_str(), "w");
+        if (!f)
+        {
+            std::cerr << "[Tracer] Cannot write " << path << "\n";
+            return;
+        }
+
+        size_t count = 0;
+        std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        std::fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                        "\"args\":{\"name\":\"Neural_Wings-server\"}}");
+        for (const ThreadTrace &trace : traces)
+        {
+            std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                            "\"args\":{\"name\":\"%s\"}}",
+                         trace.tid, trace.name ? trace.name : "thread");
+            for (const Event &e : trace.events)
+            {
+                // Complete events, microseconds since the recording began.
+                std::fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"server\",\"ph\":\"X\",\"pid\":1,"
+                                "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                             e.name, trace.tid, (e.beginNs - startNs) / 1000.0,
+                             (e.endNs - e.beginNs) / 1000.0);
+            }
+            count += trace.events.size();
+        }
+        std::fprintf(f, "\n]}\n");
+        std::fclose(f);
+        std::cout << "[Tracer] Wrote " << count << " events to " << path << "\n";
+    }
+}
+
+void Tracer::Record(const char *name, Clock::time_point begin, Clock::time_point end)
+{
+    ThreadBuffer &buffer = LocalBuffer();
+
+    // Pairs with StopAndDump: either the dump sees this event in progress
+    // and waits for it, or this sees recording stopped and drops it (a
+    // scope that began just before the stop).
+    buffer.writing.store(true, std::memory_order_seq_cst);
+    if (g_recording.load(std::memory_order_seq_cst))
+    {
+        const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+        buffer.events[head & (kEventsPerThread - 1)] = Event{name, Nanoseconds(begin), Nanoseconds(end)};
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+    buffer.writing.store(false, std::memory_order_release);
+}
+
+void Tracer::NameThread(const char *name)
+{
+    t_threadName = name;
+    if (t_buffer)
+        t_buffer->name.store(name, std::memory_order_relaxed);
+}
+
+void Tracer::Start(std::chrono::seconds duration)
+{
+    // A dump still copying the buffers would race with new events.
+    while (g_collecting.load(std::memory_order_acquire))
+        std::this_thread::yield();
+
+    const Clock::time_point now = Clock::now();
+    g_startNs.store(Nanoseconds(now), std::memory_order_relaxed);
+    g_stopAt = duration.count() > 0 ? now + duration : Clock::time_point::max();
+    g_recording.store(true, std::memory_order_release);
+    std::cout << "[Tracer] Recording";
+    if (duration.count() > 0)
+        std::cout << " for " << duration.count() << " s";
+    std::cout << "\n";
+}
+
+void Tracer::StopAndDump()
+{
+    if (!g_recording.exchange(false, std::memory_order_seq_cst))
+        return;
+    const int64_t startNs = g_startNs.load(std::memory_order_relaxed);
+    std::vector<ThreadBuffer *> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (const auto &buffer : g_buffers)
+            buffers.push_back(buffer.get());
+    }
+
+    char path[64];
+    std::snprintf(path, sizeof(path), "nw-trace-%lld-%u.json",
+                  static_cast<long long>(std::time(nullptr)), ++g_dumps);
+
+    // Copying megabytes of events and formatting the JSON would stall
+    // the tick; both happen on the writer thread.
+    if (g_writer.joinable())
+        g_writer.join();
+    g_collecting.store(true, std::memory_order_relaxed);
+    g_writer = std::thread([path = std::string(path), buffers = std::move(buffers), startNs]
+                           {
+                               const std::vector<ThreadTrace> traces = CollectSince(buffers, startNs);
+                               g_collecting.store(false, std::memory_order_release);
+                               WriteJson(path, traces, startNs);
+                           });
+}
+
+void Tracer::RequestToggle()
+{
+    g_toggleRequested.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Poll()
+{
+    if (g_toggleRequested.exchange(false, std::memory_order_relaxed))
+    {
+        if (Recording())
+            StopAndDump();
+        else
+            Start();
+    }
+    if (Recording() && Clock::now() >= g_stopAt)
+        StopAndDump();
+}
+
+void Tracer::Shutdown()
+{
+    StopAndDump();
+    if (g_writer.joinable())
+        g_writer.join();
+}
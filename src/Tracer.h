@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/// Scoped-event tracer that exports Chrome / Perfetto trace JSON.
+///
+/// Off by default. While recording, every thread that emits an event gets
+/// its own ring buffer (the newest events win once it wraps), so scopes
+/// cost two clock reads and a few stores and never take a lock. When off,
+/// a scope is a single relaxed load. A dump stops recording, then a
+/// background thread waits for events still being written, copies the
+/// buffers and writes the JSON; open the file in ui.perfetto.dev or
+/// chrome://tracing.
+///
+/// Event names must outlive the process (string literals, __func__).
+namespace Tracer
+{
+    using Clock = std::chrono::steady_clock;
+
+    extern std::atomic<bool> g_recording;
+
+    inline bool Recording() { return g_recording.load(std::memory_order_relaxed); }
+
+    /// Record one complete event on the calling thread.
+    void Record(const char *name, Clock::time_point begin, Clock::time_point end);
+
+    /// Label the calling thread in the trace ("tick", "I/O", ...).
+    void NameThread(const char *name);
+
+    /// Start recording (dropping anything recorded before). With a
+    /// non-zero `duration`, Poll() dumps and stops once it has passed.
+    void Start(std::chrono::seconds duration = std::chrono::seconds(0));
+    /// Stop recording and write what was recorded to a new trace file.
+    void StopAndDump();
+
+    /// Async-signal-safe: ask Poll() to start recording, or to stop and
+    /// dump when already recording.
+    void RequestToggle();
+    /// Handle toggle requests and timed dumps. Call regularly from the
+    /// main loop.
+    void Poll();
+    /// Wait for a dump still being written.
+    void Shutdown();
+
+    /// Records the enclosing scope while the tracer is recording.
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name) : m_name(Recording() ? name : nullptr)
+        {
+            if (m_name)
+                m_begin = Clock::now();
+        }
+        ~Scope()
+        {
+            if (m_name)
+                Record(m_name, m_begin, Clock::now());
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *m_name;
+        Clock::time_point m_begin{};
+    };
+}
+
+/// Trace the enclosing scope under `name`.
+#define NW_TRACE_SCOPE(name) Tracer::Scope nwTraceScope(name)
+/// Trace the enclosing function under its name.
+#define NW_TRACE_FUNCTION() NW_TRACE_SCOPE(__func__)
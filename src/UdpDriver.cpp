@@ -0,0 +1,489 @@
+// ────────────────────────────────────────────────────────────────────
+// nbnet UDP driver with SO_REUSEPORT receive shards
+// ────────────────────────────────────────────────────────────────────
+
+extern "C"
+{
+#include <nbnet.h>
+#include <net_drivers/udp.h>
+}
+
+#include "UdpDriver.h"
+
+#if defined(__linux__)
+
+#include "SpscRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    // Per-shard ring: a few thousand full-size datagrams of headroom.
+    constexpr size_t kShardRingBytes = 4u << 20;
+    constexpr int kSocketBufferBytes = 4 << 20;
+
+    // Receive threads wake this often to notice Stop().
+    constexpr timeval kReceiveTimeout{0, 100000};
+
+    // Ring full: leave the datagram in the kernel buffer and retry.
+    constexpr std::chrono::microseconds kRingFullBackoff{100};
+
+    /// Datagrams per ring record, and per system call in batched mode.
+    constexpr uint32_t kBatchSize = UdpDriver::kMaxBatch;
+
+    /// Ring record: BatchHeader, one DatagramHeader per batch slot, then
+    /// the payload slots at a fixed stride. Receives land in the ring
+    /// directly; only the small headers are copied.
+    struct BatchHeader
+    {
+        uint32_t count;
+        uint32_t shard;
+    };
+
+    struct DatagramHeader
+    {
+        sockaddr_in from;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    constexpr size_t kPayloadStride = (NBN_PACKET_MAX_SIZE + 7) & ~size_t{7};
+
+    constexpr size_t PayloadOffset(uint32_t slots)
+    {
+        return sizeof(BatchHeader) + slots * sizeof(DatagramHeader);
+    }
+
+    uint64_t AddressKey(const sockaddr_in &addr)
+    {
+        return (static_cast<uint64_t>(addr.sin_addr.s_addr) << 16) | addr.sin_port;
+    }
+
+    /// Driver data nbnet keeps on each connection.
+    struct UdpPeer
+    {
+        sockaddr_in address;
+        uint64_t key;
+        uint32_t shard; // socket the peer arrived on, also used to answer it
+        NBN_Connection *connection;
+    };
+
+    /// Datagrams queued for one sendmmsg (batched mode, nbnet thread).
+    struct SendQueue
+    {
+        std::unique_ptr<uint8_t[]> payload{new uint8_t[kBatchSize * kPayloadStride]};
+        sockaddr_in to[kBatchSize];
+        iovec iov[kBatchSize];
+        mmsghdr msgs[kBatchSize];
+        uint32_t count = 0;
+    };
+
+    struct Shard
+    {
+        int fd = -1;
+        std::thread thread;
+        SpscByteRing ring{kShardRingBytes};
+        std::atomic<bool> signalled{false}; // readiness already posted
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> receiveCalls{0};
+        std::atomic<uint64_t> ringStalls{0};
+        SendQueue sends;
+    };
+
+    class ShardedUdpDriver
+    {
+    public:
+        void Configure(const UdpDriver::Config &config)
+        {
+            m_shardCount = std::max<uint32_t>(config.receiveShards, 1);
+            m_batchSize = config.batched ? kBatchSize : 1;
+        }
+
+        int Start(uint32_t protocolId, uint16_t port);
+        void Stop();
+        int RecvPackets();
+        int SendPacketTo(NBN_Packet *packet, NBN_Connection *connection);
+        void RemoveConnection(NBN_Connection *connection);
+        void FlushSends();
+
+        int ReadyFd() const { return m_readyFd; }
+        UdpDriver::Stats GetStats() const;
+
+    private:
+        void ReceiveMain(Shard &shard, uint32_t index);
+        void Deliver(const DatagramHeader &header, uint32_t shard, const uint8_t *data);
+        void FlushQueue(Shard &shard);
+
+        uint32_t m_shardCount = 1;
+        uint32_t m_batchSize = 1;
+        uint32_t m_protocolId = 0;
+        std::vector<std::unique_ptr<Shard>> m_shards;
+        std::atomic<bool> m_stop{false};
+        int m_readyFd = -1;
+
+        // nbnet thread only (counters are read by GetStats()).
+        std::unordered_map<uint64_t, std::unique_ptr<UdpPeer>> m_peers;
+        NBN_ConnectionHandle m_nextConnectionId = 0;
+        std::atomic<uint64_t> m_sent{0};
+        std::atomic<uint64_t> m_sendCalls{0};
+        std::atomic<uint64_t> m_sendDrops{0};
+    };
+
+    // nbnet drivers are plain function tables, so the instance is global.
+    ShardedUdpDriver g_driver;
+
+    int ShardedUdpDriver::Start(uint32_t protocolId, uint16_t port)
+    {
+        m_protocolId = protocolId;
+        m_stop.store(false, std::memory_order_relaxed);
+        m_readyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_readyFd < 0)
+            return NBN_ERROR;
+
+        for (uint32_t i = 0; i < m_shardCount; ++i)
+        {
+            auto shard = std::make_unique<Shard>();
+            shard->fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+            const int one = 1;
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_ANY);
+            addr.sin_port = htons(port);
+            if (shard->fd < 0 ||
+                setsockopt(shard->fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0 ||
+                bind(shard->fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+            {
+                std::cerr << "[UdpDriver] cannot bind receive shard " << i << " to port "
+                          << port << ": " << std::strerror(errno) << "\n";
+                if (shard->fd >= 0)
+                    close(shard->fd);
+                Stop();
+                return NBN_ERROR;
+            }
+            setsockopt(shard->fd, SOL_SOCKET, SO_RCVBUF, &kSocketBufferBytes, sizeof(kSocketBufferBytes));
+            setsockopt(shard->fd, SOL_SOCKET, SO_SNDBUF, &kSocketBufferBytes, sizeof(kSocketBufferBytes));
+            setsockopt(shard->fd, SOL_SOCKET, SO_RCVTIMEO, &kReceiveTimeout, sizeof(kReceiveTimeout));
+            m_shards.push_back(std::move(shard));
+        }
+
+        for (uint32_t i = 0; i < m_shards.size(); ++i)
+            m_shards[i]->thread = std::thread(&ShardedUdpDriver::ReceiveMain, this,
+                                              std::ref(*m_shards[i]), i);
+
+        std::cout << "[UdpDriver] " << m_shards.size()
+                  << " SO_REUSEPORT receive shard(s) on port " << port;
+        if (m_batchSize > 1)
+            std::cout << ", recvmmsg/sendmmsg batches of " << m_batchSize;
+        std::cout << "\n";
+        return 0;
+    }
+
+    void ShardedUdpDriver::Stop()
+    {
+        FlushSends();
+        m_stop.store(true, std::memory_order_release);
+        for (auto &shard : m_shards)
+        {
+            if (shard->thread.joinable())
+                shard->thread.join();
+            close(shard->fd);
+        }
+        m_shards.clear();
+        m_peers.clear();
+        if (m_readyFd >= 0)
+        {
+            close(m_readyFd);
+            m_readyFd = -1;
+        }
+    }
+
+    void ShardedUdpDriver::ReceiveMain(Shard &shard, uint32_t index)
+    {
+        const uint32_t slots = m_batchSize;
+        const size_t reserve = PayloadOffset(slots) + slots * kPayloadStride;
+        DatagramHeader headers[kBatchSize];
+        iovec iov[kBatchSize];
+        mmsghdr msgs[kBatchSize];
+
+        while (!m_stop.load(std::memory_order_acquire))
+        {
+            uint8_t *record = shard.ring.BeginWrite(reserve);
+            if (!record)
+            {
+                shard.ringStalls.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::sleep_for(kRingFullBackoff);
+                continue;
+            }
+
+            // Receive straight into the ring's payload slots; the
+            // reservation is simply reused when nothing arrived before
+            // the timeout.
+            uint8_t *payload = record + PayloadOffset(slots);
+            int got = 0;
+            if (slots > 1)
+            {
+                for (uint32_t i = 0; i < slots; ++i)
+                {
+                    iov[i] = iovec{payload + i * kPayloadStride, NBN_PACKET_MAX_SIZE};
+                    msgs[i] = mmsghdr{};
+                    msgs[i].msg_hdr.msg_name = &headers[i].from;
+                    msgs[i].msg_hdr.msg_namelen = sizeof(headers[i].from);
+                    msgs[i].msg_hdr.msg_iov = &iov[i];
+                    msgs[i].msg_hdr.msg_iovlen = 1;
+                }
+                // Block for the first datagram only, then take what is queued.
+                got = recvmmsg(shard.fd, msgs, slots, MSG_WAITFORONE, nullptr);
+                for (int i = 0; i < got; ++i)
+                    headers[i].length = msgs[i].msg_len;
+            }
+            else
+            {
+                socklen_t fromLen = sizeof(headers[0].from);
+                const ssize_t bytes = recvfrom(shard.fd, payload, NBN_PACKET_MAX_SIZE, 0,
+                                               reinterpret_cast<sockaddr *>(&headers[0].from), &fromLen);
+                if (bytes > 0)
+                {
+                    headers[0].length = static_cast<uint32_t>(bytes);
+                    got = 1;
+                }
+            }
+            shard.receiveCalls.fetch_add(1, std::memory_order_relaxed);
+            if (got <= 0)
+                continue;
+
+            const BatchHeader batch{static_cast<uint32_t>(got), index};
+            std::memcpy(record, &batch, sizeof(batch));
+            std::memcpy(record + sizeof(BatchHeader), headers, got * sizeof(DatagramHeader));
+            shard.ring.CommitWrite(PayloadOffset(slots) + (got - 1) * kPayloadStride +
+                                   headers[got - 1].length);
+            shard.received.fetch_add(static_cast<uint64_t>(got), std::memory_order_relaxed);
+
+            // Post readiness once per drain, not once per datagram. The
+            // fence pairs with the one in RecvPackets: either we see the
+            // flag cleared, or the drain that cleared it sees this record.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!shard.signalled.load(std::memory_order_relaxed) &&
+                !shard.signalled.exchange(true, std::memory_order_relaxed))
+            {
+                const uint64_t one = 1;
+                (void)!write(m_readyFd, &one, sizeof(one));
+            }
+        }
+    }
+
+    int ShardedUdpDriver::RecvPackets()
+    {
+        uint64_t posted;
+        (void)!read(m_readyFd, &posted, sizeof(posted));
+
+        const size_t payloadOffset = PayloadOffset(m_batchSize);
+        for (auto &shard : m_shards)
+        {
+            shard->signalled.store(false, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            size_t length;
+            while (const uint8_t *record = shard->ring.BeginRead(length))
+            {
+                BatchHeader batch;
+                std::memcpy(&batch, record, sizeof(batch));
+                for (uint32_t i = 0; i < batch.count; ++i)
+                {
+                    DatagramHeader header;
+                    std::memcpy(&header, record + sizeof(BatchHeader) + i * sizeof(DatagramHeader),
+                                sizeof(header));
+                    Deliver(header, batch.shard, record + payloadOffset + i * kPayloadStride);
+                }
+                shard->ring.EndRead();
+            }
+        }
+        return 0;
+    }
+
+    void ShardedUdpDriver::Deliver(const DatagramHeader &header, uint32_t shard, const uint8_t *data)
+    {
+        if (header.from.sin_family != AF_INET)
+            return;
+
+        // Validate before anything is allocated: a stray or spoofed
+        // datagram must not create a connection.
+        NBN_Packet packet;
+        if (NBN_Packet_InitRead(&packet, nullptr, const_cast<uint8_t *>(data), header.length) < 0)
+            return;
+
+        // A peer hashes to one socket, so its packets stay in order.
+        const uint64_t key = AddressKey(header.from);
+        auto it = m_peers.find(key);
+        if (it == m_peers.end())
+        {
+            auto peer = std::make_unique<UdpPeer>();
+            peer->address = header.from;
+            peer->key = key;
+            peer->shard = shard;
+            peer->connection = NBN_GameServer_CreateClientConnection(
+                NBN_UDP_DRIVER_ID, peer.get(), m_protocolId, m_nextConnectionId++, false);
+            it = m_peers.emplace(key, std::move(peer)).first;
+            NBN_Driver_RaiseEvent(NBN_DRIVER_SERV_CLIENT_CONNECTED, it->second->connection);
+        }
+
+        packet.sender = it->second->connection;
+        NBN_Driver_RaiseEvent(NBN_DRIVER_SERV_CLIENT_PACKET_RECEIVED, &packet);
+    }
+
+    int ShardedUdpDriver::SendPacketTo(NBN_Packet *packet, NBN_Connection *connection)
+    {
+        const auto *peer = static_cast<const UdpPeer *>(connection->driver_data);
+        Shard &shard = *m_shards[peer->shard];
+
+        if (m_batchSize == 1)
+        {
+            m_sendCalls.fetch_add(1, std::memory_order_relaxed);
+            if (sendto(shard.fd, packet->buffer, packet->size, MSG_DONTWAIT,
+                       reinterpret_cast<const sockaddr *>(&peer->address), sizeof(peer->address)) < 0)
+            {
+                m_sendDrops.fetch_add(1, std::memory_order_relaxed);
+                return NBN_ERROR;
+            }
+            m_sent.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        // nbnet reuses the packet once we return, so queue a copy.
+        SendQueue &queue = shard.sends;
+        const uint32_t i = queue.count++;
+        uint8_t *slot = queue.payload.get() + i * kPayloadStride;
+        std::memcpy(slot, packet->buffer, packet->size);
+        queue.to[i] = peer->address;
+        queue.iov[i] = iovec{slot, packet->size};
+        queue.msgs[i] = mmsghdr{};
+        queue.msgs[i].msg_hdr.msg_name = &queue.to[i];
+        queue.msgs[i].msg_hdr.msg_namelen = sizeof(queue.to[i]);
+        queue.msgs[i].msg_hdr.msg_iov = &queue.iov[i];
+        queue.msgs[i].msg_hdr.msg_iovlen = 1;
+        if (queue.count == m_batchSize)
+            FlushQueue(shard);
+        return 0;
+    }
+
+    void ShardedUdpDriver::FlushQueue(Shard &shard)
+    {
+        SendQueue &queue = shard.sends;
+        uint32_t done = 0;
+        while (done < queue.count)
+        {
+            m_sendCalls.fetch_add(1, std::memory_order_relaxed);
+            const int sent = sendmmsg(shard.fd, queue.msgs + done, queue.count - done, MSG_DONTWAIT);
+            if (sent < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                // Socket buffer full or a bad destination: UDP may drop,
+                // and nbnet resends what is reliable.
+                m_sendDrops.fetch_add(queue.count - done, std::memory_order_relaxed);
+                break;
+            }
+            done += static_cast<uint32_t>(sent);
+            m_sent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+        }
+        queue.count = 0;
+    }
+
+    void ShardedUdpDriver::FlushSends()
+    {
+        for (auto &shard : m_shards)
+        {
+            if (shard->sends.count > 0)
+                FlushQueue(*shard);
+        }
+    }
+
+    void ShardedUdpDriver::RemoveConnection(NBN_Connection *connection)
+    {
+        const auto *peer = static_cast<const UdpPeer *>(connection->driver_data);
+        m_peers.erase(peer->key);
+    }
+
+    UdpDriver::Stats ShardedUdpDriver::GetStats() const
+    {
+        UdpDriver::Stats stats;
+        for (const auto &shard : m_shards)
+        {
+            stats.packetsReceived += shard->received.load(std::memory_order_relaxed);
+            stats.receiveCalls += shard->receiveCalls.load(std::memory_order_relaxed);
+            stats.ringStalls += shard->ringStalls.load(std::memory_order_relaxed);
+        }
+        stats.packetsSent = m_sent.load(std::memory_order_relaxed);
+        stats.sendCalls = m_sendCalls.load(std::memory_order_relaxed);
+        stats.sendDrops = m_sendDrops.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // ── nbnet entry points ──────────────────────────────────────────
+
+    int ServStart(uint32_t protocolId, uint16_t port, bool encryption)
+    {
+        (void)encryption; // nbnet's packet encryption is off for this server
+        return g_driver.Start(protocolId, port);
+    }
+
+    void ServStop() { g_driver.Stop(); }
+    int ServRecvPackets() { return g_driver.RecvPackets(); }
+
+    int ServSendPacketTo(NBN_Packet *packet, NBN_Connection *connection)
+    {
+        return g_driver.SendPacketTo(packet, connection);
+    }
+
+    void ServRemoveConnection(NBN_Connection *connection) { g_driver.RemoveConnection(connection); }
+}
+
+namespace UdpDriver
+{
+    bool Register(const Config &config)
+    {
+        g_driver.Configure(config);
+
+        // Server only; the client half stays unset.
+        NBN_DriverImplementation impl{};
+        impl.serv_start = ServStart;
+        impl.serv_stop = ServStop;
+        impl.serv_recv_packets = ServRecvPackets;
+        impl.serv_send_packet_to = ServSendPacketTo;
+        impl.serv_remove_connection = ServRemoveConnection;
+        NBN_Driver_Register(NBN_UDP_DRIVER_ID, "UDP (sharded)", impl);
+        return true;
+    }
+
+    int ReadyFd() { return g_driver.ReadyFd(); }
+
+    void FlushSends() { g_driver.FlushSends(); }
+
+    Stats GetStats() { return g_driver.GetStats(); }
+}
+
+#else
+
+namespace UdpDriver
+{
+    bool Register(const Config &) { return false; }
+    int ReadyFd() { return -1; }
+    void FlushSends() {}
+    Stats GetStats() { return {}; }
+}
+
+#endif
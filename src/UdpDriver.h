@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+
+/// Replacement for nbnet's stock UDP driver with sharded receive.
+///
+/// NBN_UDP_Register() reads every datagram from one socket on the nbnet
+/// thread, so kernel receive processing and the recv loop share a core.
+/// This driver opens several SO_REUSEPORT sockets on the server port; the
+/// kernel spreads peers across them by address hash and each socket is
+/// drained by its own thread into a lock-free ring. The nbnet thread (tick
+/// or I/O thread) then only maps addresses to connections and hands the
+/// packets to nbnet, keyed by connection, in per-peer arrival order.
+///
+/// In batched mode receives use recvmmsg and the datagrams nbnet sends
+/// during one flush leave through sendmmsg, up to kMaxBatch per system
+/// call instead of one recvfrom / sendto each.
+///
+/// Linux only; elsewhere Register() declines and the stock driver is used.
+namespace UdpDriver
+{
+    /// Most datagrams moved by one recvmmsg / sendmmsg.
+    constexpr uint32_t kMaxBatch = 32;
+
+    struct Config
+    {
+        /// Sockets (and receive threads) sharing the port.
+        uint32_t receiveShards = 2;
+        /// recvmmsg / sendmmsg instead of recvfrom / sendto.
+        bool batched = false;
+    };
+
+    /// Register under NBN_UDP_DRIVER_ID in place of NBN_UDP_Register().
+    /// Returns false where unsupported; register the stock driver then.
+    bool Register(const Config &config);
+
+    /// eventfd that turns readable whenever received packets wait for
+    /// nbnet (for idle waits), or -1 while the driver is not running.
+    int ReadyFd();
+
+    /// Hand datagrams queued in batched mode to the kernel. Call after
+    /// NBN_GameServer_SendPackets(); a no-op otherwise.
+    void FlushSends();
+
+    /// Totals since the server started.
+    struct Stats
+    {
+        uint64_t packetsReceived = 0;
+        uint64_t receiveCalls = 0; // recvfrom / recvmmsg, timeouts included
+        uint64_t packetsSent = 0;
+        uint64_t sendCalls = 0; // sendto / sendmmsg
+        uint64_t sendDrops = 0; // refused by the kernel (buffer full)
+        uint64_t ringStalls = 0; // receive thread waited for the nbnet thread
+    };
+    Stats GetStats();
+}
@@ -0,0 +1,146 @@
+// ────────────────────────────────────────────────────────────────────
+// Work-stealing worker pool for per-tick parallel work
+// ────────────────────────────────────────────────────────────────────
+
+#include "WorkerPool.h"
+#include "Tracer.h"
+
+namespace
+{
+    constexpr uint64_t PackRange(uint32_t begin, uint32_t end)
+    {
+        return (static_cast<uint64_t>(end) << 32) | begin;
+    }
+    constexpr uint32_t RangeBegin(uint64_t r) { return static_cast<uint32_t>(r); }
+    constexpr uint32_t RangeEnd(uint64_t r) { return static_cast<uint32_t>(r >> 32); }
+}
+
+WorkerPool::~WorkerPool()
+{
+    Stop();
+}
+
+void WorkerPool::Start(uint32_t threads)
+{
+    Stop();
+    m_stop = false;
+    m_shares.reset(new Share[threads + 1]);
+    m_threads.reserve(threads);
+    for (uint32_t i = 0; i < threads; ++i)
+        m_threads.emplace_back(&WorkerPool::WorkerMain, this, i + 1);
+}
+
+void WorkerPool::Stop()
+{
+    if (m_threads.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread &t : m_threads)
+        t.join();
+    m_threads.clear();
+}
+
+void WorkerPool::Run(size_t count, InvokeFn invoke, void *ctx)
+{
+    const uint32_t slots = SlotCount();
+    const uint64_t n = count;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_invoke = invoke;
+        m_ctx = ctx;
+        for (uint32_t s = 0; s < slots; ++s)
+        {
+            const auto begin = static_cast<uint32_t>(n * s / slots);
+            const auto end = static_cast<uint32_t>(n * (s + 1) / slots);
+            m_shares[s].range.store(PackRange(begin, end), std::memory_order_relaxed);
+        }
+        m_busyWorkers = ThreadCount();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    Drain(0);
+
+    // Workers may still be finishing the indices they claimed.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]
+                { return m_busyWorkers == 0; });
+}
+
+bool WorkerPool::PopOwn(uint32_t slot, uint32_t &index)
+{
+    std::atomic<uint64_t> &range = m_shares[slot].range;
+    uint64_t r = range.load(std::memory_order_acquire);
+    while (RangeBegin(r) < RangeEnd(r))
+    {
+        if (range.compare_exchange_weak(r, PackRange(RangeBegin(r) + 1, RangeEnd(r)),
+                                        std::memory_order_acq_rel))
+        {
+            index = RangeBegin(r);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkerPool::Steal(uint32_t slot, uint32_t &index)
+{
+    const uint32_t slots = SlotCount();
+    for (uint32_t k = 1; k < slots; ++k)
+    {
+        std::atomic<uint64_t> &victim = m_shares[(slot + k) % slots].range;
+        uint64_t r = victim.load(std::memory_order_acquire);
+        while (RangeBegin(r) < RangeEnd(r))
+        {
+            // Take the back half (at least one index), leave the front to
+            // the owner, which keeps popping from it.
+            const uint32_t begin = RangeBegin(r);
+            const uint32_t end = RangeEnd(r);
+            const uint32_t mid = begin + (end - begin) / 2;
+            if (!victim.compare_exchange_weak(r, PackRange(begin, mid),
+                                              std::memory_order_acq_rel))
+                continue;
+
+            // Our own share is empty, so nobody else writes it now.
+            m_shares[slot].range.store(PackRange(mid + 1, end), std::memory_order_release);
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            index = mid;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkerPool::Drain(uint32_t slot)
+{
+    uint32_t index;
+    while (PopOwn(slot, index) || Steal(slot, index))
+        m_invoke(m_ctx, index, slot);
+}
+
+void WorkerPool::WorkerMain(uint32_t slot)
+{
+    Tracer::NameThread("encode worker");
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]
+                        { return m_stop || m_generation != seen; });
+            if (m_stop)
+                return;
+            seen = m_generation;
+        }
+
+        Drain(slot);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busyWorkers == 0)
+            m_done.notify_one();
+    }
+}
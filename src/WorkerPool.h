@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Fixed set of worker threads for fork-join work inside one tick.
+///
+/// ParallelFor splits the index range evenly between the participants
+/// (the workers plus the calling thread). Each one works through its own
+/// share front to back; once it runs dry it steals the back half of
+/// another participant's share, so uneven jobs (a crowded room next to an
+/// empty one, a receiver with ten times the visible entities) balance
+/// themselves without a shared counter being hammered for every index.
+/// With no workers everything simply runs inline. No allocation happens
+/// per call.
+class WorkerPool
+{
+public:
+    WorkerPool() = default;
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /// Spawn `threads` workers (0 = run everything on the caller).
+    void Start(uint32_t threads);
+    void Stop();
+
+    uint32_t ThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+    /// Participants in a ParallelFor: the workers plus the caller.
+    uint32_t SlotCount() const { return ThreadCount() + 1; }
+
+    /// Run fn(i, slot) for every i in [0, count) and return once all are
+    /// done. `slot` identifies the thread running the call (0 = caller,
+    /// < SlotCount()), for per-thread scratch. Calls for different indices
+    /// may run concurrently.
+    template <typename Fn>
+    void ParallelFor(size_t count, Fn &&fn)
+    {
+        if (m_threads.empty() || count <= 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+                fn(i, 0u);
+            return;
+        }
+        Run(count, [](void *ctx, size_t i, uint32_t slot)
+            { (*static_cast<Fn *>(ctx))(i, slot); },
+            &fn);
+    }
+
+    /// Ranges taken from another participant since Start().
+    uint64_t Steals() const { return m_steals.load(std::memory_order_relaxed); }
+
+private:
+    using InvokeFn = void (*)(void *ctx, size_t index, uint32_t slot);
+
+    /// One participant's remaining indices, [begin, end) packed into one
+    /// word so the owner's pop and a thief's split race on a single CAS.
+    struct alignas(64) Share
+    {
+        std::atomic<uint64_t> range{0};
+    };
+
+    void Run(size_t count, InvokeFn invoke, void *ctx);
+    void WorkerMain(uint32_t slot);
+    /// Run indices of the current job, own share first, then stolen ones.
+    void Drain(uint32_t slot);
+    bool PopOwn(uint32_t slot, uint32_t &index);
+    bool Steal(uint32_t slot, uint32_t &index);
+
+    std::vector<std::thread> m_threads;
+    std::unique_ptr<Share[]> m_shares; // SlotCount() entries
+    std::mutex m_mutex;
+    std::condition_variable m_wake; // new job or stop
+    std::condition_variable m_done; // last worker left the job
+    uint64_t m_generation = 0;      // bumped per job, guarded by m_mutex
+    uint32_t m_busyWorkers = 0;     // workers still inside the job
+    bool m_stop = false;
+    std::atomic<uint64_t> m_steals{0};
+
+    // Current job; written before m_generation is bumped.
+    InvokeFn m_invoke = nullptr;
+    void *m_ctx = nullptr;
+};
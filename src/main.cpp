@@ -1,12 +1,17 @@
 #include "GameServer.h"
+#include "Tracer.h"
+#include <atomic>
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <csignal>
 #include <cstdlib>
+#include <cstring>
 
 // ── Graceful shutdown ──────────────────────────────────────────────
-static GameServer *g_server = nullptr;
+// Handlers only raise the flag; the tick loop stops the server itself,
+// since Stop() joins the I/O thread and must not run in signal context.
+static std::atomic<bool> g_stopRequested{false};
 
 #ifdef _WIN32
 #include <windows.h>
@@ -14,32 +19,217 @@ static BOOL WINAPI ConsoleHandler(DWORD signal)
 {
     if (signal == CTRL_C_EVENT || signal == CTRL_CLOSE_EVENT)
     {
-        std::cout << "\n[Server] Shutting down...\n";
-        if (g_server)
-            g_server->Stop();
+        g_stopRequested.store(true);
     }
     return TRUE;
 }
 #else
 static void SignalHandler(int /*sig*/)
 {
-    std::cout << "\n[Server] Shutting down...\n";
-    if (g_server)
-        g_server->Stop();
+    g_stopRequested.store(true);
+}
+
+// SIGUSR1 starts a trace, the next one dumps it.
+static void TraceSignalHandler(int /*sig*/)
+{
+    Tracer::RequestToggle();
 }
 #endif
 
+// Tick timing (wake-up lateness, overruns) is logged this often.
+static constexpr uint32_t TIMING_REPORT_SECONDS = 60;
+
+// ── Command line ───────────────────────────────────────────────────
+static void PrintUsage(const char *exe)
+{
+    std::cout << "Usage: " << exe << " [port] [options]\n"
+              << "  --tick-rate <Hz>       simulation ticks per second (default 30)\n"
+              << "  --send-rate <Hz>       default position broadcasts per client per second\n"
+              << "  --overrun <catchup|skip>  late ticks: run back to back, or drop\n"
+              << "  --idle-wake <ms>       idle server housekeeping interval (0 = never idle)\n"
+              << "  --aoi-radius <units>   area-of-interest radius (0 = send everyone)\n"
+              << "  --client-budget <B>    position bytes per client per broadcast (0 = unlimited)\n"
+              << "  --broadcast-format <raw|compact|delta>  position broadcast wire format\n"
+              << "  --world-bound <units>  compact format: position range [-bound, bound]\n"
+              << "  --position-precision <units>  compact format: position resolution\n"
+              << "  --max-payload <B>      split compact/delta broadcasts above this size (0 = off)\n"
+              << "  --bundle-reliable      coalesce each client's reliable messages per tick\n"
+              << "  --io-thread            poll and send on a dedicated network thread\n"
+              << "  --udp-shards <N>       receive on N SO_REUSEPORT sockets, one thread each\n"
+              << "  --udp-batch            batch UDP receives and sends (recvmmsg/sendmmsg)\n"
+              << "  --live-stats           publish live counters to shared memory (see nw-top)\n"
+              << "  --trace <s>            record a Chrome trace of the first <s> seconds\n"
+              << "  --max-rooms <N>        most rooms alive at once (default 64)\n"
+              << "  --workers <N>          extra threads encoding broadcasts in parallel\n"
+              << "  --relay <us>           forward position updates between ticks, batched over <us>\n"
+              << "  --relay-max-room <N>   largest room that relays (default 8)\n"
+              << "  --max-shed-level <0-4> furthest load shedding under overload (default 0 = none)\n";
+}
+
+/// Parse `server.exe [port] [--option value ...]`.
+static bool ParseArgs(int argc, char *argv[], uint16_t &port, ServerConfig &config)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--tick-rate") == 0 && value)
+        {
+            config.tickRate = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            if (config.tickRate == 0)
+            {
+                std::cerr << "[Server] Tick rate must be positive\n";
+                return false;
+            }
+            ++i;
+        }
+        else if (std::strcmp(arg, "--overrun") == 0 && value)
+        {
+            if (std::strcmp(value, "catchup") == 0)
+                config.overrunPolicy = TickOverrunPolicy::CatchUp;
+            else if (std::strcmp(value, "skip") == 0)
+                config.overrunPolicy = TickOverrunPolicy::Skip;
+            else
+            {
+                std::cerr << "[Server] Unknown overrun policy: " << value << "\n";
+                return false;
+            }
+            ++i;
+        }
+        else if (std::strcmp(arg, "--send-rate") == 0 && value)
+        {
+            config.sendRate = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--idle-wake") == 0 && value)
+        {
+            config.idleWakeInterval = std::chrono::milliseconds(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--aoi-radius") == 0 && value)
+        {
+            config.interestRadius = static_cast<float>(std::atof(value));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--client-budget") == 0 && value)
+        {
+            config.clientByteBudget = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--broadcast-format") == 0 && value)
+        {
+            if (std::strcmp(value, "raw") == 0)
+                config.broadcastFormat = BroadcastFormat::Raw;
+            else if (std::strcmp(value, "compact") == 0)
+                config.broadcastFormat = BroadcastFormat::Compact;
+            else if (std::strcmp(value, "delta") == 0)
+                config.broadcastFormat = BroadcastFormat::Delta;
+            else
+            {
+                std::cerr << "[Server] Unknown broadcast format: " << value << "\n";
+                return false;
+            }
+            ++i;
+        }
+        else if (std::strcmp(arg, "--world-bound") == 0 && value)
+        {
+            config.worldBound = static_cast<float>(std::atof(value));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--position-precision") == 0 && value)
+        {
+            config.positionPrecision = static_cast<float>(std::atof(value));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--max-payload") == 0 && value)
+        {
+            config.maxBroadcastPayload = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--bundle-reliable") == 0)
+        {
+            config.bundleReliable = true;
+        }
+        else if (std::strcmp(arg, "--io-thread") == 0)
+        {
+            config.ioThread = true;
+        }
+        else if (std::strcmp(arg, "--udp-shards") == 0 && value)
+        {
+            config.udpReceiveShards = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--udp-batch") == 0)
+        {
+            config.udpBatch = true;
+        }
+        else if (std::strcmp(arg, "--live-stats") == 0)
+        {
+            config.liveStats = true;
+        }
+        else if (std::strcmp(arg, "--trace") == 0 && value)
+        {
+            config.traceSeconds = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--max-rooms") == 0 && value)
+        {
+            config.maxRooms = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--workers") == 0 && value)
+        {
+            config.workerThreads = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--relay") == 0 && value)
+        {
+            config.relayWindow = std::chrono::microseconds(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--relay-max-room") == 0 && value)
+        {
+            config.relayMaxRoomSize = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(arg, "--max-shed-level") == 0 && value)
+        {
+            const unsigned long level = std::strtoul(value, nullptr, 10);
+            if (level >= kLoadLevelCount)
+            {
+                std::cerr << "[Server] Shed level must be 0-" << kLoadLevelCount - 1 << "\n";
+                return false;
+            }
+            config.maxLoadLevel = static_cast<LoadLevel>(level);
+            ++i;
+        }
+        else if (arg[0] != '-')
+        {
+            port = static_cast<uint16_t>(std::atoi(arg));
+        }
+        else
+        {
+            std::cerr << "[Server] Unknown or incomplete option: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
 // ── Entry point ────────────────────────────────────────────────────
 int main(int argc, char *argv[])
 {
     uint16_t port = DEFAULT_SERVER_PORT;
+    ServerConfig config;
 
-    // Allow overriding port via command-line: server.exe <port>
-    if (argc > 1)
-        port = static_cast<uint16_t>(std::atoi(argv[1]));
+    if (!ParseArgs(argc, argv, port, config))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
 
-    GameServer server;
-    g_server = &server;
+    GameServer server(config);
 
     // Register Ctrl-C handler.
 #ifdef _WIN32
@@ -47,6 +237,7 @@ int main(int argc, char *argv[])
 #else
     std::signal(SIGINT, SignalHandler);
     std::signal(SIGTERM, SignalHandler);
+    std::signal(SIGUSR1, TraceSignalHandler);
 #endif
 
     if (!server.Start(port))
@@ -55,25 +246,69 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    std::cout << "[Server] Running on port " << port
-              << ". Press Ctrl+C to stop.\n";
+    Tracer::NameThread("tick");
+    if (config.traceSeconds > 0)
+        Tracer::Start(std::chrono::seconds(config.traceSeconds));
 
-    // ── Main tick loop (30 Hz) ─────────────────────────────────────
-    using clock = std::chrono::steady_clock;
-    constexpr auto TICK_INTERVAL =
-        std::chrono::duration_cast<clock::duration>(
-            std::chrono::milliseconds(33)); // ~30 ticks/s
+    std::cout << "[Server] Running on port " << port << " at " << config.tickRate
+              << " Hz. Press Ctrl+C to stop.\n";
 
-    while (server.IsRunning())
-    {
-        auto tickStart = clock::now();
+    // ── Main tick loop (absolute deadlines) ────────────────────────
+    TickScheduler scheduler(config.tickRate, config.overrunPolicy);
+    const uint64_t statsInterval = uint64_t(config.tickRate) * TIMING_REPORT_SECONDS;
+    scheduler.Start();
 
+    bool idle = false;
+    while (server.IsRunning() && !g_stopRequested.load())
+    {
         server.Tick();
+        Tracer::Poll();
+
+        // Nobody in gameplay: tick on demand instead of at the full rate.
+        if (server.IsIdle())
+        {
+            if (!idle)
+                std::cout << "[Server] No clients in gameplay, ticking on demand\n";
+            idle = true;
+            server.WaitForTraffic();
+            continue;
+        }
+        if (idle)
+        {
+            std::cout << "[Server] Gameplay traffic, back to " << config.tickRate << " Hz\n";
+            idle = false;
+            scheduler.Resync();
+        }
+        // Relay mode forwards position updates as they arrive until the
+        // next tick is close.
+        server.RelayUntil(scheduler.NextDeadline());
+        scheduler.WaitNextTick();
+
+        const TickScheduler::Stats &stats = scheduler.WindowStats();
+        if (stats.ticks >= statsInterval)
+        {
+            using us = std::chrono::microseconds;
+            TickScheduler::Clock::duration avgLate{};
+            if (stats.wakeUps > 0)
+                avgLate = stats.totalLateness / static_cast<int64_t>(stats.wakeUps);
+            std::cout << "[Server] Tick timing over " << stats.ticks << " ticks: wake-up late avg "
+                      << std::chrono::duration_cast<us>(avgLate).count() << " us, max "
+                      << std::chrono::duration_cast<us>(stats.maxLateness).count()
+                      << " us, overruns " << stats.overruns << ", skipped "
+                      << stats.skippedTicks << "\n";
+            scheduler.ResetWindow();
+            server.LogLoadReport();
+            server.LogTickProfile();
+            server.LogBandwidthReport();
+        }
+    }
 
-        auto elapsed = clock::now() - tickStart;
-        if (elapsed < TICK_INTERVAL)
-            std::this_thread::sleep_for(TICK_INTERVAL - elapsed);
+    if (g_stopRequested.load())
+    {
+        std::cout << "\n[Server] Shutting down...\n";
+        server.Stop();
     }
+    Tracer::Shutdown();
 
     std::cout << "[Server] Exited cleanly.\n";
     return 0;
@@ -0,0 +1,27 @@
+#pragma once
+// ────────────────────────────────────────────────────────────────────
+// Server-side nbnet extensions – implemented in nbnet_server_impl.c
+//
+// Plain C declarations; C++ callers include this inside extern "C" { }
+// next to nbnet.h, like the rest of the nbnet API.
+// ────────────────────────────────────────────────────────────────────
+
+#include <stdint.h>
+
+/// Send one byte array to many connections.
+///
+/// The payload is copied once into a single nbnet outgoing message whose
+/// reference count is shared by every recipient's queue, instead of one
+/// allocation + memcpy per recipient as NBN_GameServer_SendByteArrayTo does.
+/// Unknown or closed handles are skipped. Returns 0, or -1 on error.
+int NW_GameServer_SendByteArrayToMany(const uint32_t *connection_handles,
+                                      unsigned int handle_count,
+                                      const uint8_t *bytes,
+                                      unsigned int length,
+                                      uint8_t channel_id);
+
+/// Messages queued on one of a connection's channels and not yet
+/// released (for reliable channels: not yet acknowledged). 0 for unknown
+/// handles.
+unsigned int NW_GameServer_GetOutgoingMessageCount(uint32_t connection_handle,
+                                                   uint8_t channel_id);
@@ -25,3 +25,79 @@
 #if defined(NW_ENABLE_WEBRTC_C)
 #include <net_drivers/webrtc_c.h>
 #endif
+
+#include <string.h>
+#include "nbnet_server_ext.h"
+
+// ── Extensions ─────────────────────────────────────────────────────
+// Compiled here because they need nbnet internals from NBNET_IMPL.
+
+int NW_GameServer_SendByteArrayToMany(const uint32_t *connection_handles,
+                                      unsigned int handle_count,
+                                      const uint8_t *bytes,
+                                      unsigned int length,
+                                      uint8_t channel_id)
+{
+    if (handle_count == 0)
+        return 0;
+
+    if (length > NBN_BYTE_ARRAY_MAX_SIZE)
+    {
+        NBN_LogError("Byte array cannot exceed %d bytes", NBN_BYTE_ARRAY_MAX_SIZE);
+        return NBN_ERROR;
+    }
+
+    // Skip the allocation entirely when nobody is left to receive it, so an
+    // outgoing message is never created without at least one reference.
+    unsigned int live_count = 0;
+    for (unsigned int i = 0; i < handle_count; i++)
+    {
+        NBN_Connection *client = NBN_ConnectionTable_Get(nbn_game_server.clients_table,
+                                                         connection_handles[i]);
+        if (client != NULL && !client->is_closed && !client->is_stale)
+            live_count++;
+    }
+
+    if (live_count == 0)
+        return 0;
+
+    NBN_ByteArrayMessage *msg = NBN_ByteArrayMessage_Create();
+    memcpy(msg->bytes, bytes, length);
+    msg->length = length;
+
+    // Same pattern as NBN_GameServer_BroadcastMessage: one outgoing message,
+    // enqueued on every target connection (each enqueue takes a reference).
+    NBN_OutgoingMessage *outgoing_msg = Endpoint_CreateOutgoingMessage(
+        &nbn_game_server.endpoint, NBN_BYTE_ARRAY_MESSAGE_TYPE, msg);
+
+    if (outgoing_msg == NULL)
+        return NBN_ERROR;
+
+    for (unsigned int i = 0; i < handle_count; i++)
+    {
+        NBN_Connection *client = NBN_ConnectionTable_Get(nbn_game_server.clients_table,
+                                                         connection_handles[i]);
+
+        if (client == NULL || client->is_closed || client->is_stale)
+            continue;
+
+        if (GameServer_SendMessageTo(client, outgoing_msg, channel_id) < 0)
+            return NBN_ERROR;
+    }
+
+    return 0;
+}
+
+unsigned int NW_GameServer_GetOutgoingMessageCount(uint32_t connection_handle,
+                                                   uint8_t channel_id)
+{
+    if (channel_id >= NBN_MAX_CHANNELS)
+        return 0;
+
+    NBN_Connection *client = NBN_ConnectionTable_Get(nbn_game_server.clients_table,
+                                                     connection_handle);
+    if (client == NULL || client->channels[channel_id] == NULL)
+        return 0;
+
+    return client->channels[channel_id]->outgoing_message_count;
+}
@@ -0,0 +1,148 @@
+// ────────────────────────────────────────────────────────────────────
+// Packet dispatch tests against the in-process nbnet stand-in
+//
+// Runs the real GameServer tick over BenchNet and feeds it truncated
+// client messages, alone and inside a MessageBundle. Handlers must drop
+// them instead of reading past the message: a truncated PositionUpdate
+// must never give its sender a transform, even when the bytes after it
+// in the receive buffer hold another client's valid update.
+// ────────────────────────────────────────────────────────────────────
+
+#include "BenchNet.h"
+#include "GameServer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+#include <vector>
+
+namespace
+{
+    int g_failures = 0;
+
+#define CHECK(cond)                                                       \
+    do                                                                    \
+    {                                                                     \
+        if (!(cond))                                                      \
+        {                                                                 \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++g_failures;                                                 \
+        }                                                                 \
+    } while (0)
+
+    constexpr uint16_t kTestPort = 47779;
+
+    /// Swallows the server's log lines.
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    NetTransformState MakeTransform(float x)
+    {
+        NetTransformState t{};
+        t.posX = x;
+        t.posY = 100.0f;
+        t.rotW = 1.0f;
+        return t;
+    }
+
+    /// ClientIDs carried by the position broadcasts sent since the last call.
+    std::vector<ClientID> BroadcastClients()
+    {
+        std::vector<ClientID> ids;
+        for (const std::vector<uint8_t> &packet : BenchNet::TakeBroadcasts())
+        {
+            if (PacketSerializer::PeekType(packet.data(), packet.size()) !=
+                NetMessageType::PositionBroadcast)
+                continue;
+            for (const NetBroadcastEntry &e :
+                 PacketSerializer::ReadPositionBroadcast(packet.data(), packet.size()).entries)
+                ids.push_back(e.clientID);
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return ids;
+    }
+
+    /// Two welcomed clients (ClientIDs 1 and 2 on connections 1 and 2).
+    /// Client 2 reports a full PositionUpdate right before client 1's
+    /// truncated message, so stale bytes after the truncated one decode
+    /// as a valid update.
+    std::vector<ClientID> RunTruncatedUpdate(const std::vector<uint8_t> &truncated)
+    {
+        ServerConfig config;
+        config.broadcastFormat = BroadcastFormat::Raw;
+        config.interestRadius = 0.0f;
+        config.maxLoadLevel = LoadLevel::Normal;
+
+        GameServer server(config);
+        server.Start(kTestPort);
+        for (uint32_t conn = 1; conn <= 2; ++conn)
+        {
+            NetUUID uuid;
+            std::memcpy(uuid.bytes, &conn, sizeof(conn));
+            BenchNet::Connect(conn);
+            BenchNet::Deliver(conn, PacketSerializer::WriteClientHello(uuid));
+        }
+        server.Tick();
+
+        BenchNet::CaptureBroadcasts(true);
+        BenchNet::Deliver(2, PacketSerializer::WritePositionUpdate(2, 2, MakeTransform(20.0f)));
+        BenchNet::Deliver(1, truncated);
+        server.Tick();
+        const std::vector<ClientID> ids = BroadcastClients();
+        BenchNet::CaptureBroadcasts(false);
+        server.Stop();
+        return ids;
+    }
+
+    void TestTruncatedPositionUpdate()
+    {
+        const std::vector<uint8_t> full = PacketSerializer::WritePositionUpdate(1, 1, MakeTransform(10.0f));
+        const std::vector<uint8_t> oneByte(full.begin(), full.begin() + 1);
+        CHECK(RunTruncatedUpdate(oneByte) == std::vector<ClientID>{2});
+
+        const std::vector<uint8_t> short1(full.begin(), full.end() - 1);
+        CHECK(RunTruncatedUpdate(short1) == std::vector<ClientID>{2});
+    }
+
+    void TestTruncatedBundledUpdate()
+    {
+        const std::vector<uint8_t> full = PacketSerializer::WritePositionUpdate(1, 1, MakeTransform(10.0f));
+        std::vector<uint8_t> bundle;
+        CHECK(PacketSerializer::AppendToBundle(bundle, full.data(), 1));
+        CHECK(RunTruncatedUpdate(bundle) == std::vector<ClientID>{2});
+    }
+
+    void TestFullUpdate()
+    {
+        // Control: the same sequence with a whole update reaches both.
+        const std::vector<uint8_t> full = PacketSerializer::WritePositionUpdate(1, 1, MakeTransform(10.0f));
+        CHECK((RunTruncatedUpdate(full) == std::vector<ClientID>{1, 2}));
+    }
+}
+
+int main()
+{
+    NullBuffer mute;
+    std::streambuf *log = std::cout.rdbuf(&mute);
+    std::streambuf *errors = std::cerr.rdbuf(&mute);
+
+    TestFullUpdate();
+    TestTruncatedPositionUpdate();
+    TestTruncatedBundledUpdate();
+
+    std::cout.rdbuf(log);
+    std::cerr.rdbuf(errors);
+    if (g_failures > 0)
+    {
+        std::printf("DispatchTest: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("DispatchTest: truncated messages dropped\n");
+    return 0;
+}
@@ -0,0 +1,327 @@
+// ────────────────────────────────────────────────────────────────────
+// Round-trip tests for the compact broadcast formats
+//
+// Quantizes transforms at and inside the configured bounds, sends them
+// through the compact and delta packet writers and readers, and checks
+// every decoded value lies within one quantization step of the input.
+// Ticks needing more than 255 chunks still fit the one-byte chunk
+// count. Truncated packets must decode as not ok instead of reading past
+// the buffer.
+// ────────────────────────────────────────────────────────────────────
+
+#include "Engine/Network/Protocol/PacketSerializer.h"
+#include "ServerConfig.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+    int g_failures = 0;
+
+#define CHECK(cond)                                                       \
+    do                                                                    \
+    {                                                                     \
+        if (!(cond))                                                      \
+        {                                                                 \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++g_failures;                                                 \
+        }                                                                 \
+    } while (0)
+
+    /// Distance between adjacent quantized values of [-bound, bound].
+    double Step(float bound, uint8_t bits)
+    {
+        return 2.0 * bound / static_cast<double>((1ull << bits) - 1);
+    }
+
+    /// The parameters GameServer derives from the default ServerConfig.
+    NetQuantizationParams ConfiguredParams()
+    {
+        const ServerConfig config;
+        NetQuantizationParams quant;
+        quant.worldBound = config.worldBound;
+        quant.positionBits =
+            NetQuantization::BitsForRange(config.worldBound, config.positionPrecision);
+        return quant;
+    }
+
+    NetBroadcastEntry MakeEntry(ClientID id, const float pos[3], const float rot[4],
+                                const float linVel[3], const float angVel[3])
+    {
+        NetBroadcastEntry e{};
+        e.clientID = id;
+        e.objectID = id + 100;
+        NetTransformState &t = e.transform;
+        t.posX = pos[0];
+        t.posY = pos[1];
+        t.posZ = pos[2];
+        t.rotW = rot[0];
+        t.rotX = rot[1];
+        t.rotY = rot[2];
+        t.rotZ = rot[3];
+        t.linVelX = linVel[0];
+        t.linVelY = linVel[1];
+        t.linVelZ = linVel[2];
+        t.angVelX = angVel[0];
+        t.angVelY = angVel[1];
+        t.angVelZ = angVel[2];
+        return e;
+    }
+
+    /// Bound-hugging and random transforms; rotations are unit quaternions.
+    std::vector<NetBroadcastEntry> MakeEntries(const NetQuantizationParams &quant)
+    {
+        const float b = quant.worldBound;
+        const float v = quant.maxLinearSpeed;
+        const float w = quant.maxAngularSpeed;
+        const float h = 0.5f;
+        const float s = 0.70710678f; // two equal components
+
+        std::vector<NetBroadcastEntry> out;
+        ClientID id = 1;
+        const float corners[][3] = {{-b, -b, -b}, {b, b, b}, {0.0f, 0.0f, 0.0f}, {-b, 0.0f, b}};
+        const float rotations[][4] = {{1, 0, 0, 0}, {0, 0, 0, -1}, {h, h, h, h}, {s, s, 0, 0},
+                                      {s, 0, -s, 0}, {-h, h, -h, h}};
+        const float linear[][3] = {{-v, -v, -v}, {v, v, v}, {0.0f, v, -v}};
+        const float angular[][3] = {{-w, -w, -w}, {w, w, w}, {w, 0.0f, -w}};
+        for (const auto &p : corners)
+            for (const auto &r : rotations)
+                for (size_t k = 0; k < 3; ++k)
+                    out.push_back(MakeEntry(id++, p, r, linear[k], angular[k]));
+
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (int i = 0; i < 2000; ++i)
+        {
+            const float p[3] = {b * unit(rng), b * unit(rng), b * unit(rng)};
+            float r[4] = {unit(rng), unit(rng), unit(rng), unit(rng)};
+            const float n = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+            for (float &c : r)
+                c = n > 0.0f ? c / n : 0.5f;
+            const float lv[3] = {v * unit(rng), v * unit(rng), v * unit(rng)};
+            const float av[3] = {w * unit(rng), w * unit(rng), w * unit(rng)};
+            out.push_back(MakeEntry(id++, p, r, lv, av));
+        }
+        return out;
+    }
+
+    /// Check `decoded` against `sent`, one quantization step per field.
+    void CheckEntry(const NetBroadcastEntry &sent, const NetBroadcastEntry &decoded,
+                    const NetQuantizationParams &quant)
+    {
+        CHECK(decoded.clientID == sent.clientID);
+        CHECK(decoded.objectID == sent.objectID);
+
+        const NetTransformState &a = sent.transform;
+        const NetTransformState &b = decoded.transform;
+        const double pos = Step(quant.worldBound, quant.positionBits);
+        CHECK(std::fabs(a.posX - b.posX) <= pos);
+        CHECK(std::fabs(a.posY - b.posY) <= pos);
+        CHECK(std::fabs(a.posZ - b.posZ) <= pos);
+
+        const double lin = Step(quant.maxLinearSpeed, quant.velocityBits);
+        const double ang = Step(quant.maxAngularSpeed, quant.velocityBits);
+        CHECK(std::fabs(a.linVelX - b.linVelX) <= lin);
+        CHECK(std::fabs(a.linVelY - b.linVelY) <= lin);
+        CHECK(std::fabs(a.linVelZ - b.linVelZ) <= lin);
+        CHECK(std::fabs(a.angVelX - b.angVelX) <= ang);
+        CHECK(std::fabs(a.angVelY - b.angVelY) <= ang);
+        CHECK(std::fabs(a.angVelZ - b.angVelZ) <= ang);
+
+        // q and -q are the same rotation; the decoder returns the one with
+        // a positive largest component. The three sent components are
+        // within one step; the rebuilt largest one, L = sqrt(1 - sum c²),
+        // moves by at most sum(|c|) / L times the rounding of the others.
+        float sa[4] = {a.rotW, a.rotX, a.rotY, a.rotZ};
+        const float sb[4] = {b.rotW, b.rotX, b.rotY, b.rotZ};
+        uint8_t largest = 0;
+        for (uint8_t i = 1; i < 4; ++i)
+        {
+            if (std::fabs(sa[i]) > std::fabs(sa[largest]))
+                largest = i;
+        }
+        const float sign = sa[largest] < 0.0f ? -1.0f : 1.0f;
+        double others = 0.0;
+        for (uint8_t i = 0; i < 4; ++i)
+        {
+            sa[i] *= sign;
+            if (i != largest)
+                others += std::fabs(sa[i]);
+        }
+        const double rot = Step(NetQuantization::kSmallestThreeBound, quant.rotationBits);
+        for (uint8_t i = 0; i < 4; ++i)
+        {
+            const double limit = (i == largest) ? others / sa[largest] * rot : rot;
+            CHECK(std::fabs(sa[i] - sb[i]) <= limit + 1e-6);
+        }
+    }
+
+    void TestScalarBounds(const NetQuantizationParams &quant)
+    {
+        // The bounds themselves are exact, and values past them clamp.
+        const float b = quant.worldBound;
+        const uint8_t bits = quant.positionBits;
+        CHECK(NetQuantization::DequantizeFloat(NetQuantization::QuantizeFloat(b, b, bits), b, bits) == b);
+        CHECK(NetQuantization::DequantizeFloat(NetQuantization::QuantizeFloat(-b, b, bits), b, bits) == -b);
+        CHECK(NetQuantization::QuantizeFloat(2.0f * b, b, bits) == NetQuantization::QuantizeFloat(b, b, bits));
+        CHECK(NetQuantization::QuantizeFloat(-2.0f * b, b, bits) == 0);
+
+        // The configured precision is met: one step is below it.
+        const ServerConfig config;
+        CHECK(Step(quant.worldBound, quant.positionBits) <= config.positionPrecision);
+    }
+
+    void TestCompactRoundTrip(const std::vector<NetBroadcastEntry> &entries,
+                              const NetQuantizationParams &quant)
+    {
+        const auto packet = PacketSerializer::WritePositionBroadcastCompact(entries, 7, quant);
+        const auto decoded = PacketSerializer::ReadPositionBroadcastCompactQuantized(
+            packet.data(), packet.size());
+        CHECK(decoded.ok);
+        CHECK(decoded.serverTick == 7);
+        CHECK(decoded.entries.size() == entries.size());
+        if (!decoded.ok || decoded.entries.size() != entries.size())
+            return;
+        // Entries were built in clientID order, which is the decoded order.
+        for (size_t i = 0; i < entries.size(); ++i)
+            CheckEntry(entries[i], NetQuantization::DequantizeEntry(decoded.entries[i], quant), quant);
+    }
+
+    void TestDeltaRoundTrip(const std::vector<NetBroadcastEntry> &entries,
+                            const NetQuantizationParams &quant)
+    {
+        // Baseline: every entry. Current: every other entry moved, a few
+        // dropped, so the packet carries changed, unchanged and gone rows.
+        std::vector<NetQuantization::QuantizedEntry> baseline, current;
+        std::vector<NetBroadcastEntry> expected;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            baseline.push_back(NetQuantization::QuantizeEntry(entries[i], quant));
+            if (i % 7 == 3)
+                continue;
+            NetBroadcastEntry e = entries[i];
+            if (i % 2 == 0)
+                e.transform.posY = -e.transform.posY;
+            expected.push_back(e);
+            current.push_back(NetQuantization::QuantizeEntry(e, quant));
+        }
+
+        PacketSerializer::QuantizedBroadcastData base;
+        base.ok = true;
+        base.serverTick = 10;
+        base.quant = quant;
+        base.entries = baseline;
+
+        const auto packet = PacketSerializer::WritePositionBroadcastDelta(baseline, 10, current, 11, quant);
+        const auto decoded = PacketSerializer::ReadPositionBroadcastDelta(packet.data(), packet.size(), base);
+        CHECK(decoded.ok);
+        CHECK(decoded.serverTick == 11);
+        CHECK(decoded.entries.size() == expected.size());
+        if (!decoded.ok || decoded.entries.size() != expected.size())
+            return;
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            CHECK(decoded.entries[i] == current[i]);
+            CheckEntry(expected[i], NetQuantization::DequantizeEntry(decoded.entries[i], quant), quant);
+        }
+    }
+
+    void TestChunkCountCap(const std::vector<NetBroadcastEntry> &entries,
+                           const NetQuantizationParams &quant)
+    {
+        // A payload limit that fits one entry per chunk would need more
+        // chunks than the one-byte chunkCount holds; the entries must be
+        // spread over at most 255 chunks instead of piling into the last.
+        std::vector<NetQuantization::QuantizedEntry> quantized;
+        for (const auto &e : entries)
+            quantized.push_back(NetQuantization::QuantizeEntry(e, quant));
+        const size_t maxPayload = sizeof(MsgPositionBroadcastDelta) + 40;
+
+        const auto compact = PacketSerializer::WritePositionBroadcastCompactChunks(
+            quantized, 7, quant, maxPayload);
+        CHECK(compact.size() <= 255);
+        size_t decoded = 0, largest = 0;
+        for (const auto &pkt : compact)
+        {
+            const auto chunk = PacketSerializer::ReadPositionBroadcastCompactQuantized(pkt.data(), pkt.size());
+            CHECK(chunk.ok && chunk.chunkCount == compact.size());
+            decoded += chunk.entries.size();
+            largest = std::max(largest, chunk.entries.size());
+        }
+        CHECK(decoded == quantized.size());
+        CHECK(largest == (quantized.size() + 254) / 255);
+
+        PacketSerializer::QuantizedBroadcastData base;
+        base.ok = true;
+        base.serverTick = 6;
+        base.quant = quant;
+        const auto delta = PacketSerializer::WritePositionBroadcastDeltaChunks(
+            {}, 6, quantized, 7, quant, maxPayload);
+        CHECK(delta.size() <= 255);
+        decoded = 0;
+        largest = 0;
+        for (const auto &pkt : delta)
+        {
+            const auto chunk = PacketSerializer::ReadPositionBroadcastDelta(pkt.data(), pkt.size(), base);
+            CHECK(chunk.ok && chunk.chunkCount == delta.size());
+            decoded += chunk.entries.size();
+            largest = std::max(largest, chunk.entries.size());
+        }
+        CHECK(decoded == quantized.size());
+        // Greedy packing: no chunk ends up with much more than its share.
+        CHECK(largest <= 2 * ((quantized.size() + 253) / 254));
+    }
+
+    void TestTruncated(const std::vector<NetBroadcastEntry> &entries,
+                       const NetQuantizationParams &quant)
+    {
+        const std::vector<NetBroadcastEntry> few(entries.begin(), entries.begin() + 4);
+        const auto compact = PacketSerializer::WritePositionBroadcastCompact(few, 7, quant);
+        for (size_t len = 0; len < compact.size(); ++len)
+        {
+            // Copy so a read past `len` would run off a buffer of that size.
+            const std::vector<uint8_t> cut(compact.begin(), compact.begin() + len);
+            CHECK(!PacketSerializer::ReadPositionBroadcastCompactQuantized(cut.data(), cut.size()).ok);
+        }
+
+        std::vector<NetQuantization::QuantizedEntry> current;
+        for (const auto &e : few)
+            current.push_back(NetQuantization::QuantizeEntry(e, quant));
+        PacketSerializer::QuantizedBroadcastData base;
+        base.ok = true;
+        base.serverTick = 10;
+        base.quant = quant;
+        const auto delta = PacketSerializer::WritePositionBroadcastDelta({}, 10, current, 11, quant);
+        for (size_t len = 0; len < delta.size(); ++len)
+        {
+            const std::vector<uint8_t> cut(delta.begin(), delta.begin() + len);
+            CHECK(!PacketSerializer::ReadPositionBroadcastDelta(cut.data(), cut.size(), base).ok);
+        }
+    }
+}
+
+int main()
+{
+    const NetQuantizationParams quant = ConfiguredParams();
+    const std::vector<NetBroadcastEntry> entries = MakeEntries(quant);
+
+    TestScalarBounds(quant);
+    TestCompactRoundTrip(entries, quant);
+    TestDeltaRoundTrip(entries, quant);
+    TestChunkCountCap(entries, quant);
+    TestTruncated(entries, quant);
+
+    if (g_failures > 0)
+    {
+        std::printf("QuantizationTest: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("QuantizationTest: %zu entries round-tripped, position step %.4g, rotation step %.4g\n",
+                entries.size(), Step(quant.worldBound, quant.positionBits),
+                Step(NetQuantization::kSmallestThreeBound, quant.rotationBits));
+    return 0;
+}
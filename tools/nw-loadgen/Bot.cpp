@@ -0,0 +1,659 @@
+// ────────────────────────────────────────────────────────────────────
+// nw-loadgen bot – one simulated client on nbnet's client side
+// ────────────────────────────────────────────────────────────────────
+
+extern "C"
+{
+#include <nbnet.h>
+#include <net_drivers/udp.h>
+}
+
+#include "Bot.h"
+#include "Engine/Network/Protocol/PacketSerializer.h"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using PacketSerializer::QuantizedBroadcastData;
+
+    // Must match the server's NW_PROTOCOL_NAME.
+    constexpr const char *kProtocolName = "neural_wings";
+
+    constexpr std::chrono::seconds kConnectTimeout{10};
+    // The server ignores position updates for a while after ObjectRelease.
+    constexpr std::chrono::seconds kRespawnDelay{1};
+    // Time for the goodbye to leave before the client stops.
+    constexpr std::chrono::milliseconds kDisconnectLinger{100};
+
+    // Delta baselines kept, as many as the server remembers per client.
+    constexpr uint32_t kBaselineHistory = 32;
+    // Own position updates remembered for matching their echoes (~2 s).
+    constexpr size_t kSentHistory = 64;
+    // Raw broadcasts carry positions verbatim.
+    constexpr float kRawTolerance = 0.01f;
+
+    constexpr float kGoldenAngle = 2.39996323f;
+
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    float DistanceSquared(const Vec3 &a, const Vec3 &b)
+    {
+        const float dx = a.x - b.x;
+        const float dy = a.y - b.y;
+        const float dz = a.z - b.z;
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    void Bump(std::atomic<uint64_t> &counter, uint64_t n = 1)
+    {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /// Twice the position step of a quantized broadcast.
+    float QuantizedTolerance(const NetQuantizationParams &q)
+    {
+        const float step = 2.0f * q.worldBound / static_cast<float>((1u << q.positionBits) - 1);
+        return std::max(kRawTolerance, 2.0f * step);
+    }
+
+    class Bot
+    {
+    public:
+        Bot(const BotConfig &config, BotStats &stats);
+        void Run(const std::atomic<bool> &stop);
+
+    private:
+        struct SentUpdate
+        {
+            Clock::time_point at{};
+            Vec3 pos{};
+            bool matched = true; // empty slots never match
+        };
+
+        /// A compact / delta tick still missing chunks.
+        struct PendingTick
+        {
+            uint8_t chunkCount = 1;
+            std::bitset<256> seen;
+            QuantizedBroadcastData data;
+        };
+
+        void Poll(Clock::time_point now);
+        void Act(Clock::time_point now);
+        void Spawn();
+        void Send(const uint8_t *data, size_t len, bool reliable);
+        void Send(const std::vector<uint8_t> &msg, bool reliable) { Send(msg.data(), msg.size(), reliable); }
+
+        void OnMessage(const uint8_t *data, size_t len, Clock::time_point now);
+        void OnWelcome(ClientID id, Clock::time_point now);
+        void OnRawBroadcast(const uint8_t *data, size_t len, Clock::time_point now);
+        void OnRelay(const uint8_t *data, size_t len, Clock::time_point now);
+        void OnQuantizedChunk(QuantizedBroadcastData chunk, Clock::time_point now);
+        void CompleteTick(uint32_t tick);
+        void MatchEcho(const Vec3 &pos, float tolerance, Clock::time_point now);
+
+        NetTransformState FlightState(double t);
+        Vec3 PathPosition(double t);
+        Vec3 RandomWaypoint();
+        Clock::time_point Schedule(Clock::time_point now, double interval);
+
+        const BotConfig &m_config;
+        BotStats &m_stats;
+        std::mt19937_64 m_rng;
+
+        bool m_connected = false;
+        bool m_disconnected = false;
+        ClientID m_clientID = INVALID_CLIENT_ID;
+        NetObjectID m_objectID = INVALID_NET_OBJECT_ID;
+        uint32_t m_spawns = 0;
+
+        Clock::time_point m_welcomedAt{};
+        Clock::time_point m_nextUpdate{};
+        Clock::time_point m_nextChat = Clock::time_point::max();
+        Clock::time_point m_nextRename = Clock::time_point::max();
+        Clock::time_point m_nextRelease = Clock::time_point::max();
+        Clock::time_point m_respawnAt = Clock::time_point::max();
+        uint32_t m_chats = 0;
+        uint32_t m_renames = 0;
+        uint32_t m_renamesPending = 0;
+
+        // Flight path.
+        Vec3 m_center{};
+        float m_phase = 0.0f;
+        Vec3 m_legFrom{};
+        Vec3 m_legTo{};
+        double m_legStart = 0.0;
+        double m_legEnd = 0.0;
+
+        // Broadcast bookkeeping.
+        std::array<SentUpdate, kSentHistory> m_sent{};
+        size_t m_sentNext = 0;
+        std::vector<std::pair<uint32_t, PendingTick>> m_pending;
+        std::array<QuantizedBroadcastData, kBaselineHistory> m_baselines{};
+        uint32_t m_lastTick = 0;
+        uint32_t m_tickGap = 0; // smallest gap between complete ticks so far
+        LatencyHistogram m_latency;
+    };
+
+    Bot::Bot(const BotConfig &config, BotStats &stats)
+        : m_config(config), m_stats(stats),
+          m_rng(std::random_device{}() ^ (uint64_t{config.index} << 32))
+    {
+        if (m_config.spread > 0.0f)
+        {
+            std::uniform_real_distribution<float> spread(-m_config.spread, m_config.spread);
+            m_center.x = spread(m_rng);
+            m_center.z = spread(m_rng);
+        }
+        m_center.y = 100.0f + static_cast<float>(m_config.index % 16) * 10.0f;
+        m_phase = static_cast<float>(m_config.index) * kGoldenAngle;
+        m_legFrom = m_legTo = m_center;
+    }
+
+    void Bot::Run(const std::atomic<bool> &stop)
+    {
+        m_stats.phase.store(static_cast<uint32_t>(BotPhase::Connecting), std::memory_order_relaxed);
+        NBN_UDP_Register();
+        if (NBN_GameClient_StartEx(kProtocolName, m_config.host.c_str(), m_config.port, false, nullptr, 0) < 0)
+        {
+            m_stats.phase.store(static_cast<uint32_t>(BotPhase::Failed), std::memory_order_relaxed);
+            return;
+        }
+
+        const Clock::time_point started = Clock::now();
+        const auto loopPeriod = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / std::max<uint32_t>(m_config.pollRate, 1)));
+        Clock::time_point nextLoop = started;
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            const Clock::time_point now = Clock::now();
+            Poll(now);
+            if (m_disconnected)
+                break;
+            if (!m_connected && now - started > kConnectTimeout)
+            {
+                m_stats.phase.store(static_cast<uint32_t>(BotPhase::Failed), std::memory_order_relaxed);
+                break;
+            }
+            if (m_clientID != INVALID_CLIENT_ID)
+            {
+                if (m_config.lifetime > 0.0 &&
+                    std::chrono::duration<double>(now - m_welcomedAt).count() >= m_config.lifetime)
+                    break;
+                Act(now);
+            }
+            NBN_GameClient_SendPackets();
+
+            nextLoop += loopPeriod;
+            if (nextLoop < now)
+                nextLoop = now;
+            std::this_thread::sleep_until(nextLoop);
+        }
+
+        if (m_connected && !m_disconnected)
+        {
+            if (m_clientID != INVALID_CLIENT_ID)
+                Send(PacketSerializer::WriteClientDisconnect(m_clientID), true);
+            NBN_GameClient_SendPackets();
+            std::this_thread::sleep_for(kDisconnectLinger);
+            NBN_GameClient_SendPackets();
+            m_stats.phase.store(static_cast<uint32_t>(BotPhase::Finished), std::memory_order_relaxed);
+        }
+        else if (!m_connected && !m_disconnected &&
+                 m_stats.phase.load(std::memory_order_relaxed) == static_cast<uint32_t>(BotPhase::Connecting))
+        {
+            // Stopped before the server answered.
+            m_stats.phase.store(static_cast<uint32_t>(BotPhase::Failed), std::memory_order_relaxed);
+        }
+        NBN_GameClient_Stop();
+
+        std::copy(m_latency.Buckets(), m_latency.Buckets() + LatencyHistogram::kBucketCount,
+                  m_stats.latencyBuckets);
+        m_stats.latencyMax = m_latency.Max();
+    }
+
+    void Bot::Poll(Clock::time_point now)
+    {
+        for (;;)
+        {
+            const int ev = NBN_GameClient_Poll();
+            if (ev == NBN_NO_EVENT || ev < 0)
+                return;
+
+            switch (ev)
+            {
+            case NBN_CONNECTED:
+            {
+                m_connected = true;
+                m_stats.phase.store(static_cast<uint32_t>(BotPhase::Connected), std::memory_order_relaxed);
+                // A random version-4 UUID: every run is a new player.
+                NetUUID uuid;
+                for (uint8_t &b : uuid.bytes)
+                    b = static_cast<uint8_t>(m_rng());
+                uuid.bytes[6] = static_cast<uint8_t>((uuid.bytes[6] & 0x0F) | 0x40);
+                uuid.bytes[8] = static_cast<uint8_t>((uuid.bytes[8] & 0x3F) | 0x80);
+                Send(PacketSerializer::WriteClientHello(uuid), true);
+                break;
+            }
+
+            case NBN_DISCONNECTED:
+            {
+                m_disconnected = true;
+                BotPhase phase = m_connected ? BotPhase::Dropped : BotPhase::Failed;
+                if (NBN_GameClient_GetServerCloseCode() == CONNECTION_REJECT_SERVER_BUSY)
+                    phase = BotPhase::Rejected;
+                m_stats.phase.store(static_cast<uint32_t>(phase), std::memory_order_relaxed);
+                return;
+            }
+
+            case NBN_MESSAGE_RECEIVED:
+            {
+                NBN_MessageInfo info = NBN_GameClient_GetMessageInfo();
+                if (info.type != NBN_BYTE_ARRAY_MESSAGE_TYPE || !info.data)
+                    break;
+                const NBN_ByteArrayMessage *msg = static_cast<const NBN_ByteArrayMessage *>(info.data);
+                Bump(m_stats.bytesIn, msg->length);
+                OnMessage(msg->bytes, msg->length, now);
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+    }
+
+    void Bot::Act(Clock::time_point now)
+    {
+        if (m_objectID == INVALID_NET_OBJECT_ID && now >= m_respawnAt)
+            Spawn();
+
+        if (m_objectID != INVALID_NET_OBJECT_ID && now >= m_nextUpdate)
+        {
+            const double t = std::chrono::duration<double>(now - m_welcomedAt).count();
+            const NetTransformState state = FlightState(t);
+            Send(PacketSerializer::WritePositionUpdate(m_clientID, m_objectID, state), false);
+            m_sent[m_sentNext] = SentUpdate{now, Vec3{state.posX, state.posY, state.posZ}, false};
+            m_sentNext = (m_sentNext + 1) % kSentHistory;
+            Bump(m_stats.updatesSent);
+
+            m_nextUpdate += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / std::max<uint32_t>(m_config.updateRate, 1)));
+            if (m_nextUpdate < now)
+                m_nextUpdate = now; // fell behind: do not burst
+        }
+
+        if (now >= m_nextChat)
+        {
+            const std::string text = "bot " + std::to_string(m_config.index) + " says hello #" +
+                                     std::to_string(++m_chats);
+            Send(PacketSerializer::WriteChatRequest(ChatMessageType::Public, INVALID_CLIENT_ID, text), true);
+            Bump(m_stats.chatsSent);
+            m_nextChat = Schedule(now, m_config.chatInterval);
+        }
+
+        if (now >= m_nextRename)
+        {
+            // 3-16 of [A-Za-z0-9_], unique per bot.
+            const std::string nickname = "bot" + std::to_string(m_config.index) + "_" +
+                                         std::to_string(++m_renames % 100);
+            Send(PacketSerializer::WriteNicknameUpdateRequest(nickname), true);
+            ++m_renamesPending;
+            Bump(m_stats.renamesSent);
+            m_nextRename = Schedule(now, m_config.renameInterval);
+        }
+
+        if (now >= m_nextRelease)
+        {
+            if (m_objectID != INVALID_NET_OBJECT_ID)
+            {
+                Send(PacketSerializer::WriteObjectRelease(m_clientID, m_objectID), true);
+                Bump(m_stats.releases);
+                m_objectID = INVALID_NET_OBJECT_ID;
+                m_respawnAt = now + kRespawnDelay;
+            }
+            m_nextRelease = Schedule(now, m_config.releaseInterval);
+        }
+    }
+
+    void Bot::Spawn()
+    {
+        m_objectID = m_clientID * 256 + (++m_spawns % 256);
+        m_respawnAt = Clock::time_point::max();
+    }
+
+    void Bot::Send(const uint8_t *data, size_t len, bool reliable)
+    {
+        const uint8_t channel = reliable ? NBN_CHANNEL_RESERVED_RELIABLE : NBN_CHANNEL_RESERVED_UNRELIABLE;
+        if (NBN_GameClient_SendByteArray(const_cast<uint8_t *>(data), static_cast<unsigned int>(len), channel) == 0)
+            Bump(m_stats.bytesOut, len);
+    }
+
+    void Bot::OnMessage(const uint8_t *data, size_t len, Clock::time_point now)
+    {
+        if (len < sizeof(NetPacketHeader))
+            return;
+
+        switch (PacketSerializer::PeekType(data, len))
+        {
+        case NetMessageType::ServerWelcome:
+            if (len >= sizeof(MsgServerWelcome))
+                OnWelcome(PacketSerializer::Read<MsgServerWelcome>(data, len).assignedClientID, now);
+            break;
+        case NetMessageType::MessageBundle:
+            PacketSerializer::ForEachBundledMessage(data, len, [&](const uint8_t *msg, size_t msgLen)
+                                                    { OnMessage(msg, msgLen, now); });
+            break;
+        case NetMessageType::PositionBroadcast:
+            OnRawBroadcast(data, len, now);
+            break;
+        case NetMessageType::PositionRelay:
+            OnRelay(data, len, now);
+            break;
+        case NetMessageType::PositionBroadcastCompact:
+            if (len >= sizeof(MsgPositionBroadcastCompact))
+            {
+                QuantizedBroadcastData chunk = PacketSerializer::ReadPositionBroadcastCompactQuantized(data, len);
+                if (chunk.ok)
+                    OnQuantizedChunk(std::move(chunk), now);
+            }
+            break;
+        case NetMessageType::PositionBroadcastDelta:
+            if (len >= sizeof(MsgPositionBroadcastDelta))
+            {
+                const auto hdr = PacketSerializer::Read<MsgPositionBroadcastDelta>(data, len);
+                const QuantizedBroadcastData &baseline = m_baselines[hdr.baselineTick % kBaselineHistory];
+                QuantizedBroadcastData chunk;
+                if (baseline.ok)
+                    chunk = PacketSerializer::ReadPositionBroadcastDelta(data, len, baseline);
+                if (chunk.ok)
+                    OnQuantizedChunk(std::move(chunk), now);
+                else
+                    Bump(m_stats.undecodable);
+            }
+            break;
+        case NetMessageType::ChatBroadcast:
+            Bump(m_stats.chatsReceived);
+            break;
+        case NetMessageType::NicknameUpdateResult:
+            // The server also confirms the default nickname on welcome.
+            if (len >= sizeof(MsgNicknameUpdateResult) && m_renamesPending > 0)
+            {
+                --m_renamesPending;
+                if (PacketSerializer::ReadNicknameUpdateResult(data, len).status == NicknameUpdateStatus::Accepted)
+                    Bump(m_stats.renamesAccepted);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void Bot::OnWelcome(ClientID id, Clock::time_point now)
+    {
+        if (m_clientID != INVALID_CLIENT_ID || id == INVALID_CLIENT_ID)
+            return;
+        m_clientID = id;
+        m_welcomedAt = now;
+        m_stats.phase.store(static_cast<uint32_t>(BotPhase::Welcomed), std::memory_order_relaxed);
+
+        if (m_config.rooms > 1)
+            Send(PacketSerializer::WriteRoomJoin(m_config.index % m_config.rooms), true);
+        Spawn();
+        m_nextUpdate = now;
+        m_nextChat = Schedule(now, m_config.chatInterval);
+        m_nextRename = Schedule(now, m_config.renameInterval);
+        m_nextRelease = Schedule(now, m_config.releaseInterval);
+    }
+
+    void Bot::OnRawBroadcast(const uint8_t *data, size_t len, Clock::time_point now)
+    {
+        if (len < sizeof(MsgPositionBroadcast))
+            return;
+        const auto hdr = PacketSerializer::Read<MsgPositionBroadcast>(data, len);
+        if (sizeof(MsgPositionBroadcast) + size_t{hdr.entryCount} * sizeof(NetBroadcastEntry) > len)
+            return;
+
+        const uint8_t *entries = data + sizeof(MsgPositionBroadcast);
+        for (uint16_t i = 0; i < hdr.entryCount; ++i)
+        {
+            NetBroadcastEntry e;
+            std::memcpy(&e, entries + i * sizeof(NetBroadcastEntry), sizeof(e));
+            if (e.clientID == m_clientID)
+            {
+                MatchEcho(Vec3{e.transform.posX, e.transform.posY, e.transform.posZ}, kRawTolerance, now);
+                break;
+            }
+        }
+        // Split raw ticks carry no chunk count; the first chunk completes them.
+        CompleteTick(hdr.serverTick);
+    }
+
+    void Bot::OnRelay(const uint8_t *data, size_t len, Clock::time_point now)
+    {
+        // Relays are partial and off-tick: they can echo an update sooner,
+        // but never complete or skip a tick.
+        const PacketSerializer::PositionRelayData relay = PacketSerializer::ReadPositionRelay(data, len);
+        if (!relay.ok)
+            return;
+        for (const NetBroadcastEntry &e : relay.entries)
+        {
+            if (e.clientID == m_clientID)
+            {
+                MatchEcho(Vec3{e.transform.posX, e.transform.posY, e.transform.posZ}, kRawTolerance, now);
+                break;
+            }
+        }
+    }
+
+    void Bot::OnQuantizedChunk(QuantizedBroadcastData chunk, Clock::time_point now)
+    {
+        for (const NetQuantization::QuantizedEntry &q : chunk.entries)
+        {
+            if (q.clientID != m_clientID)
+                continue;
+            const NetBroadcastEntry e = NetQuantization::DequantizeEntry(q, chunk.quant);
+            MatchEcho(Vec3{e.transform.posX, e.transform.posY, e.transform.posZ},
+                      QuantizedTolerance(chunk.quant), now);
+            break;
+        }
+
+        const uint32_t tick = chunk.serverTick;
+        if (tick <= m_lastTick)
+            return; // late chunk of a tick already complete or given up
+
+        auto it = std::find_if(m_pending.begin(), m_pending.end(),
+                               [tick](const auto &p) { return p.first == tick; });
+        if (it == m_pending.end())
+        {
+            PendingTick p;
+            p.chunkCount = std::max<uint8_t>(chunk.chunkCount, 1);
+            p.data.serverTick = tick;
+            p.data.quant = chunk.quant;
+            p.data.ok = true;
+            m_pending.emplace_back(tick, std::move(p));
+            it = m_pending.end() - 1;
+        }
+        PendingTick &p = it->second;
+        if (p.seen.test(chunk.chunkIndex))
+            return;
+        p.seen.set(chunk.chunkIndex);
+        p.data.entries.insert(p.data.entries.end(), chunk.entries.begin(), chunk.entries.end());
+        if (p.seen.count() < p.chunkCount)
+            return;
+
+        // Complete: keep it as a delta baseline and tell the server.
+        std::sort(p.data.entries.begin(), p.data.entries.end(),
+                  [](const auto &a, const auto &b) { return a.clientID < b.clientID; });
+        m_baselines[tick % kBaselineHistory] = std::move(p.data);
+        Send(PacketSerializer::WriteSnapshotAck(tick), false);
+        CompleteTick(tick);
+        m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(),
+                                       [tick](const auto &q) { return q.first <= tick; }),
+                        m_pending.end());
+    }
+
+    void Bot::CompleteTick(uint32_t tick)
+    {
+        if (tick <= m_lastTick)
+            return;
+        Bump(m_stats.ticksReceived);
+        if (m_lastTick != 0)
+        {
+            // The send interval is not announced; the smallest gap seen so
+            // far stands in for it.
+            const uint32_t gap = tick - m_lastTick;
+            if (m_tickGap == 0 || gap < m_tickGap)
+                m_tickGap = gap;
+            if (gap > m_tickGap)
+                Bump(m_stats.ticksMissed, gap / m_tickGap - 1);
+        }
+        m_lastTick = tick;
+    }
+
+    void Bot::MatchEcho(const Vec3 &pos, float tolerance, Clock::time_point now)
+    {
+        // The newest unmatched update at this position; older ones were
+        // overtaken by it.
+        const SentUpdate *best = nullptr;
+        for (const SentUpdate &s : m_sent)
+        {
+            if (s.matched || DistanceSquared(s.pos, pos) > tolerance * tolerance)
+                continue;
+            if (!best || s.at > best->at)
+                best = &s;
+        }
+        if (!best)
+            return;
+
+        const Clock::duration latency = now - best->at;
+        m_latency.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()));
+        Bump(m_stats.echoes);
+        Bump(m_stats.echoMicrosTotal,
+             static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count()));
+
+        const Clock::time_point matchedAt = best->at;
+        for (SentUpdate &s : m_sent)
+        {
+            if (s.at <= matchedAt)
+                s.matched = true;
+        }
+    }
+
+    NetTransformState Bot::FlightState(double t)
+    {
+        constexpr double kDt = 0.05;
+        const Vec3 p = PathPosition(t);
+        const Vec3 ahead = PathPosition(t + kDt);
+        const Vec3 v{static_cast<float>((ahead.x - p.x) / kDt), static_cast<float>((ahead.y - p.y) / kDt),
+                     static_cast<float>((ahead.z - p.z) / kDt)};
+        const float yaw = std::atan2(v.x, v.z);
+
+        NetTransformState s{};
+        s.posX = p.x;
+        s.posY = p.y;
+        s.posZ = p.z;
+        s.rotW = std::cos(yaw * 0.5f);
+        s.rotY = std::sin(yaw * 0.5f);
+        s.linVelX = v.x;
+        s.linVelY = v.y;
+        s.linVelZ = v.z;
+        return s;
+    }
+
+    Vec3 Bot::PathPosition(double t)
+    {
+        const double r = std::max(m_config.radius, 1.0f);
+        const double a = m_config.speed * t / r + m_phase; // radians along the path
+        Vec3 p = m_center;
+        switch (m_config.path)
+        {
+        case FlightPath::Circle:
+            p.x += static_cast<float>(r * std::cos(a));
+            p.z += static_cast<float>(r * std::sin(a));
+            break;
+        case FlightPath::Figure8:
+            p.x += static_cast<float>(r * std::sin(a));
+            p.z += static_cast<float>(r * std::sin(a) * std::cos(a));
+            break;
+        case FlightPath::Line:
+        {
+            // Triangle wave over [-r, r] at `speed`.
+            const double u = std::fmod(m_config.speed * t / (2.0 * r) + m_phase / (2.0 * 3.14159265), 2.0);
+            const double x = u < 1.0 ? u : 2.0 - u;
+            p.x += static_cast<float>(r * (2.0 * x - 1.0));
+            break;
+        }
+        case FlightPath::Wander:
+        {
+            while (t >= m_legEnd)
+            {
+                m_legFrom = m_legTo;
+                m_legTo = RandomWaypoint();
+                const double length = std::sqrt(DistanceSquared(m_legFrom, m_legTo));
+                m_legStart = m_legEnd;
+                m_legEnd += std::max(length / std::max(m_config.speed, 1.0f), 0.1);
+            }
+            const double f = std::clamp((t - m_legStart) / (m_legEnd - m_legStart), 0.0, 1.0);
+            p.x = static_cast<float>(m_legFrom.x + (m_legTo.x - m_legFrom.x) * f);
+            p.y = static_cast<float>(m_legFrom.y + (m_legTo.y - m_legFrom.y) * f);
+            p.z = static_cast<float>(m_legFrom.z + (m_legTo.z - m_legFrom.z) * f);
+            break;
+        }
+        }
+        return p;
+    }
+
+    Vec3 Bot::RandomWaypoint()
+    {
+        std::uniform_real_distribution<float> offset(-m_config.radius, m_config.radius);
+        std::uniform_real_distribution<float> climb(-0.1f * m_config.radius, 0.1f * m_config.radius);
+        return Vec3{m_center.x + offset(m_rng), m_center.y + climb(m_rng), m_center.z + offset(m_rng)};
+    }
+
+    Clock::time_point Bot::Schedule(Clock::time_point now, double interval)
+    {
+        if (interval <= 0.0)
+            return Clock::time_point::max();
+        std::uniform_real_distribution<double> jitter(0.5, 1.5);
+        return now + std::chrono::duration_cast<Clock::duration>(
+                         std::chrono::duration<double>(interval * jitter(m_rng)));
+    }
+}
+
+void RunBot(const BotConfig &config, BotStats &stats, const std::atomic<bool> &stop)
+{
+    Bot bot(config, stats);
+    bot.Run(stop);
+}
+
+const char *FlightPathName(FlightPath path)
+{
+    switch (path)
+    {
+    case FlightPath::Circle:
+        return "circle";
+    case FlightPath::Figure8:
+        return "figure8";
+    case FlightPath::Line:
+        return "line";
+    case FlightPath::Wander:
+        return "wander";
+    }
+    return "?";
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "Engine/Network/NetTypes.h"
+#include "LatencyHistogram.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/// Path a bot flies; every bot gets its own phase and centre.
+enum class FlightPath : uint8_t
+{
+    Circle,
+    Figure8,
+    Line,   // back and forth
+    Wander, // random waypoints
+};
+
+struct BotConfig
+{
+    std::string host = DEFAULT_SERVER_HOST;
+    uint16_t port = DEFAULT_SERVER_PORT;
+    uint32_t index = 0; // bot number, also seeds its randomness
+
+    FlightPath path = FlightPath::Circle;
+    float radius = 500.0f; // size of the path (world units)
+    float spread = 0.0f;   // path centres are spread over [-spread, spread]
+    float speed = 60.0f;   // world units per second
+    uint32_t updateRate = 30; // PositionUpdate per second
+    uint32_t pollRate = 250;  // client loop iterations per second
+    uint32_t rooms = 1;       // bots spread over rooms 0..rooms-1
+
+    // Seconds between actions, 0 = never. Each bot adds up to ±50% jitter.
+    double chatInterval = 0.0;
+    double renameInterval = 0.0;
+    double releaseInterval = 0.0;
+    /// Disconnect after this many seconds in game (0 = when stopped).
+    double lifetime = 0.0;
+};
+
+enum class BotPhase : uint32_t
+{
+    Starting,
+    Connecting,
+    Connected, // ClientHello sent
+    Welcomed,
+    Finished,  // disconnected on purpose
+    Failed,    // could not connect or timed out
+    Rejected,  // server busy
+    Dropped,   // the server closed the connection
+};
+
+/// Counters one bot publishes to the load generator. Lives in memory
+/// shared with the parent process: the atomics are read while the bot
+/// runs, the latency buckets only after it has exited.
+struct BotStats
+{
+    std::atomic<uint32_t> phase;
+    std::atomic<uint64_t> updatesSent;
+    std::atomic<uint64_t> ticksReceived;   // broadcast ticks fully received
+    std::atomic<uint64_t> ticksMissed;     // gaps at the observed send interval
+    std::atomic<uint64_t> undecodable;     // deltas against a missing baseline
+    std::atomic<uint64_t> echoes;          // own updates seen in a broadcast
+    std::atomic<uint64_t> echoMicrosTotal; // sum of their latencies
+    std::atomic<uint64_t> chatsSent;
+    std::atomic<uint64_t> chatsReceived;
+    std::atomic<uint64_t> renamesSent;
+    std::atomic<uint64_t> renamesAccepted;
+    std::atomic<uint64_t> releases;
+    std::atomic<uint64_t> bytesOut; // message payloads
+    std::atomic<uint64_t> bytesIn;
+
+    // Written once, just before the bot's process exits.
+    uint64_t latencyMax;
+    uint64_t latencyBuckets[LatencyHistogram::kBucketCount];
+};
+
+/// Run one bot until `stop` is raised, its lifetime ends or the server
+/// drops it. nbnet's client is a process-wide singleton, so each bot
+/// needs a process of its own.
+void RunBot(const BotConfig &config, BotStats &stats, const std::atomic<bool> &stop);
+
+const char *FlightPathName(FlightPath path);
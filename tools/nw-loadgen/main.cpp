@@ -0,0 +1,342 @@
+// ────────────────────────────────────────────────────────────────────
+// nw-loadgen – headless bots that load a server over loopback UDP
+// ────────────────────────────────────────────────────────────────────
+
+#include "Bot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<bool> g_stopRequested{false};
+
+    // Inherited by every forked bot, which then stops on its own flag.
+    void SignalHandler(int) { g_stopRequested.store(true); }
+
+    struct Options
+    {
+        BotConfig bot;
+        uint32_t bots = 100;
+        double spawnRate = 50.0; // bots started per second
+        double duration = 60.0;  // 0 = until Ctrl+C
+        double reportSeconds = 5.0;
+    };
+
+    /// Sums over all bots, read from shared memory while they run.
+    struct Totals
+    {
+        uint32_t phases[static_cast<uint32_t>(BotPhase::Dropped) + 1] = {};
+        uint64_t updatesSent = 0;
+        uint64_t ticksReceived = 0;
+        uint64_t ticksMissed = 0;
+        uint64_t undecodable = 0;
+        uint64_t echoes = 0;
+        uint64_t echoMicrosTotal = 0;
+        uint64_t chatsSent = 0;
+        uint64_t chatsReceived = 0;
+        uint64_t renamesSent = 0;
+        uint64_t renamesAccepted = 0;
+        uint64_t releases = 0;
+        uint64_t bytesOut = 0;
+        uint64_t bytesIn = 0;
+
+        uint32_t Phase(BotPhase p) const { return phases[static_cast<uint32_t>(p)]; }
+    };
+
+    Totals Sum(const BotStats *stats, uint32_t count)
+    {
+        constexpr auto kRelaxed = std::memory_order_relaxed;
+        Totals t;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const BotStats &s = stats[i];
+            t.phases[std::min<uint32_t>(s.phase.load(kRelaxed), static_cast<uint32_t>(BotPhase::Dropped))]++;
+            t.updatesSent += s.updatesSent.load(kRelaxed);
+            t.ticksReceived += s.ticksReceived.load(kRelaxed);
+            t.ticksMissed += s.ticksMissed.load(kRelaxed);
+            t.undecodable += s.undecodable.load(kRelaxed);
+            t.echoes += s.echoes.load(kRelaxed);
+            t.echoMicrosTotal += s.echoMicrosTotal.load(kRelaxed);
+            t.chatsSent += s.chatsSent.load(kRelaxed);
+            t.chatsReceived += s.chatsReceived.load(kRelaxed);
+            t.renamesSent += s.renamesSent.load(kRelaxed);
+            t.renamesAccepted += s.renamesAccepted.load(kRelaxed);
+            t.releases += s.releases.load(kRelaxed);
+            t.bytesOut += s.bytesOut.load(kRelaxed);
+            t.bytesIn += s.bytesIn.load(kRelaxed);
+        }
+        return t;
+    }
+
+    double LossPercent(uint64_t received, uint64_t missed)
+    {
+        const uint64_t expected = received + missed;
+        return expected > 0 ? 100.0 * static_cast<double>(missed) / static_cast<double>(expected) : 0.0;
+    }
+
+    void PrintProgress(double elapsed, uint32_t spawned, const Options &opts, const Totals &now,
+                       const Totals &prev, double seconds)
+    {
+        const double s = std::max(seconds, 1e-3);
+        const uint64_t echoes = now.echoes - prev.echoes;
+        const double echoMs =
+            echoes > 0 ? static_cast<double>(now.echoMicrosTotal - prev.echoMicrosTotal) / echoes / 1000.0 : 0.0;
+        std::printf("[LoadGen] %6.1f s: %u/%u bots, %u in game, %u connecting, %u failed, %u rejected, %u dropped | "
+                    "updates %.0f/s, ticks %.0f/s, loss %.2f%%, echo %.1f ms, in %.1f KB/s\n",
+                    elapsed, spawned, opts.bots, now.Phase(BotPhase::Welcomed),
+                    now.Phase(BotPhase::Starting) + now.Phase(BotPhase::Connecting) + now.Phase(BotPhase::Connected),
+                    now.Phase(BotPhase::Failed), now.Phase(BotPhase::Rejected), now.Phase(BotPhase::Dropped),
+                    (now.updatesSent - prev.updatesSent) / s, (now.ticksReceived - prev.ticksReceived) / s,
+                    LossPercent(now.ticksReceived - prev.ticksReceived, now.ticksMissed - prev.ticksMissed), echoMs,
+                    (now.bytesIn - prev.bytesIn) / s / 1024.0);
+        std::fflush(stdout);
+    }
+
+    void PrintSummary(double elapsed, const Options &opts, uint32_t spawned, const BotStats *stats)
+    {
+        const Totals t = Sum(stats, spawned);
+        LatencyHistogram latency;
+        for (uint32_t i = 0; i < spawned; ++i)
+            latency.MergeBuckets(stats[i].latencyBuckets, stats[i].latencyMax);
+        const uint32_t reached = t.Phase(BotPhase::Welcomed) + t.Phase(BotPhase::Finished);
+
+        std::printf("[LoadGen] Done after %.1f s: %u of %u bots started (%s path, %u Hz updates), "
+                    "%u reached the game\n",
+                    elapsed, spawned, opts.bots, FlightPathName(opts.bot.path), opts.bot.updateRate, reached);
+        std::printf("[LoadGen]   failed to connect %u, rejected as busy %u, dropped by the server %u\n",
+                    t.Phase(BotPhase::Failed) + t.Phase(BotPhase::Connecting) + t.Phase(BotPhase::Connected),
+                    t.Phase(BotPhase::Rejected), t.Phase(BotPhase::Dropped));
+        std::printf("[LoadGen]   sent %llu position updates, %llu chat messages, %llu renames (%llu accepted), "
+                    "%llu releases\n",
+                    static_cast<unsigned long long>(t.updatesSent), static_cast<unsigned long long>(t.chatsSent),
+                    static_cast<unsigned long long>(t.renamesSent),
+                    static_cast<unsigned long long>(t.renamesAccepted), static_cast<unsigned long long>(t.releases));
+        std::printf("[LoadGen]   broadcast ticks received %llu, missed ~%llu (%.2f%% loss), undecodable deltas %llu, "
+                    "chat messages received %llu\n",
+                    static_cast<unsigned long long>(t.ticksReceived), static_cast<unsigned long long>(t.ticksMissed),
+                    LossPercent(t.ticksReceived, t.ticksMissed), static_cast<unsigned long long>(t.undecodable),
+                    static_cast<unsigned long long>(t.chatsReceived));
+        std::printf("[LoadGen]   echo latency (own update -> broadcast back), %llu samples: p50 %.2f ms, "
+                    "p90 %.2f ms, p99 %.2f ms, p99.9 %.2f ms, max %.2f ms\n",
+                    static_cast<unsigned long long>(latency.Count()), latency.Percentile(0.50) / 1e6,
+                    latency.Percentile(0.90) / 1e6, latency.Percentile(0.99) / 1e6,
+                    latency.Percentile(0.999) / 1e6, latency.Max() / 1e6);
+        std::printf("[LoadGen]   payload traffic: out %.1f MB, in %.1f MB\n", t.bytesOut / 1e6, t.bytesIn / 1e6);
+    }
+
+    bool ParsePath(const char *s, FlightPath &out)
+    {
+        for (FlightPath p : {FlightPath::Circle, FlightPath::Figure8, FlightPath::Line, FlightPath::Wander})
+        {
+            if (std::strcmp(s, FlightPathName(p)) == 0)
+            {
+                out = p;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void PrintUsage(const char *exe)
+    {
+        std::printf("Usage: %s [port] [options]\n"
+                    "  --host <addr>          server address (default %s)\n"
+                    "  --bots <N>             simulated clients (default 100)\n"
+                    "  --spawn-rate <N>       bots started per second (default 50)\n"
+                    "  --duration <s>         run time, 0 = until Ctrl+C (default 60)\n"
+                    "  --path <p>             circle | figure8 | line | wander (default circle)\n"
+                    "  --radius <units>       path size (default 500)\n"
+                    "  --spread <units>       spread path centres over [-spread, spread] (default 0)\n"
+                    "  --speed <units/s>      flight speed (default 60)\n"
+                    "  --update-rate <Hz>     PositionUpdate rate per bot (default 30)\n"
+                    "  --poll-rate <Hz>       client loop rate per bot (default 250)\n"
+                    "  --rooms <N>            spread bots over rooms 0..N-1 (default 1)\n"
+                    "  --chat <s>             chat every ~s seconds (default off)\n"
+                    "  --rename <s>           change nickname every ~s seconds (default off)\n"
+                    "  --release <s>          release and respawn the object every ~s seconds (default off)\n"
+                    "  --lifetime <s>         disconnect after ~s seconds in game (default: stay)\n"
+                    "  --report <s>           progress line interval (default 5)\n",
+                    exe, DEFAULT_SERVER_HOST);
+    }
+
+    bool ParseArgs(int argc, char *argv[], Options &opts)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char *arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            auto number = [&] { return std::strtod(argv[++i], nullptr); };
+
+            if (std::strcmp(arg, "--host") == 0 && hasValue)
+                opts.bot.host = argv[++i];
+            else if (std::strcmp(arg, "--bots") == 0 && hasValue)
+                opts.bots = static_cast<uint32_t>(number());
+            else if (std::strcmp(arg, "--spawn-rate") == 0 && hasValue)
+                opts.spawnRate = number();
+            else if (std::strcmp(arg, "--duration") == 0 && hasValue)
+                opts.duration = number();
+            else if (std::strcmp(arg, "--path") == 0 && hasValue)
+            {
+                if (!ParsePath(argv[++i], opts.bot.path))
+                    return false;
+            }
+            else if (std::strcmp(arg, "--radius") == 0 && hasValue)
+                opts.bot.radius = static_cast<float>(number());
+            else if (std::strcmp(arg, "--spread") == 0 && hasValue)
+                opts.bot.spread = static_cast<float>(number());
+            else if (std::strcmp(arg, "--speed") == 0 && hasValue)
+                opts.bot.speed = static_cast<float>(number());
+            else if (std::strcmp(arg, "--update-rate") == 0 && hasValue)
+                opts.bot.updateRate = static_cast<uint32_t>(number());
+            else if (std::strcmp(arg, "--poll-rate") == 0 && hasValue)
+                opts.bot.pollRate = static_cast<uint32_t>(number());
+            else if (std::strcmp(arg, "--rooms") == 0 && hasValue)
+                opts.bot.rooms = static_cast<uint32_t>(number());
+            else if (std::strcmp(arg, "--chat") == 0 && hasValue)
+                opts.bot.chatInterval = number();
+            else if (std::strcmp(arg, "--rename") == 0 && hasValue)
+                opts.bot.renameInterval = number();
+            else if (std::strcmp(arg, "--release") == 0 && hasValue)
+                opts.bot.releaseInterval = number();
+            else if (std::strcmp(arg, "--lifetime") == 0 && hasValue)
+                opts.bot.lifetime = number();
+            else if (std::strcmp(arg, "--report") == 0 && hasValue)
+                opts.reportSeconds = number();
+            else if (arg[0] != '-')
+                opts.bot.port = static_cast<uint16_t>(std::strtoul(arg, nullptr, 10));
+            else
+                return false;
+        }
+        opts.bot.updateRate = std::max<uint32_t>(opts.bot.updateRate, 1);
+        opts.bot.pollRate = std::max(opts.bot.pollRate, opts.bot.updateRate);
+        opts.bot.rooms = std::max<uint32_t>(opts.bot.rooms, 1);
+        opts.spawnRate = std::max(opts.spawnRate, 0.1);
+        opts.reportSeconds = std::max(opts.reportSeconds, 0.5);
+        return opts.bots > 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options opts;
+    if (!ParseArgs(argc, argv, opts))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // nbnet's client is a process-wide singleton, so every bot runs in a
+    // forked process and reports through this shared array.
+    const size_t statsBytes = sizeof(BotStats) * opts.bots;
+    void *mem = mmap(nullptr, statsBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+    {
+        std::perror("[LoadGen] mmap");
+        return 1;
+    }
+    auto *stats = static_cast<BotStats *>(mem);
+    for (uint32_t i = 0; i < opts.bots; ++i)
+        new (&stats[i]) BotStats{};
+
+    std::signal(SIGINT, SignalHandler);
+    std::signal(SIGTERM, SignalHandler);
+
+    std::printf("[LoadGen] %u bots -> %s:%u, %.0f/s spawn rate, %s path, %u Hz updates\n", opts.bots,
+                opts.bot.host.c_str(), opts.bot.port, opts.spawnRate, FlightPathName(opts.bot.path),
+                opts.bot.updateRate);
+    std::fflush(stdout);
+
+    std::vector<pid_t> children;
+    children.reserve(opts.bots);
+    uint32_t running = 0;
+    const Clock::time_point start = Clock::now();
+    const auto spawnPeriod =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / opts.spawnRate));
+    const auto reportPeriod =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opts.reportSeconds));
+    Clock::time_point nextSpawn = start;
+    Clock::time_point nextReport = start + reportPeriod;
+    Clock::time_point lastReport = start;
+    Totals lastTotals;
+
+    while (!g_stopRequested.load())
+    {
+        const Clock::time_point now = Clock::now();
+        if (opts.duration > 0.0 && now - start >= std::chrono::duration<double>(opts.duration))
+            break;
+
+        while (children.size() < opts.bots && now >= nextSpawn)
+        {
+            const uint32_t index = static_cast<uint32_t>(children.size());
+            const pid_t pid = fork();
+            if (pid == 0)
+            {
+                BotConfig config = opts.bot;
+                config.index = index;
+                RunBot(config, stats[index], g_stopRequested);
+                _exit(0);
+            }
+            if (pid < 0)
+            {
+                std::perror("[LoadGen] fork");
+                opts.bots = index; // run with what we have
+                break;
+            }
+            children.push_back(pid);
+            ++running;
+            nextSpawn += spawnPeriod;
+        }
+
+        // Reap bots that finished on their own (lifetime, rejected, ...).
+        for (pid_t pid; running > 0 && (pid = waitpid(-1, nullptr, WNOHANG)) > 0;)
+        {
+            std::replace(children.begin(), children.end(), pid, pid_t{0});
+            --running;
+        }
+        if (children.size() == opts.bots && running == 0)
+            break;
+
+        if (now >= nextReport)
+        {
+            const Totals totals = Sum(stats, static_cast<uint32_t>(children.size()));
+            PrintProgress(std::chrono::duration<double>(now - start).count(),
+                          static_cast<uint32_t>(children.size()), opts, totals, lastTotals,
+                          std::chrono::duration<double>(now - lastReport).count());
+            lastTotals = totals;
+            lastReport = now;
+            nextReport += reportPeriod;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Ask every bot to say goodbye, then collect their histograms.
+    for (pid_t pid : children)
+    {
+        if (pid > 0)
+            kill(pid, SIGTERM);
+    }
+    while (running > 0 && waitpid(-1, nullptr, 0) > 0)
+        --running;
+
+    PrintSummary(std::chrono::duration<double>(Clock::now() - start).count(), opts,
+                 static_cast<uint32_t>(children.size()), stats);
+    munmap(mem, statsBytes);
+    return 0;
+}
@@ -0,0 +1,22 @@
+// ────────────────────────────────────────────────────────────────────
+// nbnet client implementation for nw-loadgen – compiled as C
+//
+// Same arrangement as src/nbnet_server_impl.c: nbnet is compiled here
+// with NBNET_IMPL together with the UDP driver, and the C++ bot code
+// includes nbnet.h inside extern "C" { } for declarations only.
+// ────────────────────────────────────────────────────────────────────
+
+#include <stdio.h>
+
+// nbnet logging. Thousands of bot processes share one terminal, so only
+// problems are printed.
+#define NBN_LogInfo(...)    (void)0
+#define NBN_LogError(...)   do { fprintf(stderr, "[nbnet ERROR] "); fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); } while(0)
+#define NBN_LogWarning(...) do { fprintf(stderr, "[nbnet WARN] ");  fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); } while(0)
+#define NBN_LogDebug(...)   (void)0
+#define NBN_LogTrace(...)   (void)0
+
+#define NBNET_IMPL
+
+#include <nbnet.h>
+#include <net_drivers/udp.h>
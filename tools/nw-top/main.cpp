@@ -0,0 +1,269 @@
+// ────────────────────────────────────────────────────────────────────
+// nw-top – live terminal view of a running server's shared-memory stats
+// ────────────────────────────────────────────────────────────────────
+
+#include "LiveStats.h"
+#include "TickWatchdog.h"
+#include "Engine/Network/Protocol/MessageTypes.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // A server that has not published for this long is shown as stalled.
+    constexpr uint64_t kStaleMs = 2000;
+
+    std::atomic<bool> g_stopRequested{false};
+
+    void SignalHandler(int) { g_stopRequested.store(true); }
+
+    const char *MessageName(uint8_t type)
+    {
+        switch (static_cast<NetMessageType>(type))
+        {
+        case NetMessageType::ClientHello: return "ClientHello";
+        case NetMessageType::ServerWelcome: return "ServerWelcome";
+        case NetMessageType::ClientDisconnect: return "ClientDisconnect";
+        case NetMessageType::Heartbeat: return "Heartbeat";
+        case NetMessageType::MessageBundle: return "MessageBundle";
+        case NetMessageType::PositionUpdate: return "PositionUpdate";
+        case NetMessageType::PositionBroadcast: return "PositionBroadcast";
+        case NetMessageType::ObjectDespawn: return "ObjectDespawn";
+        case NetMessageType::ObjectRelease: return "ObjectRelease";
+        case NetMessageType::PositionBroadcastCompact: return "PositionBroadcastCompact";
+        case NetMessageType::SnapshotAck: return "SnapshotAck";
+        case NetMessageType::PositionBroadcastDelta: return "PositionBroadcastDelta";
+        case NetMessageType::SnapshotRate: return "SnapshotRate";
+        case NetMessageType::PositionRelay: return "PositionRelay";
+        case NetMessageType::RoomJoin: return "RoomJoin";
+        case NetMessageType::RoomLeave: return "RoomLeave";
+        case NetMessageType::ChatRequest: return "ChatRequest";
+        case NetMessageType::ChatBroadcast: return "ChatBroadcast";
+        case NetMessageType::NicknameUpdateRequest: return "NicknameUpdateRequest";
+        case NetMessageType::NicknameUpdateResult: return "NicknameUpdateResult";
+        case NetMessageType::PlayerMetaSnapshot: return "PlayerMetaSnapshot";
+        case NetMessageType::PlayerMetaUpsert: return "PlayerMetaUpsert";
+        case NetMessageType::PlayerMetaRemove: return "PlayerMetaRemove";
+        }
+        return nullptr;
+    }
+
+    uint64_t NowUnixMs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                         std::chrono::system_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    /// Read-only mapping of the server's segment.
+    class SegmentView
+    {
+    public:
+        ~SegmentView() { Unmap(); }
+
+        bool Map(const std::string &name)
+        {
+            Unmap();
+            const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd < 0)
+                return false;
+            struct stat st{};
+            void *mem = MAP_FAILED;
+            if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(LiveStats::Segment))
+                mem = mmap(nullptr, sizeof(LiveStats::Segment), PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem == MAP_FAILED)
+                return false;
+            m_segment = static_cast<const LiveStats::Segment *>(mem);
+            return true;
+        }
+
+        void Unmap()
+        {
+            if (m_segment)
+                munmap(const_cast<LiveStats::Segment *>(m_segment), sizeof(LiveStats::Segment));
+            m_segment = nullptr;
+        }
+
+        const LiveStats::Segment *Get() const { return m_segment; }
+
+    private:
+        const LiveStats::Segment *m_segment = nullptr;
+    };
+
+    void PrintRate(double perSecond)
+    {
+        if (perSecond >= 1e6)
+            std::printf(" %9.2fM", perSecond / 1e6);
+        else if (perSecond >= 1e4)
+            std::printf(" %9.1fk", perSecond / 1e3);
+        else
+            std::printf(" %10.0f", perSecond);
+    }
+
+    void Render(uint16_t port, const LiveStats::Segment &seg, const LiveStats::Snapshot &now,
+                const LiveStats::Snapshot *prev, double seconds)
+    {
+        const bool stale = NowUnixMs() > now.publishedUnixMs + kStaleMs;
+        const auto level = static_cast<LoadLevel>(std::min<uint32_t>(now.loadLevel, kLoadLevelCount - 1));
+
+        std::printf("\x1b[H\x1b[J");
+        std::printf("Neural Wings server  port %u  pid %u  tick %llu @ %u Hz  %s\n\n", port, seg.pid,
+                    static_cast<unsigned long long>(now.serverTick), now.tickRate,
+                    stale ? "[NOT UPDATING]" : "[live]");
+        std::printf("clients %u (welcomed %u)   rooms %u\n", now.clients, now.welcomedClients, now.rooms);
+        std::printf("tick %.2f ms (window max %.2f ms)   load %u%%  level %u (%s)\n",
+                    now.lastTickNs / 1e6, now.maxTickNs / 1e6, now.loadPermille / 10, now.loadLevel,
+                    TickWatchdog::LevelName(level));
+        std::printf("reliable backlog %u messages (worst client %u)\n\n", now.reliableBacklog,
+                    now.reliableBacklogMax);
+
+        std::printf("%-26s %10s %10s %10s %10s\n", "message", "in pkt/s", "in B/s", "out pkt/s", "out B/s");
+        for (uint32_t t = 0; t < LiveStats::kMessageTypes; ++t)
+        {
+            const LiveStats::Traffic &in = now.in[t];
+            const LiveStats::Traffic &out = now.out[t];
+            if (in.packets == 0 && out.packets == 0)
+                continue;
+
+            const char *name = MessageName(static_cast<uint8_t>(t));
+            char unknown[16];
+            if (!name)
+            {
+                std::snprintf(unknown, sizeof(unknown), "type 0x%02x", t);
+                name = unknown;
+            }
+            std::printf("%-26s", name);
+            if (prev && seconds > 0.0)
+            {
+                PrintRate((in.packets - prev->in[t].packets) / seconds);
+                PrintRate((in.bytes - prev->in[t].bytes) / seconds);
+                PrintRate((out.packets - prev->out[t].packets) / seconds);
+                PrintRate((out.bytes - prev->out[t].bytes) / seconds);
+            }
+            std::printf("\n");
+        }
+
+        if (now.topClientCount > 0)
+        {
+            char title[32];
+            std::snprintf(title, sizeof(title), "top clients (last %u s)", now.topClients[0].windowSeconds);
+            std::printf("\n%-26s %10s %10s %10s %10s\n", title, "in msg/s", "in B/s", "out msg/s", "out B/s");
+            const uint32_t count = std::min(now.topClientCount, LiveStats::kTopClients);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const LiveStats::ClientTraffic &c = now.topClients[i];
+                const double window = std::max<uint32_t>(c.windowSeconds, 1);
+                std::printf("client %-19u", c.clientID);
+                PrintRate(c.messagesIn / window);
+                PrintRate(c.bytesIn / window);
+                PrintRate(c.messagesOut / window);
+                PrintRate(c.bytesOut / window);
+                std::printf("\n");
+            }
+        }
+        std::fflush(stdout);
+    }
+
+    void PrintUsage(const char *exe)
+    {
+        std::printf("Usage: %s [port] [--interval <ms>] [--once]\n"
+                    "  Live view of a server started with --live-stats (default port 7777).\n",
+                    exe);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint16_t port = 7777;
+    uint32_t intervalMs = 1000;
+    bool once = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        if (std::strcmp(arg, "--interval") == 0 && i + 1 < argc)
+            intervalMs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(arg, "--once") == 0)
+            once = true;
+        else if (arg[0] != '-')
+            port = static_cast<uint16_t>(std::strtoul(arg, nullptr, 10));
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    intervalMs = std::max<uint32_t>(intervalMs, 50);
+
+    std::signal(SIGINT, SignalHandler);
+    std::signal(SIGTERM, SignalHandler);
+
+    const std::string name = LiveStats::SegmentName(port);
+    SegmentView view;
+    auto current = std::make_unique<LiveStats::Snapshot>();
+    auto previous = std::make_unique<LiveStats::Snapshot>();
+    bool havePrevious = false;
+    auto previousAt = std::chrono::steady_clock::now();
+
+    while (!g_stopRequested.load())
+    {
+        const LiveStats::Segment *seg = view.Get();
+        // (Re)attach when missing or when the server stopped publishing,
+        // e.g. after a restart created a fresh segment.
+        if (!seg || NowUnixMs() > seg->snapshot.publishedUnixMs + kStaleMs)
+        {
+            if (view.Map(name))
+                havePrevious = false;
+            seg = view.Get();
+        }
+
+        if (!seg || seg->magic != LiveStats::kMagic)
+        {
+            std::printf("\x1b[H\x1b[JWaiting for a server publishing %s (start it with --live-stats)...\n",
+                        name.c_str());
+            std::fflush(stdout);
+        }
+        else if (seg->version != LiveStats::kVersion)
+        {
+            std::fprintf(stderr, "Segment %s has layout version %u, nw-top reads version %u\n", name.c_str(),
+                         seg->version, LiveStats::kVersion);
+            return 1;
+        }
+        else if (LiveStats::Read(*seg, *current))
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const double seconds = std::chrono::duration<double>(now - previousAt).count();
+            // --once still samples twice so it can show rates.
+            if (!once || havePrevious)
+            {
+                Render(port, *seg, *current, havePrevious ? previous.get() : nullptr, seconds);
+                if (once)
+                    break;
+            }
+            std::swap(current, previous);
+            havePrevious = true;
+            previousAt = now;
+        }
+        else if (once)
+        {
+            continue; // writer busy, retry right away
+        }
+
+        if (once && (!seg || seg->magic != LiveStats::kMagic))
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    }
+    return 0;
+}